@@ -1,7 +1,56 @@
 #include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
 #include "antenna_pcv.hpp"
 
 using ngpt::AntennaPco;
+using ngpt::AntennaPcv;
+using ngpt::AntennaPcvList;
+
+namespace
+{
+/// @brief Bilinear (azimuth x zenith) interpolation on an AntennaPcv grid.
+///
+/// The cell is found by truncation of the (clamped) fractional grid indexes;
+/// the only branch depends on the grid (not on the input), so the function
+/// can be used within loops over many lines-of-sight.
+///
+/// @param[in] grid  The grid; first row is NOAZI, then nazi azimuth rows
+/// @param[in] nzen  Number of zenith angles (>=2)
+/// @param[in] nazi  Number of azimuths (0 or >=2)
+/// @param[in] zen1  First zenith angle (deg)
+/// @param[in] dzen  Zenith step (deg)
+/// @param[in] azi   Azimuth (deg)
+/// @param[in] zen   Zenith angle (deg)
+/// @return    The interpolated value
+inline __attribute__((always_inline)) double
+__bilinear__(const double* grid, int nzen, int nazi, double zen1, double dzen,
+  double azi, double zen) noexcept
+{
+  // zenith: clamp to [0, nzen-1], cell iz is [iz, iz+1]
+  const double z  = std::min(std::max((zen-zen1)/dzen, 0e0),
+                             static_cast<double>(nzen-1));
+  const int    iz = std::min(static_cast<int>(z), nzen-2);
+  const double tz = z - iz;
+
+  if (!nazi) {
+    return grid[iz] + tz*(grid[iz+1]-grid[iz]);
+  }
+
+  // azimuth: wrap to [0, 360) and scale to [0, nazi-1) (the azimuth step is
+  // 360/(nazi-1)); cell ia is [ia, ia+1]
+  const double turns = azi/360e0;
+  const double a  = (turns - std::floor(turns))*(nazi-1);
+  const int    ia = std::min(static_cast<int>(a), nazi-2);
+  const double ta = a - ia;
+  const double* r0 = grid + (ia+1)*nzen + iz;
+  const double* r1 = r0 + nzen;
+  const double v0 = r0[0] + tz*(r0[1]-r0[0]);
+  const double v1 = r1[0] + tz*(r1[1]-r1[0]);
+  return v0 + ta*(v1-v0);
+}
+}// anonymous namespace
 
 #ifdef DEBUG
 void
@@ -16,3 +65,91 @@ const
   return;
 }
 #endif
+
+/// @details Construct a PCV grid for zenith angles zen1, zen1+dzen, ..., zen2
+///          and (if dazi is not zero) azimuths 0, dazi, ..., 360. All values
+///          are set to zero.
+/// @param[in] obs  The observation code (frequency)
+/// @param[in] sys  The satellite system of the observation code
+/// @param[in] zen1 First zenith angle (deg); ANTEX field ZEN1
+/// @param[in] zen2 Last zenith angle (deg); ANTEX field ZEN2
+/// @param[in] dzen Zenith angle step (deg); ANTEX field DZEN
+/// @param[in] dazi Azimuth step (deg); ANTEX field DAZI; 0 for NOAZI only
+/// @throw     std::runtime_error if the grid definition is invalid (less than
+///            two zenith angles, dazi not dividing 360, etc)
+AntennaPcv::AntennaPcv(const ObservationCode& obs, SATELLITE_SYSTEM sys,
+                       double zen1, double zen2, double dzen, double dazi)
+  : __otype(obs)
+  , __ssys(sys)
+  , __zen1(zen1)
+  , __dzen(dzen)
+  , __dazi(dazi)
+  , __nzen(0)
+  , __nazi(0)
+{
+  if (dzen<=0e0 || zen2<=zen1 || dazi<0e0) {
+    throw std::runtime_error("[ERROR] AntennaPcv::AntennaPcv Invalid grid");
+  }
+  const double nz = (zen2-zen1)/dzen;
+  __nzen = static_cast<int>(std::round(nz)) + 1;
+  if (std::abs(nz-(__nzen-1))>1e-6) {
+    throw std::runtime_error("[ERROR] AntennaPcv::AntennaPcv Invalid zenith grid");
+  }
+  if (dazi>0e0) {
+    const double na = 360e0/dazi;
+    __nazi = static_cast<int>(std::round(na)) + 1;
+    if (std::abs(na-(__nazi-1))>1e-6) {
+      throw std::runtime_error("[ERROR] AntennaPcv::AntennaPcv Invalid azimuth grid");
+    }
+  }
+  __grid.assign(static_cast<std::size_t>(1+__nazi)*__nzen, 0e0);
+}
+
+/// @param[in] azi Azimuth (deg); any value, e.g. in [-180, 180) or
+///                [0, 360); ignored if the grid has no azimuth rows
+/// @param[in] zen Zenith angle (deg); for satellite antennas, the nadir
+///                angle. Values outside [ZEN1, ZEN2] are clamped.
+/// @return    The interpolated PCV value (mm)
+double
+AntennaPcv::pcv(double azi, double zen) const noexcept
+{
+  return __bilinear__(__grid.data(), __nzen, __nazi, __zen1, __dzen, azi,
+    zen);
+}
+
+/// @details Batched version of AntennaPcv::pcv, e.g. for all satellites in
+///          view at an epoch.
+/// @param[in]  n    Number of (azimuth, zenith) pairs
+/// @param[in]  azi  Array of n azimuths (deg)
+/// @param[in]  zen  Array of n zenith angles (deg)
+/// @param[out] val  Array of n interpolated PCV values (mm)
+void
+AntennaPcv::pcv(std::size_t n, const double* azi, const double* zen,
+  double* val) const noexcept
+{
+  const double* grid = __grid.data();
+  const int nzen = __nzen, nazi = __nazi;
+  const double zen1 = __zen1, dzen = __dzen;
+  for (std::size_t i=0; i<n; i++) {
+    val[i] = __bilinear__(grid, nzen, nazi, zen1, dzen, azi[i], zen[i]);
+  }
+}
+
+/// @param[in] zen Zenith angle (deg); clamped to [ZEN1, ZEN2]
+/// @return    The interpolated NOAZI PCV value (mm)
+double
+AntennaPcv::noazi_pcv(double zen) const noexcept
+{
+  return __bilinear__(__grid.data(), __nzen, 0, __zen1, __dzen, 0e0, zen);
+}
+
+/// @param[in] sys  The satellite system
+/// @param[in] band The frequency band (e.g. 1 for G01)
+/// @return    A pointer to the matching grid; nullptr if none matches
+const AntennaPcv*
+AntennaPcvList::find(SATELLITE_SYSTEM sys, int band) const noexcept
+{
+  auto it = std::find_if(__pcv.cbegin(), __pcv.cend(),
+    [=](const AntennaPcv& p){return p.system()==sys && p.obs_code().band()==band;});
+  return it==__pcv.cend() ? nullptr : &(*it);
+}
@@ -2,6 +2,7 @@
 #define __ANTENNA_PCV_HPP__
 
 #include <vector>
+#include <cstddef>
 #include "satsys.hpp"
 #include "gnssobs.hpp"
 
@@ -14,7 +15,7 @@
 ///
 /// @date      Mon 11 Feb 2019 01:08:33 PM EET 
 ///
-/// @brief     Antenna Phase Centre Offset
+/// @brief     Antenna Phase Centre Offset and Variations
 /// 
 /// @see       
 ///
@@ -57,6 +58,31 @@ public:
     , __du(u)
     {}
 
+  /// @brief The observation code (frequency) of the offset.
+  ObservationCode
+  obs_code() const noexcept
+  {return __otype;}
+
+  /// @brief The satellite system (of the observation code).
+  SATELLITE_SYSTEM
+  system() const noexcept
+  {return __ssys;}
+
+  /// @brief North (or x) eccentricity in mm.
+  double
+  dn() const noexcept
+  {return __dn;}
+
+  /// @brief East (or y) eccentricity in mm.
+  double
+  de() const noexcept
+  {return __de;}
+
+  /// @brief Up (or z) eccentricity in mm.
+  double
+  du() const noexcept
+  {return __du;}
+
 #ifdef DEBUG
   void
   dummy_print(std::ostream&) const;
@@ -102,6 +128,138 @@ private:
                                  ///< +ObservationCode pair
 }; // AntennaPcoList
 
+/// @class AntennaPcv
+///
+/// Phase centre variations (PCV) of an antenna, for a single
+/// SATELLITE_SYSTEM/ObservationCode pair, as recorded in ANTEX files. Values
+/// (in millimeters) are tabulated on a regular grid of zenith angles (for
+/// receiver antennas; nadir angles for satellite antennas) ZEN1, ZEN1+DZEN,
+/// ..., ZEN2, and, if DAZI is not zero, of azimuths 0, DAZI, ..., 360
+/// (degrees).
+///
+/// The grid is stored contiguously, one row (of num_zenith() values) after
+/// the other: the first row holds the non-azimuth-dependent values (NOAZI),
+/// followed by one row per azimuth (if any).
+///
+/// Interpolation is bilinear in azimuth and zenith (linear in zenith on the
+/// NOAZI row, if the grid has no azimuth-dependent values). Zenith angles
+/// outside [ZEN1, ZEN2] are clamped to the grid; any azimuth is accepted.
+/// @see ftp://igs.org/pub/station/general/antex14.txt
+class AntennaPcv
+{
+public:
+
+  /// @brief Constructor; the grid is allocated and zero-filled.
+  AntennaPcv(const ObservationCode& obs, SATELLITE_SYSTEM sys, double zen1,
+             double zen2, double dzen, double dazi=0e0);
+
+  /// @brief The observation code (frequency) of the grid.
+  ObservationCode
+  obs_code() const noexcept
+  {return __otype;}
+
+  /// @brief The satellite system (of the observation code).
+  SATELLITE_SYSTEM
+  system() const noexcept
+  {return __ssys;}
+
+  /// @brief First zenith angle, ZEN1 (deg).
+  double
+  zen1() const noexcept
+  {return __zen1;}
+
+  /// @brief Last zenith angle, ZEN2 (deg).
+  double
+  zen2() const noexcept
+  {return __zen1+(__nzen-1)*__dzen;}
+
+  /// @brief Zenith angle step, DZEN (deg).
+  double
+  dzen() const noexcept
+  {return __dzen;}
+
+  /// @brief Azimuth step, DAZI (deg); 0 if the grid has no
+  ///        azimuth-dependent values.
+  double
+  dazi() const noexcept
+  {return __dazi;}
+
+  /// @brief Number of zenith angles (values per row).
+  int
+  num_zenith() const noexcept
+  {return __nzen;}
+
+  /// @brief Number of azimuths (rows after NOAZI); 0 if the grid has no
+  ///        azimuth-dependent values.
+  int
+  num_azimuth() const noexcept
+  {return __nazi;}
+
+  /// @brief The NOAZI row (num_zenith() values).
+  double*
+  noazi() noexcept
+  {return __grid.data();}
+
+  /// @brief The whole grid, starting at the NOAZI row; (1+num_azimuth())
+  ///        rows of num_zenith() values.
+  const double*
+  grid() const noexcept
+  {return __grid.data();}
+
+  /// @brief The row of the k-th azimuth, aka k*DAZI (num_zenith() values).
+  double*
+  azimuth_row(int k) noexcept
+  {return __grid.data() + (k+1)*__nzen;}
+
+  /// @brief Interpolate the PCV (mm) at an azimuth and zenith (degrees).
+  double
+  pcv(double azi, double zen) const noexcept;
+
+  /// @brief Interpolate the PCV (mm) for n (azimuth, zenith) pairs.
+  void
+  pcv(std::size_t n, const double* azi, const double* zen, double* val)
+  const noexcept;
+
+  /// @brief Interpolate the NOAZI PCV (mm) at a zenith angle (degrees).
+  double
+  noazi_pcv(double zen) const noexcept;
+
+private:
+  ObservationCode     __otype; ///< ObservationCode for PCVs
+  SATELLITE_SYSTEM    __ssys;  ///< Satellite system (of obs code)
+  double              __zen1,  ///< First zenith angle (deg)
+                      __dzen,  ///< Zenith angle step (deg)
+                      __dazi;  ///< Azimuth step (deg); 0 for NOAZI only
+  int                 __nzen,  ///< Number of zenith angles
+                      __nazi;  ///< Number of azimuths (0 for NOAZI only)
+  std::vector<double> __grid;  ///< (1+__nazi) rows of __nzen values (mm)
+}; // AntennaPcv
+
+/// @class AntennaPcvList
+/// A class to hold the phase centre variations of an antenna (either a
+/// ReceiverAntenna or a SatelliteAntenna) for a collection of
+/// SATELLITE_SYSTEM/ObservationCode pairs; one AntennaPcv per pair.
+class AntennaPcvList
+{
+public:
+
+  /// @brief Initialize to nothing (empty list)
+  AntennaPcvList() noexcept {};
+
+  std::vector<AntennaPcv>&
+  __vecref__() noexcept
+  {return __pcv;}
+
+  /// @brief Find the PCV grid of a satellite system/frequency (band) pair.
+  const AntennaPcv*
+  find(SATELLITE_SYSTEM sys, int band) const noexcept;
+
+private:
+  std::vector<AntennaPcv> __pcv; ///< A vector of AntennaPcv instances, each
+                                 ///< one representing a SATELLITE_SYSTEM
+                                 ///< +ObservationCode pair
+}; // AntennaPcvList
+
 }//namespace ngpt
 
 #endif
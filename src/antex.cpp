@@ -1,7 +1,10 @@
 #include <stdexcept>
 #include <cstring>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include "antex.hpp"
+#include "rinex.hpp"
 #include "ggdatetime/datetime_read.hpp"
 #ifdef DEBUG
 #include <iostream>
@@ -46,12 +49,13 @@ constexpr std::size_t MAX_GRID_CHARS { 512 };
 
 // Forward declerationof non Antex:: functions;
 int
-collect_pco(std::ifstream&, ngpt::AntennaPcoList&) noexcept;
+collect_pco(std::ifstream&, ngpt::AntennaPcoList&,
+  ngpt::AntennaPcvList* pcv_list=nullptr) noexcept;
 int
 resolve_satellite_antenna_line(const char*, Satellite&) noexcept;
 int
-check_time_interval(std::ifstream&, const ngpt::datetime<ngpt::seconds>&)
-  noexcept;
+read_time_interval(std::ifstream&, ngpt::datetime<ngpt::seconds>&, bool&,
+  ngpt::datetime<ngpt::seconds>&, bool&) noexcept;
 
 /// @details Antex Constructor, using an antex filename. The constructor will
 ///          initialize (set) the _filename attribute and also (try to)
@@ -70,6 +74,50 @@ Antex::Antex(const char* filename)
       if (__istream.is_open()) __istream.close();
       throw std::runtime_error("[ERROR] Failed to read antex header");
   }
+  if (build_index()) {
+      if (__istream.is_open()) __istream.close();
+      throw std::runtime_error("[ERROR] Failed to index antex file");
+  }
+}
+
+/// @details Antex Constructor, using an antex filename and a binary cache.
+///          If the cache file exists and is valid for the ANTEX file (see
+///          Antex::load_cache), it is memory-mapped and all queries are
+///          served from it; the ANTEX file is not opened. Else, the ANTEX
+///          file is opened, its header read and its antennas indexed (as in
+///          Antex::Antex(const char*)), and the cache is (re)written; failing
+///          to write the cache is not an error.
+///          The signature of the ANTEX file (see Antex::load_cache) is taken
+///          before anything is parsed; if it cannot be taken, no cache is
+///          used or written.
+/// @param[in] filename        The filename of the ANTEX file
+/// @param[in] cache_filename  The filename of the binary cache
+Antex::Antex(const char* filename, const char* cache_filename)
+  : __filename   (filename)
+  , __istream    ()
+  , __satsys     (SATELLITE_SYSTEM::mixed)
+  , __version    (Antex::ATX_VERSION::v14)
+  , __end_of_head(0)
+{
+  const bool has_sig = !source_signature(__src_sig);
+  if (has_sig && !load_cache(cache_filename)) return;
+
+  __istream.open(filename, std::ios_base::in);
+  if (read_header()) {
+      if (__istream.is_open()) __istream.close();
+      throw std::runtime_error("[ERROR] Failed to read antex header");
+  }
+  if (build_index()) {
+      if (__istream.is_open()) __istream.close();
+      throw std::runtime_error("[ERROR] Failed to index antex file");
+  }
+#ifdef DEBUG
+  if (!has_sig || write_cache(cache_filename)) {
+    std::cerr<<"\n[WARNING] Failed to write antex cache "<<cache_filename;
+  }
+#else
+  if (has_sig) write_cache(cache_filename);
+#endif
 }
 
 /// @details Read an Antex (instance) header. The format of the header should
@@ -152,6 +200,136 @@ Antex::read_header() noexcept
   return 0;
 }
 
+/// @details Scan the file, from the end of the header up to EOF, and index
+///          every antenna block. For each antenna, the "TYPE / SERIAL NO"
+///          line is resolved and the stream position of the following line
+///          ("METH / BY / # / DATE") is stored (see Antex::index_antenna).
+///          For satellite antennas, the validity interval of the block is
+///          read too and added to the satellite index (records without a
+///          "VALID FROM" field, or with an invalid date, can never match an
+///          epoch and are left out). This is a single pass over the file,
+///          costing as much as a single (unsuccessful) query used to.
+/// @return  Anything other than 0 is an error; 2 if memory could not be
+///          allocated for the indexes (which are then left empty).
+int
+Antex::build_index() noexcept
+{
+  __antennas.clear();
+  __rcv_index.clear();
+  __sat_index.clear();
+
+  // go to the top of the file, after the header
+  __istream.seekg(__end_of_head, std::ios_base::beg);
+
+  char             line[MAX_HEADER_CHARS] = {'\0'};
+  ReceiverAntenna  cur_ant;
+  Satellite        cur_sat;
+  int              stat1,
+                   stat2 = 0;
+  ngpt::datetime<ngpt::seconds> from, to;
+  bool             has_from, has_to;
+
+  try {
+    while (!(stat1 = read_next_antenna_type(cur_ant, line))) {
+      cur_sat.system() = SATELLITE_SYSTEM::mixed;
+      if (resolve_satellite_antenna_line(line, cur_sat)) {
+        cur_sat.system() = SATELLITE_SYSTEM::mixed;
+      }
+      index_antenna(cur_ant, __istream.tellg(), cur_sat.system(), cur_sat.prn());
+      if (cur_sat.system() == SATELLITE_SYSTEM::mixed) {
+        if ((stat2 = skip_rest_of_antenna())) break;
+        continue;
+      }
+      stat2 = read_time_interval(__istream, from, has_from, to, has_to);
+      if (stat2 == 11 || stat2 == 12) {
+        // invalid date; skip the rest of the block
+        if ((stat2 = skip_rest_of_antenna())) break;
+      } else if (stat2) {
+        break;
+      } else if (has_from) {
+        index_interval(__antennas.size()-1, from,
+          has_to ? to : ngpt::datetime<ngpt::seconds>::max());
+      }
+    }
+  } catch (std::exception&) {
+    __antennas.clear();
+    __rcv_index.clear();
+    __sat_index.clear();
+    return 2;
+  }
+  sort_intervals();
+
+  // some error status is set
+  if (stat1 > 0 || stat2) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/// @details Append an antenna to the list of antennas (__antennas) and add
+///          its index to __rcv_index, keyed on model+radome (all antennas;
+///          this is what find_closest_antenna_match compares against).
+///          Satellite antennas are added to __sat_index along with their
+///          validity interval (see Antex::index_interval).
+/// @param[in] antenna The antenna as recorded in "TYPE / SERIAL NO"
+/// @param[in] pos     Stream position of the line following "TYPE / SERIAL
+///                    NO"
+/// @param[in] ss      Satellite system of a satellite antenna; mixed for any
+///                    other antenna
+/// @param[in] prn     PRN of a satellite antenna (ignored if ss is mixed)
+/// @throw  std::bad_alloc if the index cannot grow (callers catch it)
+void
+Antex::index_antenna(const ReceiverAntenna& antenna, pos_type pos,
+                     SATELLITE_SYSTEM ss, int prn)
+{
+  constexpr std::size_t model_radome_chars
+  {  antenna_details::antenna_model_max_chars + 1
+   + antenna_details::antenna_radome_max_chars };
+
+  const std::size_t idx = __antennas.size();
+  __antennas.push_back(AntennaRecord{antenna, pos, ss, prn});
+  std::string key (antenna.__underlying_char__(), model_radome_chars);
+  __rcv_index[key].push_back(idx);
+}
+
+/// @details Add the validity interval of a satellite antenna to __sat_index,
+///          keyed on (system, PRN) of the antenna. The intervals of a
+///          satellite must be sorted (see Antex::sort_intervals) before any
+///          query.
+/// @param[in] idx  Index of the (satellite) antenna in __antennas
+/// @param[in] from "VALID FROM"
+/// @param[in] to   "VALID UNTIL"; datetime::max() if not recorded
+/// @throw  std::bad_alloc if the index cannot grow (callers catch it)
+void
+Antex::index_interval(std::size_t idx,
+                      const ngpt::datetime<ngpt::seconds>& from,
+                      const ngpt::datetime<ngpt::seconds>& to)
+{
+  const AntennaRecord& rec = __antennas[idx];
+  __sat_index[sat_key(rec.system, rec.prn)].push_back(
+    SatInterval{from, to, to, idx});
+}
+
+/// @details Sort the intervals of every satellite on "VALID FROM" (ties in
+///          file order) and compute the running maximum of "VALID UNTIL",
+///          which bounds the backward search in
+///          Antex::find_satellite_antenna when intervals overlap.
+void
+Antex::sort_intervals() noexcept
+{
+  for (auto& it : __sat_index) {
+    auto& v = it.second;
+    std::sort(v.begin(), v.end(),
+      [](const SatInterval& a, const SatInterval& b) {
+        return a.from < b.from || (a.from == b.from && a.idx < b.idx);
+      });
+    for (std::size_t i=1; i<v.size(); i++) {
+      v[i].max_to = (v[i-1].max_to < v[i].to) ? v[i].to : v[i-1].max_to;
+    }
+  }
+}
+
 /// Read the next antenna in the Antex file
 ///
 /// Function assumes that that the stream is open and placed at a position
@@ -249,51 +427,49 @@ Antex::skip_rest_of_antenna() noexcept
 
 /// Try to match a given ReceiverAntenna to a record in the antex file. The 
 /// funtion will try to match at least the model+radome and if possible also 
-/// match the serial.
-/// If the function does find a match (and returns <1), then it will leave the
-/// stream at the field (aka next line to be read will be) 
-/// "METH / BY / # / DATE".
+/// match the serial. Candidates are the indexed antennas with the same
+/// model+radome (see Antex::build_index); if more than one antennas match
+/// the model+radome (and none matches the serial), the last one (in file
+/// order) without a serial is chosen.
 /// @param[in]  ant_in   ReceiverAntenna to match in antex
 /// @param[out] ant_out  If return value <= 0, then matched antenna as recorded
 ///                      in the antex file; else no valid antenna at all
-/// @param[out] ant_pos  If return value <= 0, then matched antenna position
-///                      in the input (antex) stream.
+/// @param[out] ant_idx  If return value <= 0, then matched antenna index
+///                      (in __antennas).
 /// @return              -1 exact match (model+radome+serial)
 ///                       0 match model+radome
 ///                      >0 no match or error
 int
 Antex::find_closest_antenna_match(const ReceiverAntenna& ant_in,
                                   ReceiverAntenna& ant_out,
-                                  pos_type& ant_pos) noexcept
+                                  std::size_t& ant_idx) noexcept
 {
-  // go to the top of the file, after the header
-  __istream.seekg(__end_of_head, std::ios_base::beg);
+  constexpr std::size_t model_radome_chars
+  {  antenna_details::antenna_model_max_chars + 1
+   + antenna_details::antenna_radome_max_chars };
 
-  ReceiverAntenna  cur_ant,
-                   best_match_ant;
-  pos_type best_match_pos;
-  int      stat1,
-           stat2;
+  auto it = __rcv_index.find(std::string(ant_in.__underlying_char__(),
+                                         model_radome_chars));
+  if (it == __rcv_index.end()) {
+    return 1;
+  }
 
-  while (!(stat1 = read_next_antenna_type(cur_ant))) {
-    if ( cur_ant.is_same(ant_in) ) {
-      ant_out = cur_ant;
-      ant_pos = __istream.tellg();
+  bool model_match = false;
+  for (const auto idx : it->second) {
+    const ReceiverAntenna& rec = __antennas[idx].antenna;
+    if ( rec.is_same(ant_in) ) {
+      ant_out = rec;
+      ant_idx = idx;
       return -1;
     }
-    if ( cur_ant.compare_model(ant_in) && !cur_ant.has_serial() ) {
-      best_match_ant = cur_ant;
-      best_match_pos = __istream.tellg();
+    if ( !rec.has_serial() ) {
+      ant_out = rec;
+      ant_idx = idx;
+      model_match = true;
     }
-    if ((stat2 = skip_rest_of_antenna())) break;
   }
-  // some error status is set
-  if (stat1 > 0 || stat2) {
-    return 1;
-  }
-  ant_out = best_match_ant;
-  ant_pos = best_match_pos;
-  return 0;
+
+  return model_match ? 0 : 1;
 }
 
 /// @brief Resolve a satellite antenna line "TYPE / SERIAL NO"
@@ -366,30 +542,28 @@ resolve_satellite_antenna_line(const char* line, Satellite& sat) noexcept
   return 0;
 }
 
-/// @brief Check if a given epoch is between the "VALID FROM" and "VALID UNTIL"
-///        fields.
+/// @brief Read the "VALID FROM" and "VALID UNTIL" fields of an antenna block.
 /// Satellite antennas are always described in ANTEX files for certain time-
-/// intervals. This function will search through a satellite antenna ANTEX
-/// block to find the fields "VALID FROM" and "VALID UNTIL". It will then
-/// check if the passed in epoch is between these limits.
-/// Note that "VALID UNTIL" can be missing, in which case it is assumed to be
-/// infinity (aka for every epoch after "VALID FROM")
-/// @param[in] fin  An antex input stream placed at the begining of the line:
-///                 "METH / BY / # / DATE"
-/// @param[in] at   An ngpt::datetime<ngpt::seconds> epoch; the fuction will
-///                 check if this epoch is contained in ["VALID FROM", 
-///                 VALID UNITL"]. Dates in ANTEX files have a resolution of
-///                 seconds.
-/// @return         If the passed in epoch is between the VALID FROM/UNTILL
-///                 bounds, 0 is returned. Else, an error code (integer>0)
-///                 is returned.
+/// intervals. This function will search through an ANTEX antenna block to
+/// find the fields "VALID FROM" and "VALID UNTIL" (any or both can be
+/// missing).
+/// @param[in]  fin      An antex input stream placed at the begining of the
+///                      line: "METH / BY / # / DATE"; at output, the stream
+///                      is placed after "END OF ANTENNA"
+/// @param[out] from     "VALID FROM" (if has_from is true)
+/// @param[out] has_from True if the field "VALID FROM" was found
+/// @param[out] to       "VALID UNTIL" (if has_to is true)
+/// @param[out] has_to   True if the field "VALID UNTIL" was found
+/// @return              Anything other than 0 denotes an error.
 int
-check_time_interval(std::ifstream& fin, const ngpt::datetime<ngpt::seconds>& at)
-noexcept
+read_time_interval(std::ifstream& fin, ngpt::datetime<ngpt::seconds>& from,
+  bool& has_from, ngpt::datetime<ngpt::seconds>& to, bool& has_to) noexcept
 {
   char line[MAX_GRID_CHARS];
   int  max_lines = 5000;
 
+  has_from = has_to = false;
+
   // next field is 'METH / BY / # / DATE'
   if (!fin.getline(line, MAX_GRID_CHARS)
       || std::strncmp(line+60, "METH / BY / # / DATE", 20)) {
@@ -397,50 +571,61 @@ noexcept
   }
 
   int  dummy_it = 0;
-  bool from_ok  = false,
-       to_ok    = false;
-  ngpt::datetime<ngpt::seconds> from,
-                                to;
   do {
     fin.getline(line, MAX_GRID_CHARS);
     dummy_it++;
     if (!std::strncmp(line+60, "VALID FROM", 10)) {
       try {
         from = ngpt::strptime_ymd_hms<ngpt::seconds>(line);
-        from_ok = true;
+        has_from = true;
       } catch (std::exception&) {
         return 11;
       }
     } else if (!std::strncmp(line+60, "VALID UNTIL", 11)) {
       try {
         to = ngpt::strptime_ymd_hms<ngpt::seconds>(line);
-        to_ok = true;
+        has_to = true;
       } catch (std::exception&) {
         return 12;
       }
     }
-  } while (std::strncmp(line+60, "END OF ANTENNA", 14) && dummy_it < max_lines);
+  } while (fin && std::strncmp(line+60, "END OF ANTENNA", 14)
+           && dummy_it < max_lines);
 
-  if (dummy_it >= max_lines) {
+  if (!fin || dummy_it >= max_lines) {
     return 20;
   }
 
-  // note that if we have found "VALID FROM" but not "VALID UNTIL", then
-  // "VALID UNTIL" is forever ....
-  if (!from_ok) {
-    return 21;
-  } else if (from_ok && !to_ok) {
-    // to = ngpt::datetime<ngpt::seconds>::max();
-    // to_ok = true;
-    return !(from <= at);
-  }
+  return 0;
+}
 
-  return !(from <= at && at <= to);
+/// @details Collect the PCO values (and, if pcv_list is not nullptr, the PCV
+///          grids) of the idx-th antenna, either from the (mapped) cache or
+///          from the ANTEX stream (see collect_pco). The lists are appended.
+/// @param[in]  idx      Index of the antenna (in __antennas)
+/// @param[out] pco_list Collected PCO values
+/// @param[out] pcv_list If not nullptr, collected PCV grids
+/// @return              Anything other than 0 denotes an error.
+int
+Antex::collect(std::size_t idx, AntennaPcoList& pco_list,
+               AntennaPcvList* pcv_list) noexcept
+{
+  if (__cache.is_mapped()) {
+    return collect_cached(idx, pco_list, pcv_list);
+  }
+  __istream.clear();
+  __istream.seekg(__antennas[idx].pos, std::ios_base::beg);
+  // we should now be ready to read "METH / BY / # / DATE"
+  return collect_pco(__istream, pco_list, pcv_list);
 }
 
 /// @brief Find a satellite antenna by PRN
 /// Find a given satellite in an ANTEX file, for a given epoch. The satellite
-/// is seeked using its PRN id.
+/// is seeked using its PRN id; its validity intervals (sorted on "VALID
+/// FROM") are binary-searched for the last interval starting at or before
+/// the epoch. If intervals overlap, the search continues backwards while the
+/// running maximum of "VALID UNTIL" reaches the epoch, and the first matching
+/// record in file order is chosen (as a scan of the file would).
 /// @param[in] prn  The PRN of the satellite or to be more precise:
 ///                 the PRN number (GPS, Compass),
 ///                 the slot number (GLONASS),
@@ -450,45 +635,38 @@ noexcept
 /// @param[in] ss   The satellite system of the satellite
 /// @param[in] at   The epoch we want the satellite for (must match the fields
 ///                 "VALID FROM" and "VALID UNTIL")
-/// @param[out] ant_pos  The position of the start of the antenna block in the
-///                      ANTEX file stream
+/// @param[out] ant_idx  The index of the matched antenna (in __antennas)
 /// @return         Returns an integer; if 0 then the satellite/antenna was
 ///                 found, matched and resolved. Otherwise an integer >0 is
 ///                 returned (and the satellite was not matched)
 int
 Antex::find_satellite_antenna(int prn, SATELLITE_SYSTEM ss,
                               const ngpt::datetime<ngpt::seconds>& at,
-                              pos_type& ant_pos) noexcept
+                              std::size_t& ant_idx) noexcept
 {
-  char line[MAX_HEADER_CHARS];
-
-  // go to the top of the file, after the header
-  __istream.seekg(__end_of_head, std::ios_base::beg);
-
-  ReceiverAntenna  cur_ant;
-  Satellite        cur_sat;
-  int              stat1,
-                   stat2;
-
-  while ( !(stat1 = read_next_antenna_type(cur_ant, line)) ) {
-    cur_sat.system() = SATELLITE_SYSTEM::mixed;
-    ant_pos = __istream.tellg();
-    if (!resolve_satellite_antenna_line(line, cur_sat)) {
-      if (cur_sat.prn() == prn && cur_sat.system() == ss) {
-        if (!check_time_interval(__istream, at)) {
-          return 0;
-        }
-      }
-    }
-    if ((stat2 = skip_rest_of_antenna())) break;
+  auto it = __sat_index.find(sat_key(ss, prn));
+  if (it == __sat_index.end()) {
+    return 10;
   }
 
-  // some error status is set
-  if (stat1 > 0 || stat2) {
-    return 1;
+  // note that if we have found "VALID FROM" but not "VALID UNTIL", then
+  // "VALID UNTIL" is forever (aka datetime::max()) ....
+  const auto& v = it->second;
+  auto last = std::upper_bound(v.begin(), v.end(), at,
+    [](const ngpt::datetime<ngpt::seconds>& t, const SatInterval& i) {
+      return t < i.from;
+    });
+  bool found = false;
+  while (last != v.begin()) {
+    --last;
+    if (last->max_to < at) break;
+    if (at <= last->to && (!found || last->idx < ant_idx)) {
+      ant_idx = last->idx;
+      found = true;
+    }
   }
 
-  return 10;
+  return found ? 0 : 10;
 }
 
 /// Get the list of PCO values for a given satellite (antenna). 
@@ -510,22 +688,135 @@ Antex::get_antenna_pco(int prn, SATELLITE_SYSTEM ss,
                        const ngpt::datetime<ngpt::seconds>& at,
                        AntennaPcoList& pco_list) noexcept
 {   
-  pos_type ant_pos;
+  std::size_t ant_idx;
 
   // clean any entries in pco_list
   pco_list.__vecref__().clear();
 
   // match the antenna
-  int ant_found = find_satellite_antenna(prn, ss, at, ant_pos);
+  int ant_found = find_satellite_antenna(prn, ss, at, ant_idx);
   if (ant_found > 0) {return ant_found;}
 
-  // go to the position where the antenna was found
-  __istream.seekg(ant_pos, std::ios_base::beg);
+  return collect(ant_idx, pco_list);
+}
 
-  // we should now be ready to read "METH / BY / # / DATE"
-  int status = collect_pco(__istream, pco_list);
+/// Get all satellite antenna records, and their PCO values, valid at any
+/// epoch within a time span; e.g. for a multi-day processing span, the
+/// records for every satellite are collected in one call and the record
+/// applying to an epoch is then found in the (small) list of the satellite.
+/// Records are ordered on satellite system, PRN and "VALID FROM".
+/// @param[in]  start  Start of the time span
+/// @param[in]  stop   End of the time span
+/// @param[out] list   The satellite antenna records (with their PCO values)
+///                    whose validity interval overlaps [start, stop]; cleared
+///                    at entry
+/// @param[in]  ss     If not mixed, only collect records of this satellite
+///                    system
+/// @return     An integer is returned; 0 denotes success; anything other
+///             than 0 denotes an error (collecting the PCO values of a
+///             record failed); 20 if memory could not be allocated (list is
+///             then empty).
+int
+Antex::get_antenna_pco(const ngpt::datetime<ngpt::seconds>& start,
+                       const ngpt::datetime<ngpt::seconds>& stop,
+                       std::vector<SatelliteAntennaPco>& list,
+                       SATELLITE_SYSTEM ss) noexcept
+{
+  list.clear();
 
-  return status;
+  try {
+    std::vector<int> keys;
+    keys.reserve(__sat_index.size());
+    for (const auto& it : __sat_index) {
+      const AntennaRecord& rec = __antennas[it.second.front().idx];
+      if (ss == SATELLITE_SYSTEM::mixed || rec.system == ss) {
+        keys.push_back(it.first);
+      }
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (const auto key : keys) {
+      for (const auto& i : __sat_index.find(key)->second) {
+        if (stop < i.from) break;
+        if (i.to < start) continue;
+        const AntennaRecord& rec = __antennas[i.idx];
+        list.push_back(SatelliteAntennaPco{rec.system, rec.prn, i.from, i.to,
+          AntennaPcoList()});
+        if (int status = collect(i.idx, list.back().pco)) return status;
+      }
+    }
+  } catch (std::exception&) {
+    list.clear();
+    return 20;
+  }
+
+  return 0;
+}
+
+/// Get the lists of PCO values and PCV grids for a given satellite (antenna).
+/// @param[in] prn  The PRN of the satellite (see Antex::get_antenna_pco)
+/// @param[in] ss   The satellite system of the satellite
+/// @param[in] at   The epoch we want the satellite for (must match the fields
+///                 "VALID FROM" and "VALID UNTIL")
+/// @param[out] pco_list  The PCO values for the satellite antenna
+/// @param[out] pcv_list  The PCV grids for the satellite antenna (nadir
+///                 angle dependent)
+/// @return         An integer is returned; 0 denotes success, aka the satellite
+///                 was found and the PCO/PCV values collected; anything other
+///                 than 0 denotes an error.
+int
+Antex::get_antenna_pcv(int prn, SATELLITE_SYSTEM ss,
+                       const ngpt::datetime<ngpt::seconds>& at,
+                       AntennaPcoList& pco_list,
+                       AntennaPcvList& pcv_list) noexcept
+{   
+  std::size_t ant_idx;
+
+  // clean any entries in the lists
+  pco_list.__vecref__().clear();
+  pcv_list.__vecref__().clear();
+
+  // match the antenna
+  int ant_found = find_satellite_antenna(prn, ss, at, ant_idx);
+  if (ant_found > 0) {return ant_found;}
+
+  return collect(ant_idx, pco_list, &pcv_list);
+}
+
+/// Get the lists of PCO values and PCV grids for a given receiver antenna.
+/// @param[in]  ant_in    The antenna for which we want the PCO/PCV
+/// @param[out] pco_list  The list of recorded PCO values for each satellite
+///                       system and observation code (cleared at entry)
+/// @param[out] pcv_list  The list of recorded PCV grids for each satellite
+///                       system and observation code (cleared at entry)
+/// @param[in] must_match_serial If set to true, then we will only match
+///                       antennas that apart from same model+radome also have
+///                       same serial.
+/// @return               0 : all ok, antenna matched
+///                       1 : antenna was not found (model+radome)
+///                       10: antenna (model+radome) found, but serial did not
+///                           match
+int
+Antex::get_antenna_pcv(const ReceiverAntenna& ant_in, AntennaPcoList& pco_list,
+                       AntennaPcvList& pcv_list, bool must_match_serial)
+noexcept
+{
+  std::size_t      ant_idx;
+  ReceiverAntenna  ant_out;
+
+  // clean any entries in the lists
+  pco_list.__vecref__().clear();
+  pcv_list.__vecref__().clear();
+
+  // match the antenna
+  int ant_found = find_closest_antenna_match(ant_in, ant_out, ant_idx);
+  if (ant_found>0) {
+    return ant_found;
+  } else if (!ant_found && must_match_serial) {
+    return 10;
+  }
+
+  return collect(ant_idx, pco_list, &pcv_list);
 }
 
 /// Get the list of PCO values for a given receiver antenna (aka PCO values for
@@ -547,42 +838,43 @@ int
 Antex::get_antenna_pco(const ReceiverAntenna& ant_in, AntennaPcoList& pco_list,
                        bool must_match_serial) noexcept
 {
-  pos_type         ant_pos;
+  std::size_t      ant_idx;
   ReceiverAntenna  ant_out;
 
   // clean any entries in pco_list
   pco_list.__vecref__().clear();
 
   // match the antenna
-  int ant_found = find_closest_antenna_match(ant_in, ant_out, ant_pos);
+  int ant_found = find_closest_antenna_match(ant_in, ant_out, ant_idx);
   if (ant_found>0) {
     return ant_found;
   } else if (!ant_found && must_match_serial) {
     return 10;
   }
 
-  // go to the position where the antenna was found
-  __istream.seekg(ant_pos, std::ios_base::beg);
-
-  // we should now be ready to read "METH / BY / # / DATE"
-  int status = collect_pco(__istream, pco_list);
-
-  return status;
+  return collect(ant_idx, pco_list);
 }
 
-/// @brief Collect PCO values for a satellite/receiver antenna
+/// @brief Collect PCO (and optionally PCV) values for a satellite/receiver
+///        antenna
 ///
 /// Given an antex input stream (aka its __istream), placed just after the
 /// field "TYPE / SERIAL NO" (i.e. next line to read should be the field
 /// "METH / BY / # / DATE"), collect the list of PCO values (for every
-/// satellite-system and observation code recorded).
+/// satellite-system and observation code recorded). If pcv_list is not
+/// nullptr, the phase centre variation grids (NOAZI and, if DAZI is not
+/// zero, azimuth-dependent values) are collected too, one AntennaPcv per
+/// frequency.
 ///
 /// @param[in] fin       The antex input stream (aka instance's __istream)
 /// @param[out] pco_list Collected PCO values
+/// @param[out] pcv_list If not nullptr, collected PCV grids (appended)
 /// @return              Anything other than 0 denotes an error.
 int
-collect_pco(std::ifstream& fin, ngpt::AntennaPcoList& pco_list) noexcept
+collect_pco(std::ifstream& fin, ngpt::AntennaPcoList& pco_list,
+  ngpt::AntennaPcvList* pcv_list) noexcept
 {
+  using ngpt::rinex::fixed_width_to_double;
   char hline[MAX_HEADER_CHARS];
   char gline[MAX_GRID_CHARS];
   char tmp[11];
@@ -594,17 +886,27 @@ collect_pco(std::ifstream& fin, ngpt::AntennaPcoList& pco_list) noexcept
   }
 
   // next field is 'DAZI'
+  double dazi;
   if (!fin.getline(hline, MAX_HEADER_CHARS)
-      || std::strncmp(hline+60, "DAZI", 4)) {
-    // dazi = std::stof(hline+2, nullptr);
+      || std::strncmp(hline+60, "DAZI", 4)
+      || !fixed_width_to_double(hline+2, 6, dazi)) {
     return 2;
   }
 
   // next field is 'ZEN1 / ZEN2 / DZEN'
+  double zen[3];
   if (!fin.getline(hline, MAX_HEADER_CHARS)
-      || std::strncmp(hline+60, "ZEN1 / ZEN2 / DZEN", 18)) {
+      || std::strncmp(hline+60, "ZEN1 / ZEN2 / DZEN", 18)
+      || !ngpt::rinex::fixed_width_to_doubles<3,6>(hline+2, zen)) {
     return 3;
   }
+  int num_zen = 0;
+  if (zen[2]>0e0) num_zen = static_cast<int>(std::round((zen[1]-zen[0])/zen[2]))+1;
+  // make sure a grid line fits in the buffer
+  if (pcv_list && (num_zen<2 || 8*(std::size_t)num_zen >= MAX_GRID_CHARS-10)) {
+    return 3;
+  }
+  const int num_azi = (dazi>0e0) ? static_cast<int>(std::round(360e0/dazi))+1 : 0;
 
   // next field is '# OF FREQUENCIES'
   int num_of_freqs = 0;
@@ -668,6 +970,34 @@ collect_pco(std::ifstream& fin, ngpt::AntennaPcoList& pco_list) noexcept
     }
     // assign to a new pco and add to list
     pco_list.__vecref__().emplace_back(obsc, ss, dn, de, du);
+    // collect the pcv grid: NOAZI, then one row per azimuth
+    if (pcv_list) {
+      try {
+        pcv_list->__vecref__().emplace_back(obsc, ss, zen[0], zen[1], zen[2],
+          dazi);
+      } catch (std::exception&) {
+        return 8;
+      }
+      ngpt::AntennaPcv& pcv = pcv_list->__vecref__().back();
+      double azi;
+      for (int row=-1; row<num_azi; row++) {
+        double* values = (row<0) ? pcv.noazi() : pcv.azimuth_row(row);
+        if (!fin.getline(gline, MAX_GRID_CHARS)
+            || std::strlen(gline) < 8+8*(std::size_t)num_zen
+            || (row<0 && std::strncmp(gline+3, "NOAZI", 5))) {
+          return 9;
+        }
+        // each azimuth row starts with its azimuth (F8.1), which must be
+        // the next DAZI step; a missing or extra row is an error
+        if (row>=0 && (!fixed_width_to_double(gline, 8, azi)
+            || std::abs(azi-row*dazi) > 0.05e0)) {
+          return 9;
+        }
+        for (int j=0; j<num_zen; j++) {
+          if (!fixed_width_to_double(gline+8+8*j, 8, values[j])) return 9;
+        }
+      }
+    }
     // skip lines until "END OF FREQUENCY"
     do {
       fin.getline(gline, MAX_GRID_CHARS);
@@ -2,9 +2,14 @@
 #define __ANTEXX_HPP__
 
 #include <fstream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include "satellite.hpp"
 #include "antenna.hpp"
 #include "antenna_pcv.hpp"
+#include "mmap_file.hpp"
 #include "ggdatetime/dtcalendar.hpp"
 
 /// @file      antex.hpp
@@ -30,7 +35,34 @@
 namespace ngpt
 {
 
+/// @brief A satellite antenna record (and its PCO values), as returned by
+///        bulk queries (see Antex::get_antenna_pco).
+struct SatelliteAntennaPco
+{
+  SATELLITE_SYSTEM              system; ///< Satellite system
+  int                           prn;    ///< PRN (or slot, SVID, etc)
+  ngpt::datetime<ngpt::seconds> from;   ///< "VALID FROM"
+  ngpt::datetime<ngpt::seconds> to;     ///< "VALID UNTIL"; datetime::max()
+                                        ///< if not recorded
+  AntennaPcoList                pco;    ///< PCO values of the record
+};
+
 /// @class Antex
+/// At construction, the header is read and the whole file is scanned once to
+/// build an index of antennas; receiver antennas are hashed on model+radome
+/// and satellite antennas on (satellite system, PRN). For every satellite,
+/// the validity intervals ("VALID FROM"/"VALID UNTIL") of its antenna
+/// records are kept sorted, so that finding the record valid at an epoch is
+/// a binary search. Queries then go straight to the position of the
+/// matching antenna block in the stream, instead of scanning the file.
+///
+/// The parsed contents (antenna names, validity intervals, PCO values and PCV
+/// grids) can be serialized to a binary cache file (see Antex::write_cache).
+/// An instance constructed with a cache filename memory-maps the cache, if it
+/// is valid for the ANTEX file (same size, modification time and content
+/// hash), and serves all queries from the mapped region; the ANTEX file is
+/// then never parsed. If the cache is missing or stale, the ANTEX file is
+/// parsed and the cache is (re)written.
 /// @see ftp://igs.org/pub/station/general/antex14.txt
 class Antex
 {
@@ -48,6 +80,9 @@ public:
   explicit
   Antex(const char*);
 
+  /// @brief Constructor from filename, using (or creating) a binary cache.
+  Antex(const char* filename, const char* cache_filename);
+
   /// @brief Destructor (closing the file is not mandatory, but nevertheless)
   ~Antex() noexcept 
   { 
@@ -76,12 +111,121 @@ public:
                   const ngpt::datetime<ngpt::seconds>& at,
                   AntennaPcoList& pco_list) noexcept;
 
+  /// @brief Get the satellite antenna records (and PCO values) valid within
+  ///        a time span, for all satellites (of a system).
+  int
+  get_antenna_pco(const ngpt::datetime<ngpt::seconds>& start,
+                  const ngpt::datetime<ngpt::seconds>& stop,
+                  std::vector<SatelliteAntennaPco>& list,
+                  SATELLITE_SYSTEM ss=SATELLITE_SYSTEM::mixed) noexcept;
+
+  /// @brief Get PCO values and PCV grids for a receiver antenna.
+  int
+  get_antenna_pcv(const ReceiverAntenna& ant_in, AntennaPcoList& pco_list,
+                  AntennaPcvList& pcv_list, bool must_match_serial=false)
+  noexcept;
+
+  /// @brief Get PCO values and PCV grids for a satellite antenna.
+  int
+  get_antenna_pcv(int prn, SATELLITE_SYSTEM ss,
+                  const ngpt::datetime<ngpt::seconds>& at,
+                  AntennaPcoList& pco_list, AntennaPcvList& pcv_list) noexcept;
+
+  /// @brief Number of (indexed) antennas in the file.
+  std::size_t
+  num_antennas() const noexcept
+  {return __antennas.size();}
+
+  /// @brief Check if queries are served from a (memory-mapped) binary cache.
+  bool
+  uses_cache() const noexcept
+  {return __cache.is_mapped();}
+
 private:
 
+  /// @brief An antenna record of the ANTEX file, as indexed.
+  struct AntennaRecord
+  {
+    ReceiverAntenna  antenna; ///< Antenna as recorded (model+radome+serial)
+    pos_type         pos;     ///< Stream position of the line following
+                              ///< "TYPE / SERIAL NO" (unused if the
+                              ///< instance uses a cache)
+    SATELLITE_SYSTEM system;  ///< System of a satellite antenna; mixed for
+                              ///< any other antenna
+    int              prn;     ///< PRN of a satellite antenna
+  };
+
+  /// @brief Validity interval of a satellite antenna record.
+  struct SatInterval
+  {
+    ngpt::datetime<ngpt::seconds> from;   ///< "VALID FROM"
+    ngpt::datetime<ngpt::seconds> to;     ///< "VALID UNTIL" (or max())
+    ngpt::datetime<ngpt::seconds> max_to; ///< Max "VALID UNTIL" of this and
+                                          ///< all preceding intervals
+    std::size_t                   idx;    ///< Index in __antennas
+  };
+
+  /// @brief Key of a satellite antenna in the satellite antenna index.
+  static int
+  sat_key(SATELLITE_SYSTEM ss, int prn) noexcept
+  {return (static_cast<int>(ss)<<16) + prn;}
+
   /// @brief Read the instance header, and assign (most of) the fields.
   int
   read_header() noexcept;
 
+  /// @brief Scan the file (after the header) and index all antennas.
+  int
+  build_index() noexcept;
+
+  /// @brief Add an antenna to the indexes (satellite antenna if ss is not
+  ///        mixed).
+  void
+  index_antenna(const ReceiverAntenna& antenna, pos_type pos,
+                SATELLITE_SYSTEM ss, int prn);
+
+  /// @brief Add the validity interval of the idx-th (satellite) antenna to
+  ///        the satellite index.
+  void
+  index_interval(std::size_t idx, const ngpt::datetime<ngpt::seconds>& from,
+                 const ngpt::datetime<ngpt::seconds>& to);
+
+  /// @brief Sort the intervals of the satellite index.
+  void
+  sort_intervals() noexcept;
+
+  /// @brief Size, modification time and content hash of the ANTEX file.
+  struct SourceSignature
+  {
+    std::uint64_t size;  ///< Size (bytes)
+    std::int64_t  mtime; ///< Modification time
+    std::uint64_t hash;  ///< Hash of the contents
+  };
+
+  /// @brief Take the signature of the ANTEX file.
+  int
+  source_signature(SourceSignature& sig) const noexcept;
+
+  /// @brief Map a binary cache and index its antennas, if it is valid.
+  int
+  load_cache(const char* cache_filename) noexcept;
+
+  /// @brief Serialize the parsed contents of the instance to a binary cache.
+  int
+  write_cache(const char* cache_filename) noexcept;
+
+  /// @brief Collect the PCO values (and optionally PCV grids) of the idx-th
+  ///        antenna.
+  int
+  collect(std::size_t idx, AntennaPcoList& pco_list,
+          AntennaPcvList* pcv_list=nullptr) noexcept;
+
+  /// @brief PCO values (and optionally PCV grids) of the idx-th antenna,
+  ///        from the cache.
+  int
+  collect_cached(std::size_t idx, AntennaPcoList& pco_list,
+                 AntennaPcvList* pcv_list) const noexcept;
+
   /// @brief Read next antenna (from the stream)
   int
   read_next_antenna_type(ReceiverAntenna& antenna, char* c=nullptr) noexcept;
@@ -94,19 +238,31 @@ private:
   int
   find_closest_antenna_match(const ReceiverAntenna& ant_in,
                              ReceiverAntenna& ant_out,
-                             pos_type& ant_pos) noexcept;
+                             std::size_t& ant_idx) noexcept;
 
   /// @brief Try to match a given satellite antenna, for a given epoch.
   int
   find_satellite_antenna(int, SATELLITE_SYSTEM,
                          const ngpt::datetime<ngpt::seconds>& at,
-                         pos_type&) noexcept;
+                         std::size_t&) noexcept;
 
   std::string            __filename;    ///< The name of the antex file.
   std::ifstream          __istream;     ///< The infput (file) stream.
   SATELLITE_SYSTEM       __satsys;      ///< satellite system.
   ATX_VERSION            __version;     ///< Atx version (1.4).
   pos_type               __end_of_head; ///< Mark the 'END OF HEADER' field.
+  MappedFile             __cache;       ///< Binary cache (if used).
+  SourceSignature        __src_sig {};  ///< Signature of the ANTEX file,
+                                        ///< taken before it is parsed (only
+                                        ///< if constructed with a cache).
+  /// All antennas (receiver and satellite), in file order
+  std::vector<AntennaRecord>                                 __antennas;
+  /// Antennas (receiver and satellite) keyed on model+radome; indexes in
+  /// __antennas, in file order
+  std::unordered_map<std::string, std::vector<std::size_t>> __rcv_index;
+  /// Validity intervals of satellite antennas keyed on sat_key(system, prn);
+  /// sorted on "VALID FROM" (see Antex::sort_intervals)
+  std::unordered_map<int, std::vector<SatInterval>>         __sat_index;
 }; // Antex
 
 } // ngpt
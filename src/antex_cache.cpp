@@ -0,0 +1,484 @@
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <type_traits>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "antex.hpp"
+
+using ngpt::Antex;
+using ngpt::ReceiverAntenna;
+
+namespace
+{
+/// Magic bytes at the start of every cache file.
+constexpr char cache_magic[8] = {'N','G','P','T','A','T','X','C'};
+
+/// Version of the cache layout; bump on any change to the records below.
+constexpr std::uint32_t cache_version { 1 };
+
+/// Written in native byte order; a cache written on a machine of different
+/// byte order will not match it.
+constexpr std::uint32_t cache_byte_order { 0x01020304 };
+
+/// Flags of CacheAntenna::flags.
+constexpr std::uint32_t has_from_flag { 1 };
+constexpr std::uint32_t has_to_flag   { 2 };
+
+/// @brief Header of a cache file.
+///
+/// The header is followed by four arrays: num_antennas CacheAntenna records
+/// (in file order), num_pco CachePco records, num_pcv CachePcv records and
+/// num_values doubles (the PCV grids). All records are multiples of 8 bytes,
+/// so every array is properly aligned within the (page-aligned) mapping.
+struct CacheHeader
+{
+  char          magic[8];     ///< cache_magic
+  std::uint32_t version;      ///< cache_version
+  std::uint32_t byte_order;   ///< cache_byte_order
+  std::uint64_t src_size;     ///< Size of the ANTEX file (bytes)
+  std::int64_t  src_mtime;    ///< Modification time of the ANTEX file
+  std::uint64_t src_hash;     ///< Hash of the ANTEX file contents
+  std::uint64_t num_antennas; ///< Number of CacheAntenna records
+  std::uint64_t num_pco;      ///< Number of CachePco records
+  std::uint64_t num_pcv;      ///< Number of CachePcv records
+  std::uint64_t num_values;   ///< Number of PCV values
+  std::int32_t  atx_version;  ///< Antex::ATX_VERSION
+  std::int32_t  satsys;       ///< SATELLITE_SYSTEM of the ANTEX file
+};
+
+/// @brief An antenna of the ANTEX file.
+struct CacheAntenna
+{
+  char          name[48];     ///< Model+radome+serial (ReceiverAntenna)
+  std::int32_t  satsys;       ///< SATELLITE_SYSTEM (-1 if not a satellite
+                              ///< antenna)
+  std::int32_t  prn;          ///< PRN (satellite antennas)
+  std::int64_t  from_mjd;     ///< "VALID FROM", MJD
+  std::int64_t  from_sec;     ///< "VALID FROM", seconds of day
+  std::int64_t  to_mjd;       ///< "VALID UNTIL", MJD
+  std::int64_t  to_sec;       ///< "VALID UNTIL", seconds of day
+  std::uint32_t flags;        ///< has_from_flag | has_to_flag
+  std::uint32_t num_pco;      ///< Number of PCO (and PCV) records
+  std::uint64_t first_pco;    ///< Index of the first CachePco record
+  std::uint64_t first_pcv;    ///< Index of the first CachePcv record
+};
+
+/// @brief A PCO value (one per frequency).
+struct CachePco
+{
+  std::int32_t  satsys;       ///< SATELLITE_SYSTEM
+  std::int32_t  band;         ///< ObservationCode band
+  double        dn, de, du;   ///< Eccentricities (mm)
+};
+
+/// @brief A PCV grid (one per frequency).
+struct CachePcv
+{
+  std::int32_t  satsys;       ///< SATELLITE_SYSTEM
+  std::int32_t  band;         ///< ObservationCode band
+  std::int32_t  nzen;         ///< Number of zenith angles
+  std::int32_t  nazi;         ///< Number of azimuths
+  double        zen1;         ///< ZEN1 (deg)
+  double        dzen;         ///< DZEN (deg)
+  double        dazi;         ///< DAZI (deg)
+  std::uint64_t first_value;  ///< Index of the first (NOAZI) value
+};
+
+static_assert(sizeof(CacheHeader)==80 && sizeof(CacheAntenna)==112
+  && sizeof(CachePco)==32 && sizeof(CachePcv)==48,
+  "Unexpected padding in ANTEX cache records");
+static_assert(std::is_trivially_copyable<CacheAntenna>::value
+  && std::is_trivially_copyable<CachePcv>::value,
+  "ANTEX cache records must be trivially copyable");
+
+/// @brief Pointers to the arrays of a (mapped) cache file.
+struct CacheView
+{
+  const CacheHeader*  hdr;
+  const CacheAntenna* ant;
+  const CachePco*     pco;
+  const CachePcv*     pcv;
+  const double*       val;
+};
+
+/// @brief Resolve the arrays of a (mapped, validated) cache file.
+CacheView
+cache_view(const char* base) noexcept
+{
+  CacheView v;
+  v.hdr = reinterpret_cast<const CacheHeader*>(base);
+  v.ant = reinterpret_cast<const CacheAntenna*>(base+sizeof(CacheHeader));
+  v.pco = reinterpret_cast<const CachePco*>(v.ant + v.hdr->num_antennas);
+  v.pcv = reinterpret_cast<const CachePcv*>(v.pco + v.hdr->num_pco);
+  v.val = reinterpret_cast<const double*>(v.pcv + v.hdr->num_pcv);
+  return v;
+}
+
+/// @brief Hash a memory region; FNV-1a on 8-byte words, with an xor-shift
+///        after every multiplication so that high bits feed back. Four
+///        interleaved lanes (combined at the end) keep the multiplier busy;
+///        a single lane is latency-bound, at about half the speed.
+std::uint64_t
+hash_bytes(const char* data, std::size_t size) noexcept
+{
+  constexpr std::uint64_t prime { 0x100000001b3ULL };
+  constexpr std::uint64_t basis { 0xcbf29ce484222325ULL };
+  std::uint64_t h[4] = {basis, basis+1, basis+2, basis+3};
+  std::size_t i = 0;
+  for (; i+32<=size; i+=32) {
+    for (int k=0; k<4; k++) {
+      std::uint64_t w;
+      std::memcpy(&w, data+i+8*k, 8);
+      h[k]  = (h[k]^w)*prime;
+      h[k] ^= h[k]>>32;
+    }
+  }
+  for (; i<size; i++) {
+    h[0] = (h[0]^static_cast<unsigned char>(data[i]))*prime;
+  }
+  std::uint64_t hash = size;
+  for (int k=0; k<4; k++) {
+    hash  = (hash^h[k])*prime;
+    hash ^= hash>>32;
+  }
+  return hash;
+}
+
+/// @brief Check that an int is a valid SATELLITE_SYSTEM.
+inline bool
+valid_satsys(std::int32_t ss) noexcept
+{
+  return ss >= 0 && ss <= static_cast<std::int32_t>(ngpt::SATELLITE_SYSTEM::mixed);
+}
+}// anonymous namespace
+
+/// @details Take the size, modification time and content hash of the
+///          instance's ANTEX file.
+/// @param[out] sig The signature of the ANTEX file
+/// @return     Anything other than 0 denotes an error.
+int
+Antex::source_signature(SourceSignature& sig) const noexcept
+{
+  struct stat sb;
+  if (::stat(__filename.c_str(), &sb)) return 1;
+  sig.size  = static_cast<std::uint64_t>(sb.st_size);
+  sig.mtime = static_cast<std::int64_t>(sb.st_mtime);
+  try {
+    ngpt::MappedFile src (__filename.c_str());
+    sig.hash = hash_bytes(src.begin(), src.size());
+  } catch (std::exception&) {
+    return 2;
+  }
+  return 0;
+}
+
+/// @details Map a binary cache file (see Antex::write_cache) and, if it is
+///          valid for the instance's ANTEX file, index its antennas. The
+///          cache is valid if:
+///          - its magic bytes, layout version and byte order match, and
+///          - the recorded size, modification time and content hash match
+///            the signature of the ANTEX file (__src_sig, taken at
+///            construction), and
+///          - its (sizes and) records are consistent; every record is
+///            checked here, so that queries can trust the mapped region.
+///          On success, __cache holds the mapping and the instance serves
+///          all queries from it. On failure, nothing is mapped and the
+///          indexes are left empty.
+/// @param[in] cache_filename The filename of the binary cache
+/// @return    Anything other than 0 denotes an invalid (or missing) cache;
+///            9 if memory could not be allocated for the indexes.
+int
+Antex::load_cache(const char* cache_filename) noexcept
+{
+  try {
+    __cache = MappedFile(cache_filename);
+  } catch (std::exception&) {
+    return 1;
+  }
+
+  const std::size_t size = __cache.size();
+  if (size < sizeof(CacheHeader)) {
+    __cache = MappedFile();
+    return 2;
+  }
+
+  const CacheHeader* hdr = reinterpret_cast<const CacheHeader*>(__cache.begin());
+  if (std::memcmp(hdr->magic, cache_magic, sizeof(cache_magic))
+      || hdr->version != cache_version
+      || hdr->byte_order != cache_byte_order
+      || !valid_satsys(hdr->satsys)
+      || (hdr->atx_version != static_cast<std::int32_t>(ATX_VERSION::v14)
+          && hdr->atx_version != static_cast<std::int32_t>(ATX_VERSION::v13))) {
+    __cache = MappedFile();
+    return 3;
+  }
+
+  if (__src_sig.size != hdr->src_size
+      || __src_sig.mtime != hdr->src_mtime
+      || __src_sig.hash != hdr->src_hash) {
+    __cache = MappedFile();
+    return 4;
+  }
+
+  // sizes; bound every count first, so that the sum cannot overflow
+  if (hdr->num_antennas > size/sizeof(CacheAntenna)
+      || hdr->num_pco > size/sizeof(CachePco)
+      || hdr->num_pcv > size/sizeof(CachePcv)
+      || hdr->num_values > size/sizeof(double)
+      || size != sizeof(CacheHeader) + hdr->num_antennas*sizeof(CacheAntenna)
+         + hdr->num_pco*sizeof(CachePco) + hdr->num_pcv*sizeof(CachePcv)
+         + hdr->num_values*sizeof(double)) {
+    __cache = MappedFile();
+    return 5;
+  }
+
+  const CacheView v = cache_view(__cache.begin());
+  int status = 0;
+  for (std::uint64_t i=0; i<hdr->num_pco && !status; i++) {
+    if (!valid_satsys(v.pco[i].satsys)) status = 6;
+  }
+  for (std::uint64_t i=0; i<hdr->num_pcv && !status; i++) {
+    const CachePcv& p = v.pcv[i];
+    if (!valid_satsys(p.satsys) || p.nzen < 2 || p.nazi < 0 || p.nazi == 1
+        || !(p.dzen > 0e0) || (p.nazi && !(p.dazi > 0e0))
+        || p.first_value > hdr->num_values
+        || static_cast<std::uint64_t>(p.nazi+1)*p.nzen
+           > hdr->num_values-p.first_value) {
+      status = 7;
+    }
+  }
+
+  __antennas.clear();
+  __rcv_index.clear();
+  __sat_index.clear();
+  try {
+    for (std::uint64_t i=0; i<hdr->num_antennas && !status; i++) {
+      const CacheAntenna& a = v.ant[i];
+      if (a.name[sizeof(a.name)-1] != '\0'
+          || (a.satsys != -1 && !valid_satsys(a.satsys))
+          || a.first_pco > hdr->num_pco || a.num_pco > hdr->num_pco-a.first_pco
+          || a.first_pcv > hdr->num_pcv || a.num_pco > hdr->num_pcv-a.first_pcv) {
+        status = 8;
+        break;
+      }
+      ReceiverAntenna ant (a.name);
+      if (std::strlen(a.name) > 20) {
+        for (int j = 20; a.name[j]; j++) {
+          if (a.name[j] != ' ') {
+            ant.set_serial_nr(a.name+20);
+            break;
+          }
+        }
+      }
+      const SATELLITE_SYSTEM ss = (a.satsys < 0)
+        ? SATELLITE_SYSTEM::mixed
+        : static_cast<SATELLITE_SYSTEM>(a.satsys);
+      index_antenna(ant, pos_type(0), ss, a.prn);
+      if (ss != SATELLITE_SYSTEM::mixed && (a.flags & has_from_flag)) {
+        index_interval(__antennas.size()-1,
+          ngpt::datetime<ngpt::seconds>(ngpt::modified_julian_day(a.from_mjd),
+                                        ngpt::seconds(a.from_sec)),
+          (a.flags & has_to_flag)
+          ? ngpt::datetime<ngpt::seconds>(ngpt::modified_julian_day(a.to_mjd),
+                                          ngpt::seconds(a.to_sec))
+          : ngpt::datetime<ngpt::seconds>::max());
+      }
+    }
+  } catch (std::exception&) {
+    status = 9;
+  }
+  sort_intervals();
+
+  if (status) {
+    __antennas.clear();
+    __rcv_index.clear();
+    __sat_index.clear();
+    __cache = MappedFile();
+    return status;
+  }
+
+  __version = static_cast<ATX_VERSION>(hdr->atx_version);
+  __satsys  = static_cast<SATELLITE_SYSTEM>(hdr->satsys);
+  return 0;
+}
+
+/// @details Collect the PCO values (and, if pcv_list is not nullptr, the PCV
+///          grids) of the idx-th antenna from the (mapped) cache. The lists
+///          are appended; the PCV values are copied straight from the
+///          mapping.
+/// @param[in]  idx      Index of the antenna (in __antennas)
+/// @param[out] pco_list Collected PCO values
+/// @param[out] pcv_list If not nullptr, collected PCV grids
+/// @return     Anything other than 0 denotes an error.
+int
+Antex::collect_cached(std::size_t idx, AntennaPcoList& pco_list,
+                      AntennaPcvList* pcv_list) const noexcept
+{
+  const CacheView v = cache_view(__cache.begin());
+  const CacheAntenna& a = v.ant[idx];
+  ObservationCode obsc;
+
+  for (std::uint32_t i=0; i<a.num_pco; i++) {
+    const CachePco& p = v.pco[a.first_pco+i];
+    obsc.band() = p.band;
+    try {
+      pco_list.__vecref__().emplace_back(obsc,
+        static_cast<SATELLITE_SYSTEM>(p.satsys), p.dn, p.de, p.du);
+    } catch (std::exception&) {
+      return 8;
+    }
+  }
+
+  if (pcv_list) {
+    for (std::uint32_t i=0; i<a.num_pco; i++) {
+      const CachePcv& p = v.pcv[a.first_pcv+i];
+      obsc.band() = p.band;
+      try {
+        pcv_list->__vecref__().emplace_back(obsc,
+          static_cast<SATELLITE_SYSTEM>(p.satsys), p.zen1,
+          p.zen1+(p.nzen-1)*p.dzen, p.dzen, p.dazi);
+      } catch (std::exception&) {
+        return 8;
+      }
+      AntennaPcv& pcv = pcv_list->__vecref__().back();
+      if (pcv.num_zenith() != p.nzen || pcv.num_azimuth() != p.nazi) {
+        return 9;
+      }
+      std::memcpy(pcv.noazi(), v.val+p.first_value,
+        sizeof(double)*(p.nazi+1)*p.nzen);
+    }
+  }
+
+  return 0;
+}
+
+/// @details Serialize the parsed contents of the instance (every antenna,
+///          its validity interval, PCO values and PCV grids) to a binary
+///          cache file, to be memory-mapped by later instances (see
+///          Antex::Antex(const char*, const char*)). The cache records the
+///          size, modification time and content hash of the ANTEX file as
+///          taken at construction, before the file was parsed (__src_sig),
+///          so that a stale cache is never used; if the file has changed
+///          since (i.e. while it was parsed), no cache is written.
+///          The cache is first written to a temporary file (in the same
+///          directory) which is then renamed, so that concurrent readers
+///          see either the old or the new cache, never a partial one.
+/// @param[in] cache_filename The filename of the binary cache
+/// @return    Anything other than 0 denotes an error (no cache written); 6
+///            if the ANTEX file changed after construction, 7 if memory
+///            could not be allocated.
+int
+Antex::write_cache(const char* cache_filename) noexcept
+{
+  CacheHeader hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, cache_magic, sizeof(cache_magic));
+  hdr.version     = cache_version;
+  hdr.byte_order  = cache_byte_order;
+  hdr.atx_version = static_cast<std::int32_t>(__version);
+  hdr.satsys      = static_cast<std::int32_t>(__satsys);
+  hdr.src_size    = __src_sig.size;
+  hdr.src_mtime   = __src_sig.mtime;
+  hdr.src_hash    = __src_sig.hash;
+
+  std::vector<CacheAntenna> ants;
+  std::vector<CachePco>     pcos;
+  std::vector<CachePcv>     pcvs;
+  std::vector<double>       values;
+  try {
+    ants.resize(__antennas.size());
+    std::memset(ants.data(), 0, sizeof(CacheAntenna)*ants.size());
+    for (const auto& it : __sat_index) {
+      for (const auto& i : it.second) {
+        CacheAntenna& a = ants[i.idx];
+        a.flags   |= has_from_flag;
+        a.from_mjd = i.from.mjd().as_underlying_type();
+        a.from_sec = i.from.sec().as_underlying_type();
+        if (i.to < ngpt::datetime<ngpt::seconds>::max()) {
+          a.flags |= has_to_flag;
+          a.to_mjd = i.to.mjd().as_underlying_type();
+          a.to_sec = i.to.sec().as_underlying_type();
+        }
+      }
+    }
+
+    AntennaPcoList pco;
+    AntennaPcvList pcv;
+    for (std::size_t idx=0; idx<__antennas.size(); idx++) {
+      CacheAntenna& a = ants[idx];
+      const AntennaRecord& rec = __antennas[idx];
+      const char* name = rec.antenna.__underlying_char__();
+      std::memcpy(a.name, name,
+        ::strnlen(name, antenna_details::antenna_full_max_chars-1));
+      a.satsys = (rec.system == SATELLITE_SYSTEM::mixed)
+        ? -1 : static_cast<std::int32_t>(rec.system);
+      a.prn    = rec.prn;
+      pco.__vecref__().clear();
+      pcv.__vecref__().clear();
+      if (collect(idx, pco, &pcv) || pco.__vecref__().size() != pcv.__vecref__().size()) {
+        return 3;
+      }
+      a.num_pco   = static_cast<std::uint32_t>(pco.__vecref__().size());
+      a.first_pco = pcos.size();
+      a.first_pcv = pcvs.size();
+      for (const auto& p : pco.__vecref__()) {
+        pcos.push_back(CachePco{static_cast<std::int32_t>(p.system()),
+          p.obs_code().band(), p.dn(), p.de(), p.du()});
+      }
+      for (const auto& p : pcv.__vecref__()) {
+        pcvs.push_back(CachePcv{static_cast<std::int32_t>(p.system()),
+          p.obs_code().band(), p.num_zenith(), p.num_azimuth(), p.zen1(),
+          p.dzen(), p.dazi(), values.size()});
+        values.insert(values.end(), p.grid(),
+          p.grid()+(p.num_azimuth()+1)*p.num_zenith());
+      }
+    }
+    hdr.num_antennas = ants.size();
+    hdr.num_pco      = pcos.size();
+    hdr.num_pcv      = pcvs.size();
+    hdr.num_values   = values.size();
+  } catch (std::exception&) {
+    return 7;
+  }
+
+  // the ANTEX file must not have changed since construction
+  SourceSignature sig;
+  if (source_signature(sig) || sig.size != __src_sig.size
+      || sig.mtime != __src_sig.mtime || sig.hash != __src_sig.hash) {
+    return 6;
+  }
+
+  // write to a temporary file and rename
+  std::string tmp;
+  try {
+    tmp = std::string(cache_filename) + ".tmp" + std::to_string(::getpid());
+    std::ofstream fout (tmp, std::ios_base::out | std::ios_base::binary
+                             | std::ios_base::trunc);
+    fout.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    fout.write(reinterpret_cast<const char*>(ants.data()),
+               sizeof(CacheAntenna)*ants.size());
+    fout.write(reinterpret_cast<const char*>(pcos.data()),
+               sizeof(CachePco)*pcos.size());
+    fout.write(reinterpret_cast<const char*>(pcvs.data()),
+               sizeof(CachePcv)*pcvs.size());
+    fout.write(reinterpret_cast<const char*>(values.data()),
+               sizeof(double)*values.size());
+    fout.close();
+    if (!fout) {
+      std::remove(tmp.c_str());
+      return 4;
+    }
+  } catch (std::exception&) {
+    if (!tmp.empty()) std::remove(tmp.c_str());
+    return 7;
+  }
+  if (std::rename(tmp.c_str(), cache_filename)) {
+    std::remove(tmp.c_str());
+    return 5;
+  }
+
+  return 0;
+}
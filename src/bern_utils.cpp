@@ -1,6 +1,9 @@
 #include <stdexcept>
 #include <cstring>
+#include <cstdlib>
+#include <cerrno>
 #include <cassert>
+#include <algorithm>
 #include "bern_utils.hpp"
 #include "ggdatetime/datetime_read.hpp"
 #ifdef DEBUG
@@ -10,26 +13,53 @@
 
 constexpr int MAX_SATELLIT_CHARS = 256;
 
-/// Constructor; after this, the stream will be opened, and the start of
-/// 'PART 2' of the file marked.
+/// Constructor; after this, the file has been validated and all microwave
+/// sensor records of 'PART 2' are indexed (the file is closed).
 ///
 /// @param[in] fn  The SATELLIT's filename
 /// @throw std::runtime_error If the file cannot be found/opened or the call
 ///        to BernSatellit::initialize() fails
 ngpt::BernSatellit::BernSatellit(const char* fn)
   : __filename(fn)
-  , __istream(fn, std::ios_base::in)
-  , __part2(0)
 {
   if (initialize()) {
-      if (__istream.is_open()) __istream.close();
-      throw std::runtime_error("[ERROR] BernSatellit::BernSatellit Failed to read SATELLIT header");
+      throw std::runtime_error("[ERROR] BernSatellit::BernSatellit Failed to read SATELLIT file");
   }
 }
 
-/// Search through all the record lines in 'PART 2' block of the file, to
-/// match a GLONASS satellite with the given svn for the given time interval.
-/// If such a satellite is found, return the recorded frequency channel.
+/// Find the record of an SVN valid at a given epoch, aka start <= eph < stop.
+/// The records of the SVN are sorted on start time; the last record starting
+/// at or before eph is found by binary search. If records overlap, the search
+/// continues backwards while the running maximum of the end times is after
+/// eph, and the first matching record in file order is chosen (as a scan of
+/// the file would).
+/// @param[in] svn The SVN of the satellite
+/// @param[in] eph The time/epoch for which we want the satellite
+/// @return    A pointer to the matched record, or nullptr if none matched
+const ngpt::BernSatellit::SensorRecord*
+ngpt::BernSatellit::find_record(int svn,
+  const ngpt::datetime<ngpt::seconds>& eph) const noexcept
+{
+  auto it = __svn_index.find(svn);
+  if (it == __svn_index.end()) return nullptr;
+
+  const auto& v = it->second;
+  auto last = std::upper_bound(v.begin(), v.end(), eph,
+    [](const ngpt::datetime<ngpt::seconds>& t, const SensorRecord& r) {
+      return t < r.start;
+    });
+  const SensorRecord* rec = nullptr;
+  while (last != v.begin()) {
+    --last;
+    if (last->max_stop <= eph) break;
+    if (eph < last->stop && (!rec || last->order < rec->order)) rec = &*last;
+  }
+  return rec;
+}
+
+/// Match a GLONASS satellite with the given svn for the given time interval,
+/// among the (indexed) microwave sensor records of 'PART 2' of the file. If
+/// such a satellite is found, return the recorded frequency channel.
 /// @param[in]  svn   The SVN of the GLONASS satellite
 /// @param[in]  eph   The time/epoch for which we want the satellite
 /// @param[out] ifrqn The frequency channel of the given satellite for the given
@@ -38,74 +68,71 @@ ngpt::BernSatellit::BernSatellit(const char* fn)
 ///                   SATELLIT file
 /// @return    -1 -> Satellite not matched in file
 ///             0 -> Satellite matched and ifrqn assigned 
-///            >0 -> An error occured while reading the records
+///            Errors in the records are reported at construction.
 int
 ngpt::BernSatellit::get_frequency_channel(int svn, 
   const ngpt::datetime<ngpt::seconds>& eph, int& ifrqn, int& prn)
+const noexcept
 {
-  const int max_lines = 1000;
-  char line[MAX_SATELLIT_CHARS];
-
-  // The stream should be open by now!
-  if (!__istream.is_open()) return 1;
-
-  // Go to the top of the relevant field (in file)
-  __istream.seekg(__part2);
+  const SensorRecord* rec = find_record(svn, eph);
+  if (!rec) return -1;
+  prn   = rec->prn;
+  ifrqn = rec->ifrqn;
+  return 0;
+}
 
-  // keep reading untill we match svn and epoch
-  int line_count=0, csvn;
-  char* end;
-  bool satellite_matched = false;
-  ngpt::datetime<ngpt::seconds> start, stop;
-  __istream.getline(line, MAX_SATELLIT_CHARS);
-  while (!satellite_matched && line_count<max_lines) {
-    // we are only interested in satellites of type: 'MW' everything else
-    // is desregarded and may cause a problem when resolving; e.g. SLR records
-    // have no SVN field
-    if (line[5]=='M' && line[6]=='W') {
-      csvn = static_cast<int>(std::strtol(line+28, &end, 10));
-      if (errno == ERANGE || end==line+28) {
-        errno = 0;
-        return 2;
+/// Get the frequency channel of every GLONASS slot at a given epoch, aka the
+/// slot to frequency channel map (e.g. to be resolved once per epoch and
+/// used for all satellites). GLONASS satellites are the ones with a (Bernese)
+/// PRN in the range [101, 199]; the slot is the PRN minus 100. If more than
+/// one SVN occupies a slot at the epoch, the first record (in file order) is
+/// chosen.
+/// @param[in]  eph      The time/epoch
+/// @param[out] channels The frequency channel of every occupied slot, sorted
+///                      on slot number (cleared at entry)
+/// @return     0 on success; 1 if memory could not be allocated (channels is
+///             then empty)
+int
+ngpt::BernSatellit::get_frequency_channels(
+  const ngpt::datetime<ngpt::seconds>& eph,
+  std::vector<GloFrequencyChannel>& channels) const noexcept
+{
+  channels.clear();
+  try {
+    std::vector<std::pair<std::size_t, GloFrequencyChannel>> tmp;
+    for (const auto& it : __svn_index) {
+      const SensorRecord* rec = find_record(it.first, eph);
+      if (rec && rec->prn > 100 && rec->prn < 200) {
+        tmp.push_back({rec->order,
+          GloFrequencyChannel{rec->prn-100, it.first, rec->ifrqn}});
       }
-      if (csvn==svn) {
-        start = ngpt::strptime_ymd_hms<ngpt::seconds>(line+41);
-        stop  = ngpt::datetime<ngpt::seconds>::max();
-        for (int i=62; i<82; i++) {
-          if (line[i] != ' ') {
-            stop = ngpt::strptime_ymd_hms<ngpt::seconds>(line+62);
-            break;
-          }
-        }
-        if (eph>=start && eph<stop) {
-          satellite_matched = true;
-          prn = static_cast<int>(std::strtol(line, &end, 10));
-          ifrqn = static_cast<int>(std::strtol(line+193, &end, 10));
-          if (errno == ERANGE) {
-            errno = 0;
-            // throw std::runtime_error("[ERROR] Failed to resolve svn from SATELLIT file");
-            return 3;
-          } else {
-            return 0;
-          }
-        }
+    }
+    std::sort(tmp.begin(), tmp.end(), [](const auto& a, const auto& b) {
+      return a.second.slot < b.second.slot
+        || (a.second.slot == b.second.slot && a.first < b.first);
+    });
+
+    for (const auto& t : tmp) {
+      if (channels.empty() || channels.back().slot != t.second.slot) {
+        channels.push_back(t.second);
       }
     }
-    __istream.getline(line, MAX_SATELLIT_CHARS);
-    ++line_count;
-    // check for end of records
-    if (std::strlen(line)<10 || !std::strncmp("PART 3", line, 6)) return -1;
+  } catch (std::exception&) {
+    channels.clear();
+    return 1;
   }
-
-  return (line_count>=max_lines)?(-1):5;
+  return 0;
 }
 
 /// This function should only be called once, inside the object's constructor.
 /// It will try to open the file, and validate that the file is actually a
 /// Bernese SATELLIT file via reading and checking the first line. After this,
-/// it will try to find the line: 'PART 2: ON-BOARD SENSORS' and mark where
-/// (inside the file) it is placed (aka store it in __part2).
-/// @return  Anything other than 0, denotes an error
+/// it will try to find the line: 'PART 2: ON-BOARD SENSORS' and parse all of
+/// its microwave ('MW') sensor records (other records, e.g. SLR, have no SVN
+/// field and are disregarded) into __svn_index, untill the end of the block.
+/// Every microwave record must hold a frequency channel (IFRQ).
+/// @return  Anything other than 0, denotes an error; 17 if a record has no
+///          frequency channel, 18 if memory could not be allocated
 int
 ngpt::BernSatellit::initialize() noexcept
 {
@@ -118,15 +145,12 @@ ngpt::BernSatellit::initialize() noexcept
   const int line2_sz = std::strlen(line2);
   char line[MAX_SATELLIT_CHARS];
 
-  // The stream should be open by now!
-  if (!__istream.is_open()) return 1;
-
-  // Go to the top of the file.
-  __istream.seekg(0);
+  std::ifstream fin (__filename.c_str(), std::ios_base::in);
+  if (!fin.is_open()) return 1;
   
   // Read the first line and verify
   // ----------------------------------------------------
-  __istream.getline(line, MAX_SATELLIT_CHARS);
+  fin.getline(line, MAX_SATELLIT_CHARS);
   if (std::strncmp(line1, line, line1_sz)) {
     std::cerr<<"\n[ERROR] Failed to verify first liine of SATELIT file";
     return 10;
@@ -136,29 +160,83 @@ ngpt::BernSatellit::initialize() noexcept
   // PART 2: ON-BOARD SENSORS
   int line_count = 0;
   while (std::strncmp(line2, line, line2_sz) && line_count<max_lines) {
-    __istream.getline(line, MAX_SATELLIT_CHARS);
+    fin.getline(line, MAX_SATELLIT_CHARS);
     ++line_count;
   }
   // verify that it is ineed the line we want (and the stream is ok)
-  if (!__istream.good() || line_count>=max_lines) return 11;
+  if (!fin.good() || line_count>=max_lines) return 11;
   // next line is just a series of  '-' chars
-  __istream.getline(line, MAX_SATELLIT_CHARS);
+  fin.getline(line, MAX_SATELLIT_CHARS);
   // next two lines are column descriptions (for the lines that follow)
-  __istream.getline(line, MAX_SATELLIT_CHARS);
+  fin.getline(line, MAX_SATELLIT_CHARS);
   const char *hln1 =
 "                                              START TIME           END TIME                 SENSOR OFFSETS (M)       SENSOR BORESIGHT VECTOR (U) SENSOR AZIMUTH VECTOR (N)";
   const int hln1_sz = std::strlen(hln1);
   if (std::strncmp(hln1, line, hln1_sz)) return 12;
-  __istream.getline(line, MAX_SATELLIT_CHARS);
+  fin.getline(line, MAX_SATELLIT_CHARS);
   const char *hln2 =
 "PRN  TYPE  SENSOR NAME______SVN  NUMBER  YYYY MM DD HH MM SS  YYYY MM DD HH MM SS         DX        DY        DZ         X       Y       Z          X       Y       Z      ANTEX SENSOR NAME___  IFRQ  SIGNAL LIST___________------>";
   const int hln2_sz = std::strlen(hln2);
   if (std::strncmp(hln2, line, hln2_sz)) return 13;
 
-  // Cool! we leave the stream here and mark this position; next line to be
-  // read is an empty line and then a record line
-  __istream.getline(line, MAX_SATELLIT_CHARS);
-  __part2 = __istream.tellg();
+  // Cool! next line to be read is an empty line and then the record lines
+  fin.getline(line, MAX_SATELLIT_CHARS);
+
+  // parse records untill the end of the block
+  std::size_t order = 0;
+  char* end;
+  ngpt::datetime<ngpt::seconds> start, stop;
+  __svn_index.clear();
+  while (fin.getline(line, MAX_SATELLIT_CHARS)
+         && std::strlen(line) >= 10 && std::strncmp("PART 3", line, 6)) {
+    // we are only interested in satellites of type: 'MW' everything else
+    // is desregarded and may cause a problem when resolving; e.g. SLR records
+    // have no SVN field
+    if (line[5]=='M' && line[6]=='W') {
+      errno = 0;
+      const int svn = static_cast<int>(std::strtol(line+28, &end, 10));
+      if (errno == ERANGE || end==line+28) return 14;
+      try {
+        start = ngpt::strptime_ymd_hms<ngpt::seconds>(line+41);
+        stop  = ngpt::datetime<ngpt::seconds>::max();
+        for (int i=62; i<82 && line[i]; i++) {
+          if (line[i] != ' ') {
+            stop = ngpt::strptime_ymd_hms<ngpt::seconds>(line+62);
+            break;
+          }
+        }
+      } catch (std::exception&) {
+        return 15;
+      }
+      const int prn = static_cast<int>(std::strtol(line, &end, 10));
+      if (errno == ERANGE) return 16;
+      // the frequency channel (IFRQ) must be recorded; there is no default
+      if (std::strlen(line) <= 193) return 17;
+      const int ifrqn = static_cast<int>(std::strtol(line+193, &end, 10));
+      if (errno == ERANGE || end==line+193) return 17;
+      try {
+        __svn_index[svn].push_back(SensorRecord{start, stop, stop, prn, ifrqn,
+          order});
+      } catch (std::exception&) {
+        __svn_index.clear();
+        return 18;
+      }
+    }
+    ++order;
+  }
+
+  // sort the records of every SVN on start time (ties in file order) and
+  // compute the running maximum of end times
+  for (auto& it : __svn_index) {
+    auto& v = it.second;
+    std::sort(v.begin(), v.end(),
+      [](const SensorRecord& a, const SensorRecord& b) {
+        return a.start < b.start || (a.start == b.start && a.order < b.order);
+      });
+    for (std::size_t i=1; i<v.size(); i++) {
+      v[i].max_stop = (v[i-1].max_stop < v[i].stop) ? v[i].stop : v[i-1].max_stop;
+    }
+  }
 
   // All done !
   return 0;
@@ -3,11 +3,23 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include "ggdatetime/dtcalendar.hpp"
 
 namespace ngpt
 {
 
+/// @brief Frequency channel of a GLONASS slot, as returned by bulk queries
+///        (see BernSatellit::get_frequency_channels).
+struct GloFrequencyChannel
+{
+  int slot;  ///< GLONASS slot (aka Bernese PRN minus 100)
+  int svn;   ///< SVN of the satellite occupying the slot
+  int ifrqn; ///< Frequency channel
+};
+
 /// @class BernSatellit
 /// This class enables the reading and extraction of GNSS satellite information,
 /// recorded in Bernese-specific files, named as 'SATELLIT.IXX'. For now, the
@@ -15,21 +27,20 @@ namespace ngpt
 /// correspondance of GLONASS svn numbers to frequency channels.
 /// An example of such a file, can be found at CODE's ftp repository, aka
 /// ftp://ftp.aiub.unibe.ch/BSWUSER52/GEN/SATELLIT.I14
+///
+/// At construction, the microwave ('MW') sensor records of 'PART 2' are
+/// parsed once into a table keyed on SVN; the validity intervals
+/// [start, stop) of every SVN are kept sorted, so that a query is a hash
+/// lookup plus a binary search. The file is not accessed after construction.
 class BernSatellit
 {
 public:
-  /// Let's not write this more than once.
-  typedef std::ifstream::pos_type pos_type;
-
   /// @brief Constructor from filename.
   explicit
   BernSatellit(const char*);
 
-  /// @brief Destructor (closing the file is not mandatory, but nevertheless)
-  ~BernSatellit() noexcept 
-  { 
-    if (__istream.is_open()) __istream.close();
-  }
+  /// @brief Destructor
+  ~BernSatellit() noexcept = default;
   
   /// @brief Copy not allowed !
   BernSatellit(const BernSatellit&) = delete;
@@ -38,27 +49,48 @@ public:
   BernSatellit& operator=(const BernSatellit&) = delete;
   
   /// @brief Move Constructor.
-  BernSatellit(BernSatellit&& a)
-  noexcept(std::is_nothrow_move_constructible<std::ifstream>::value) = default;
+  BernSatellit(BernSatellit&& a) = default;
 
   /// @brief Move assignment operator.
-  BernSatellit& operator=(BernSatellit&& a) 
-  noexcept(std::is_nothrow_move_assignable<std::ifstream>::value) = default;
+  BernSatellit& operator=(BernSatellit&& a) = default;
 
   /// @brief Get (GLONASS) satellite frequency channel, given svn
   int
   get_frequency_channel(int svn, const ngpt::datetime<ngpt::seconds>& eph,
-    int& ifrqn, int& prn);
+    int& ifrqn, int& prn) const noexcept;
+
+  /// @brief Get the frequency channel of every GLONASS slot at an epoch.
+  int
+  get_frequency_channels(const ngpt::datetime<ngpt::seconds>& eph,
+    std::vector<GloFrequencyChannel>& channels) const noexcept;
 
 private:
 
-  /// @brief Initialize the instance (open stream and validate format)
+  /// @brief A microwave sensor record of 'PART 2'.
+  struct SensorRecord
+  {
+    ngpt::datetime<ngpt::seconds> start;    ///< Start time
+    ngpt::datetime<ngpt::seconds> stop;     ///< End time (or max())
+    ngpt::datetime<ngpt::seconds> max_stop; ///< Max end time of this and all
+                                            ///< preceding records (of the SVN)
+    int                           prn;      ///< PRN as recorded
+    int                           ifrqn;    ///< Frequency channel
+    std::size_t                   order;    ///< Record number (file order)
+  };
+
+  /// @brief Initialize the instance (read file, validate format and parse
+  ///        'PART 2')
   int
   initialize() noexcept;
 
+  /// @brief Find the record of an SVN valid at an epoch.
+  const SensorRecord*
+  find_record(int svn, const ngpt::datetime<ngpt::seconds>& eph)
+  const noexcept;
+
   std::string    __filename;    ///< The name of the file.
-  std::ifstream  __istream;     ///< The infput (file) stream.
-  pos_type       __part2;       ///< Mark the 'PART 2: ON-BOARD SENSORS' field.
+  /// Microwave sensor records keyed on SVN; sorted on start time
+  std::unordered_map<int, std::vector<SensorRecord>> __svn_index;
 }; // BernSatellit 
 
 } // ngpt
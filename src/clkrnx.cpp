@@ -0,0 +1,512 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+#include "clkrnx.hpp"
+#include "rinex.hpp"
+
+using ngpt::ClockRnx;
+using ngpt::rinex::fixed_width_to_int;
+
+/// Max PRN (two-digit satellite numbers)
+constexpr int MAX_PRN { 100 };
+
+/// Number of satellite systems (SATELLITE_SYSTEM enumerators)
+constexpr int NUM_SYSTEMS { 8 };
+
+/// Chars of the record name in v2.00 and v3.00 files (A4)
+constexpr int NAME_CHARS { 4 };
+
+/// Chars of the epoch in a data record (I4,4(1X,I2.2),1X,F9.6)
+constexpr int EPOCH_CHARS { 26 };
+
+/// Microseconds per day
+constexpr long MICROSEC_PER_DAY { 86400L*1000000L };
+
+/// @class EpochResolver
+///
+/// Resolve the epoch of data records (as microseconds from the start of a
+/// reference day). Consecutive records of the same epoch are only resolved
+/// once (the epoch chars are compared to the ones of the last record) and
+/// the MJD of a date is only computed when the date changes.
+class EpochResolver
+{
+public:
+  /// @param[in]  str     Start of the epoch field (EPOCH_CHARS)
+  /// @param[in,out] ref_mjd Reference day; if LONG_MIN, it is set to the day
+  ///                     of this epoch
+  /// @param[out] t       Microseconds from the start of the reference day
+  /// @return  True if the epoch was resolved; false otherwise
+  bool
+  resolve(const char* str, long& ref_mjd, long& t) noexcept
+  {
+    if (__last && !std::memcmp(str, __last, EPOCH_CHARS)) {
+      t = __t + (__mjd-ref_mjd)*MICROSEC_PER_DAY;
+      return true;
+    }
+    int y, mo, d, h, mi;
+    double sec;
+    if (!fixed_width_to_int(str, 4, y)
+        || !fixed_width_to_int(str+5, 2, mo)
+        || !fixed_width_to_int(str+8, 2, d)
+        || !fixed_width_to_int(str+11, 2, h)
+        || !fixed_width_to_int(str+14, 2, mi)
+        || !ngpt::rinex::fixed_width_to_double(str+16, 10, sec)) {
+      return false;
+    }
+    if (y!=__y || mo!=__mo || d!=__d) {
+      try {
+        __mjd = ngpt::datetime<ngpt::seconds>(ngpt::year(y), ngpt::month(mo),
+          ngpt::day_of_month(d), ngpt::seconds(0)).mjd().as_underlying_type();
+      } catch (std::exception&) {
+        return false;
+      }
+      __y  = y;
+      __mo = mo;
+      __d  = d;
+    }
+    if (ref_mjd == std::numeric_limits<long>::min()) ref_mjd = __mjd;
+    __t = (h*3600L + mi*60L)*1000000L + std::lround(sec*1e6);
+    __last = str;
+    t = __t + (__mjd-ref_mjd)*MICROSEC_PER_DAY;
+    return true;
+  }
+
+private:
+  const char* __last {nullptr}; ///< Epoch chars of the last record
+  long        __t    {0};       ///< Microseconds of day of the last record
+  long        __mjd  {0};       ///< MJD of the last date
+  int         __y {0}, __mo {0}, __d {0}; ///< Last date
+};
+
+/// @details ClockRnx constructor, using a filename. The whole file is mapped
+///          in memory and the header is read; if load_all is set, all
+///          (satellite and, unless skipped, receiver) records are loaded.
+///          Else, nothing is loaded (see ClockRnx::load_window).
+/// @param[in] filename       The filename of the clock RINEX file
+/// @param[in] skip_receivers Skip AR (receiver) records
+/// @param[in] load_all       Load all records of the file
+/// @throw     std::runtime_error if the file cannot be mapped, the header
+///            cannot be resolved or the records cannot be loaded
+ClockRnx::ClockRnx(const char* filename, bool skip_receivers, bool load_all)
+  : __filename      (filename)
+  , __mmap          (filename)
+  , __data_start    (nullptr)
+  , __version       (0e0)
+  , __satsys        (SATELLITE_SYSTEM::mixed)
+  , __name_shift    (0)
+  , __skip_receivers(skip_receivers)
+  , __start         ()
+  , __interval      (0e0)
+  , __interval_us   (0)
+  , __num_epochs    (0)
+  , __epochs_mjd    (0)
+  , __sorted        (false)
+{
+  int j;
+  if ((j=read_header())) {
+    throw std::runtime_error("[ERROR] Failed to read (clock) RINEX header; Error Code: "+std::to_string(j));
+  }
+  if (load_all && (j=load())) {
+    throw std::runtime_error("[ERROR] Failed to read (clock) RINEX records; Error Code: "+std::to_string(j));
+  }
+}
+
+/// Read a RINEX clock header and assign vital information, aka the version,
+/// the satellite system and the time system. The function will read all
+/// header lines, stoping after the line: "END OF HEADER"
+/// @return  Anything other than 0 denotes an error.
+int
+ClockRnx::read_header() noexcept
+{
+  const char* cur = __mmap.begin();
+  const char* end = __mmap.end();
+  const char *bol, *eol;
+
+  // First line: version, file type and satellite system
+  if (!rinex::next_line(cur, end, bol, eol) || eol-bol < 41) return 10;
+  char buf[10];
+  std::memcpy(buf, bol, 9);
+  buf[9] = '\0';
+  char* str_end;
+  __version = std::strtof(buf, &str_end);
+  if (str_end == buf) return 10;
+  if (__version < 2e0 || __version >= 4e0) return 13;
+  if (bol[20] != 'C') return 11;
+  try {
+    __satsys = (bol[40]==' ')
+      ? SATELLITE_SYSTEM::mixed
+      : ngpt::char_to_satsys(bol[40]);
+  } catch (std::runtime_error&) {
+    return 12;
+  }
+  // v3.04 records have 9-char names (A9); earlier versions 4-char (A4)
+  __name_shift = (__version >= 3.035e0) ? 5 : 0;
+
+  // Keep on reading lines until 'END OF HEADER'
+  while (rinex::next_line(cur, end, bol, eol)) {
+    if (eol-bol < 61) continue;
+    if (!std::strncmp(bol+60, "END OF HEADER", 13)) {
+      __data_start = cur;
+      return 0;
+    }
+    if (!std::strncmp(bol+60, "TIME SYSTEM ID", 14)) {
+      __time_sys = std::string(bol+3, 3);
+      __time_sys.erase(__time_sys.find_last_not_of(' ')+1);
+    }
+  }
+  return 14;
+}
+
+/// @details Resolve all satellite (AS) and, unless skipped, receiver (AR)
+///          records from bgn to the end of the file, with epochs in [lo, hi].
+///          All other records (AC, AA, CR, DR, MS) are skipped. Resolved
+///          records are appended to the scratch buffer; new satellites or
+///          receivers are appended to the series.
+/// @param[in] bgn     First char of a record line
+/// @param[in,out] ref_mjd Reference day of lo/hi and of the resolved epochs;
+///                    if LONG_MIN, set to the day of the first record
+/// @param[in] lo      Min epoch, microseconds from the reference day
+/// @param[in] hi      Max epoch, microseconds from the reference day
+/// @param[in] stop_after_hi Stop at the first record after hi (only valid if
+///                    the file is sorted by epoch)
+/// @return  Anything other than 0 denotes an error:
+///          20: invalid satellite or receiver name, 21: invalid epoch,
+///          22: invalid number of values or value, 23: allocation failed
+int
+ClockRnx::scan(const char* bgn, long& ref_mjd, long lo, long hi,
+  bool stop_after_hi) noexcept
+{
+  const int o = __name_shift;
+  const int min_chars = 8+o+EPOCH_CHARS+3;
+  const char* cur = bgn;
+  const char* end = __mmap.end();
+  const char *bol, *eol;
+  EpochResolver epochs;
+
+  // series of every satellite (system*MAX_PRN+prn) and receiver
+  std::vector<int> sat_series (NUM_SYSTEMS*MAX_PRN, -1);
+  std::unordered_map<std::string, int> rec_series;
+  for (int i=0; i<num_series(); i++) {
+    if (__sats[i] >= 0) sat_series[__sats[i]] = i;
+    else rec_series[__names[i]] = i;
+  }
+
+  try {
+    while (rinex::next_line(cur, end, bol, eol)) {
+      if (eol>bol && eol[-1]=='\r') --eol;
+      if (eol-bol < min_chars || bol[0]!='A') continue;
+      const bool is_sat = (bol[1]=='S');
+      if (!is_sat && (bol[1]!='R' || __skip_receivers)) continue;
+
+      long t;
+      if (!epochs.resolve(bol+8+o, ref_mjd, t)) return 21;
+      if (t < lo) continue;
+      if (t > hi) {
+        if (stop_after_hi) break;
+        continue;
+      }
+
+      // series
+      int series;
+      if (is_sat) {
+        SATELLITE_SYSTEM s;
+        int prn;
+        try {
+          s = ngpt::char_to_satsys(bol[3]);
+        } catch (std::exception&) {
+          return 20;
+        }
+        if (!fixed_width_to_int(bol+4, 2, prn) || prn<1 || prn>=MAX_PRN) {
+          return 20;
+        }
+        const int key = static_cast<int>(s)*MAX_PRN + prn;
+        if ((series=sat_series[key]) < 0) {
+          series = sat_series[key] = num_series();
+          __names.emplace_back(bol+3, 3);
+          __sats.push_back(key);
+        }
+      } else {
+        std::string name (bol+3, NAME_CHARS+o);
+        name.erase(name.find_last_not_of(' ')+1);
+        auto it = rec_series.find(name);
+        if (it == rec_series.end()) {
+          series = rec_series[name] = num_series();
+          __names.push_back(name);
+          __sats.push_back(-1);
+        } else {
+          series = it->second;
+        }
+      }
+
+      // number of values and values; bias and (optionaly) sigma
+      int n;
+      if (!fixed_width_to_int(bol+8+o+EPOCH_CHARS, 3, n) || n<1) return 22;
+      const char* p = bol+8+o+EPOCH_CHARS+3;
+      double v[2] = {0e0, std::numeric_limits<double>::quiet_NaN()};
+      for (int i=0; i<std::min(n, 2); i++) {
+        while (p<eol && *p==' ') ++p;
+        const char* q = p;
+        while (q<eol && *q!=' ') ++q;
+        if (q==p || q-p>=64 || !rinex::fixed_width_to_double(p, q-p, v[i])) {
+          return 22;
+        }
+        p = q;
+      }
+      __records.push_back(Record{series, t, v[0], v[1]});
+    }
+  } catch (std::exception&) {
+    return 23;
+  }
+  return 0;
+}
+
+/// @details Place the records of the scratch buffer on the grid, i.e. set
+///          the first epoch, the interval (the greatest common divisor of
+///          all epochs, relative to the first one) and the number of epochs
+///          and fill the bias and sigma arrays. The scratch buffer is then
+///          cleared.
+/// @param[in] ref_mjd Reference day of the epochs of the records
+/// @return  0 on success; 24 if the grid would be too sparse (e.g. epochs
+///          not on a regular grid); 23 if allocation failed
+int
+ClockRnx::build_grid(long ref_mjd) noexcept
+{
+  __num_epochs = 0;
+  __interval_us = 0;
+  __interval = 0e0;
+  __bias.clear();
+  __sigma.clear();
+  if (__records.empty()) {
+    __start = ngpt::datetime<ngpt::microseconds>();
+    return 0;
+  }
+
+  long tmin = std::numeric_limits<long>::max();
+  long tmax = std::numeric_limits<long>::min();
+  for (const auto& r : __records) {
+    tmin = std::min(tmin, r.t);
+    tmax = std::max(tmax, r.t);
+  }
+  long step = 0;
+  for (const auto& r : __records) {
+    if (step != 1) step = std::gcd(step, r.t-tmin);
+  }
+  const long epochs = step ? (tmax-tmin)/step+1 : 1;
+  // every epoch of the grid (but gaps) holds at least one record
+  if (epochs > 4*static_cast<long>(__records.size())+1000) return 24;
+
+  __interval_us = step;
+  __interval = step*1e-6;
+  __num_epochs = static_cast<int>(epochs);
+  __start = ngpt::datetime<ngpt::microseconds>(
+    ngpt::modified_julian_day(ref_mjd), ngpt::microseconds(tmin));
+  try {
+    const std::size_t sz = static_cast<std::size_t>(num_series())*epochs;
+    __bias.assign(sz, std::numeric_limits<double>::quiet_NaN());
+    __sigma.assign(sz, std::numeric_limits<double>::quiet_NaN());
+  } catch (std::exception&) {
+    return 23;
+  }
+  for (const auto& r : __records) {
+    const std::size_t k = static_cast<std::size_t>(r.series)*epochs
+      + (step ? (r.t-tmin)/step : 0);
+    __bias[k] = r.bias;
+    __sigma[k] = r.sigma;
+  }
+  __records.clear();
+  return 0;
+}
+
+/// @details Load all records of the file (see ClockRnx::scan); any records
+///          previously loaded are discarded.
+/// @return  Anything other than 0 denotes an error (see ClockRnx::scan and
+///          ClockRnx::build_grid)
+int
+ClockRnx::load() noexcept
+{
+  __names.clear();
+  __sats.clear();
+  __records.clear();
+  long ref_mjd = std::numeric_limits<long>::min();
+  int status;
+  if ((status=scan(__data_start, ref_mjd, std::numeric_limits<long>::min(),
+      std::numeric_limits<long>::max(), false))) {
+    __records.clear();
+    return status;
+  }
+  return build_grid(ref_mjd);
+}
+
+/// @details Build an index of the epochs in the file, aka the position of
+///          the first record of every epoch (consecutive records of the same
+///          epoch are grouped). If the epochs are non-decreasing, the file is
+///          marked as sorted.
+/// @return  0 on success; 21 if an epoch is invalid; 23 if allocation failed
+int
+ClockRnx::index_epochs() noexcept
+{
+  const int o = __name_shift;
+  const char* cur = __data_start;
+  const char* end = __mmap.end();
+  const char *bol, *eol;
+  EpochResolver epochs;
+  const char* last = nullptr;
+  long ref_mjd = std::numeric_limits<long>::min();
+
+  __epochs.clear();
+  __sorted = true;
+  try {
+    while (rinex::next_line(cur, end, bol, eol)) {
+      if (eol-bol < 8+o+EPOCH_CHARS || bol[0]!='A'
+          || (bol[1]!='S' && bol[1]!='R')) {
+        continue;
+      }
+      if (last && !std::memcmp(last, bol+8+o, EPOCH_CHARS)) continue;
+      long t;
+      if (!epochs.resolve(bol+8+o, ref_mjd, t)) return 21;
+      if (!__epochs.empty() && t < __epochs.back().t) __sorted = false;
+      __epochs.push_back(EpochMark{bol, t});
+      last = bol+8+o;
+    }
+  } catch (std::exception&) {
+    __epochs.clear();
+    return 23;
+  }
+  __epochs_mjd = ref_mjd;
+  return 0;
+}
+
+/// @details Load only the records with epochs in [from, to]; any records
+///          previously loaded are discarded. The first call builds an index
+///          of the epochs in the file (see ClockRnx::index_epochs); if the
+///          file is sorted by epoch (the usual case), the records of the
+///          window are found via the index and only they are resolved, so
+///          that consecutive windows of a (large) file are loaded in time
+///          proportional to the size of the window.
+/// @return  Anything other than 0 denotes an error (see ClockRnx::scan and
+///          ClockRnx::build_grid)
+int
+ClockRnx::load_window(const ngpt::datetime<ngpt::seconds>& from,
+  const ngpt::datetime<ngpt::seconds>& to) noexcept
+{
+  int status;
+  if (__epochs.empty() && (status=index_epochs())) return status;
+
+  __names.clear();
+  __sats.clear();
+  __records.clear();
+  long ref_mjd = __epochs_mjd;
+  if (__epochs.empty()) return build_grid(ref_mjd);
+  const long lo = (from.mjd().as_underlying_type()-ref_mjd)*MICROSEC_PER_DAY
+    + from.sec().as_underlying_type()*1000000L;
+  const long hi = (to.mjd().as_underlying_type()-ref_mjd)*MICROSEC_PER_DAY
+    + to.sec().as_underlying_type()*1000000L;
+
+  const char* bgn = __data_start;
+  if (__sorted) {
+    auto it = std::lower_bound(__epochs.begin(), __epochs.end(), lo,
+      [](const EpochMark& e, long t){return e.t < t;});
+    if (it == __epochs.end()) return build_grid(ref_mjd);
+    bgn = it->pos;
+  }
+  if ((status=scan(bgn, ref_mjd, lo, hi, __sorted))) {
+    __records.clear();
+    return status;
+  }
+  return build_grid(ref_mjd);
+}
+
+/// @details Find the index of a satellite series.
+/// @return  The index (in [0, num_series())) or -1 if not loaded
+int
+ClockRnx::sat_index(SATELLITE_SYSTEM s, int prn) const noexcept
+{
+  const int key = static_cast<int>(s)*MAX_PRN + prn;
+  for (int i=0; i<num_series(); i++) if (__sats[i]==key) return i;
+  return -1;
+}
+
+/// @details Find the index of a receiver series.
+/// @return  The index (in [0, num_series())) or -1 if not loaded
+int
+ClockRnx::receiver_index(const char* name) const noexcept
+{
+  for (int i=0; i<num_series(); i++) {
+    if (__sats[i]<0 && __names[i]==name) return i;
+  }
+  return -1;
+}
+
+/// @details Interpolate the clock bias of a series. The epochs of the grid
+///          to interpolate from are found by index (no searching); order 1 is
+///          linear interpolation between the two epochs enclosing t, higher
+///          orders use order+1 epochs centered at t (see
+///          ngpt::lagrange_coefficients).
+/// @param[in]  series The series (see ClockRnx::sat_index)
+/// @param[in]  t      Seconds since the first epoch of the grid (see
+///                    ClockRnx::seconds_since_start)
+/// @param[out] bias   The interpolated bias (sec)
+/// @param[in]  order  Interpolation order (in [1, lagrange_max_order])
+/// @return  0 on success; 1 if t is outside the grid; 2 if the order is
+///          invalid or the grid holds too few epochs; 3 if the series is
+///          invalid; 4 if a bias needed is missing (bias is NaN)
+int
+ClockRnx::interpolate(int series, double t, double& bias, int order)
+const noexcept
+{
+  if (series < 0 || series >= num_series()) return 3;
+  if (__num_epochs < 1) return 1;
+  if (__num_epochs == 1) {
+    if (t != 0e0) return 1;
+    bias = biases(series)[0];
+    return std::isnan(bias) ? 4 : 0;
+  }
+  double c[lagrange_max_order+1];
+  int first, nodes, status;
+  if ((status=lagrange_coefficients(t/__interval, __num_epochs, order, first,
+      nodes, c))) {
+    return status;
+  }
+  const double* b = biases(series) + first;
+  bias = 0e0;
+  for (int j=0; j<nodes; j++) bias += c[j]*b[j];
+  return std::isnan(bias) ? 4 : 0;
+}
+
+/// @details Interpolate the clock biases of all series at an epoch (see
+///          ClockRnx::interpolate(int, double, double&, int)); biases that
+///          cannot be interpolated (missing values) are NaN.
+/// @param[in]  t      Seconds since the first epoch of the grid
+/// @param[out] out    Array of (at least) num_series() elements; the
+///                    bias of every series
+/// @param[in]  order  Interpolation order (in [1, lagrange_max_order])
+/// @return  0 on success; 1 if t is outside the grid; 2 if the order is
+///          invalid or the grid holds too few epochs
+int
+ClockRnx::interpolate(double t, double* out, int order) const noexcept
+{
+  double c[lagrange_max_order+1];
+  int first, nodes, status;
+  if (__num_epochs < 1) return 1;
+  if (__num_epochs == 1) {
+    if (t != 0e0) return 1;
+    first = 0;
+    nodes = 1;
+    c[0]  = 1e0;
+  } else if ((status=lagrange_coefficients(t/__interval, __num_epochs, order,
+      first, nodes, c))) {
+    return status;
+  }
+  for (int i=0; i<num_series(); i++) {
+    const double* b = biases(i) + first;
+    double v = 0e0;
+    for (int j=0; j<nodes; j++) v += c[j]*b[j];
+    out[i] = v;
+  }
+  return 0;
+}
@@ -0,0 +1,214 @@
+#ifndef __CLOCK_RINEX_HPP__
+#define __CLOCK_RINEX_HPP__
+
+/// @file      clkrnx.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Reader and interpolator for RINEX clock files.
+///
+/// @details   A ClockRnx maps a RINEX clock file (v2.00, v3.0x) in memory and
+///            resolves its satellite (AS) and, optionally, receiver (AR) clock
+///            records. The clock biases (and sigmas) of every satellite (or
+///            receiver) are stored in a contiguous, time-sorted array, one
+///            element per epoch of the (equally spaced) grid of the file;
+///            hence interpolation at any epoch only needs an index
+///            computation (no searching). Either the whole file or only a
+///            time window of it can be loaded; in the latter case, windows
+///            of a (time-sorted) file are found via an index of the epochs
+///            in the file.
+///
+/// @see       RINEX clock v3.04, ftp://igs.org/pub/data/format/rinex_clock304.txt
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <string>
+#include <vector>
+#include "ggdatetime/dtcalendar.hpp"
+#include "satsys.hpp"
+#include "lagrange.hpp"
+#include "mmap_file.hpp"
+
+namespace ngpt
+{
+
+/// @class ClockRnx
+///
+/// A RINEX clock file. Every satellite (or receiver) of the loaded records is
+/// a "series", holding a bias (sec) and a sigma (sec) value for every epoch
+/// of the grid; the grid starts at the first epoch loaded and its interval
+/// is the largest one that fits all epochs loaded (e.g. 30 or 5 sec).
+/// Missing values are NaN.
+class ClockRnx
+{
+public:
+  /// @brief Constructor from filename
+  explicit
+  ClockRnx(const char*, bool skip_receivers=true, bool load_all=true);
+
+  /// @brief Copy not allowed !
+  ClockRnx(const ClockRnx&) = delete;
+
+  /// @brief Assignment not allowed !
+  ClockRnx& operator=(const ClockRnx&) = delete;
+
+  /// @brief Move Constructor.
+  ClockRnx(ClockRnx&&) noexcept = default;
+
+  /// @brief Move assignment operator.
+  ClockRnx& operator=(ClockRnx&&) noexcept = default;
+
+  /// @brief Load all records of the file
+  int
+  load() noexcept;
+
+  /// @brief Load only the records within a time window
+  int
+  load_window(const ngpt::datetime<ngpt::seconds>& from,
+    const ngpt::datetime<ngpt::seconds>& to) noexcept;
+
+  /// @brief Rinex version (e.g. 3.00)
+  float
+  version() const noexcept
+  {return __version;}
+
+  /// @brief Satellite system of the file
+  SATELLITE_SYSTEM
+  satsys() const noexcept
+  {return __satsys;}
+
+  /// @brief Time system (e.g. "GPS"; empty if not in the header)
+  const std::string&
+  time_system() const noexcept
+  {return __time_sys;}
+
+  /// @brief First epoch of the grid (aka of the records loaded)
+  ngpt::datetime<ngpt::microseconds>
+  start_epoch() const noexcept
+  {return __start;}
+
+  /// @brief Grid interval in seconds (0 if only one epoch is loaded)
+  double
+  interval() const noexcept
+  {return __interval;}
+
+  /// @brief Number of epochs of the grid
+  int
+  num_epochs() const noexcept
+  {return __num_epochs;}
+
+  /// @brief Number of series (satellites and receivers)
+  int
+  num_series() const noexcept
+  {return static_cast<int>(__names.size());}
+
+  /// @brief Name of a series (e.g. "G01" or "NTUA")
+  const std::string&
+  name(int series) const noexcept
+  {return __names[series];}
+
+  /// @brief Index of a satellite series (-1 if not loaded)
+  int
+  sat_index(SATELLITE_SYSTEM s, int prn) const noexcept;
+
+  /// @brief Index of a receiver series (-1 if not loaded)
+  int
+  receiver_index(const char* name) const noexcept;
+
+  /// @brief Biases (sec) of a series, for all epochs of the grid
+  const double*
+  biases(int series) const noexcept
+  {return __bias.data() + static_cast<std::size_t>(series)*__num_epochs;}
+
+  /// @brief Sigmas (sec) of a series, for all epochs of the grid
+  const double*
+  sigmas(int series) const noexcept
+  {return __sigma.data() + static_cast<std::size_t>(series)*__num_epochs;}
+
+  /// @brief Seconds from the first epoch of the grid to t
+  template<typename T>
+    double
+    seconds_since_start(const ngpt::datetime<T>& t) const noexcept
+  {
+    return -ngpt::delta_sec<ngpt::microseconds, T>(__start, t)
+      .to_fractional_seconds();
+  }
+
+  /// @brief Interpolate the bias of a series
+  int
+  interpolate(int series, double t, double& bias, int order=1) const noexcept;
+
+  /// @brief Interpolate the biases of all series
+  int
+  interpolate(double t, double* out, int order=1) const noexcept;
+
+private:
+  /// A record (bias and sigma) as resolved, before placed on the grid
+  struct Record
+  {
+    int    series;
+    long   t;      ///< microseconds from the reference epoch
+    double bias;
+    double sigma;
+  };
+
+  /// An epoch of the file and the position of its first record
+  struct EpochMark
+  {
+    const char* pos;
+    long        t; ///< microseconds from the reference epoch
+  };
+
+  /// @brief Read the header and assign info
+  int
+  read_header() noexcept;
+
+  /// @brief Resolve the records from bgn to the end of the file, within
+  ///        [lo, hi]
+  int
+  scan(const char* bgn, long& ref_mjd, long lo, long hi, bool stop_after_hi)
+  noexcept;
+
+  /// @brief Place the records of a scan on the grid
+  int
+  build_grid(long ref_mjd) noexcept;
+
+  /// @brief Build the (time-sorted) index of the epochs in the file
+  int
+  index_epochs() noexcept;
+
+  std::string            __filename;    ///< The name of the file
+  MappedFile             __mmap;        ///< The file mapped in memory
+  const char*            __data_start;  ///< First char after the header
+  float                  __version;     ///< Rinex version (e.g. 3.00)
+  SATELLITE_SYSTEM       __satsys;      ///< Satellite system
+  std::string            __time_sys;    ///< Time system
+  int                    __name_shift;  ///< Extra chars of record names
+                                        ///< (5 for v3.04, else 0)
+  bool                   __skip_receivers; ///< Skip AR records
+  ngpt::datetime<ngpt::microseconds> __start; ///< First epoch of the grid
+  double                 __interval;    ///< Grid interval (sec)
+  long                   __interval_us; ///< Grid interval (microsec)
+  int                    __num_epochs;  ///< Epochs of the grid
+  std::vector<std::string> __names;     ///< Names of the series
+  std::vector<int>       __sats;        ///< Satellite of every series, as
+                                        ///< system*100+PRN (-1 for receivers)
+  std::vector<double>    __bias;        ///< [series][epoch] biases
+  std::vector<double>    __sigma;       ///< [series][epoch] sigmas
+  std::vector<Record>    __records;     ///< Scratch buffer of a load
+  std::vector<EpochMark> __epochs;      ///< Index of epochs (for windows)
+  long                   __epochs_mjd;  ///< Reference day of the index
+  bool                   __sorted;      ///< The file is sorted by epoch
+}; // ClockRnx
+
+} // ngpt
+
+#endif
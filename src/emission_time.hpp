@@ -0,0 +1,216 @@
+#ifndef __GNSS_EMISSION_TIME_HPP__
+#define __GNSS_EMISSION_TIME_HPP__
+
+/// @file      emission_time.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Satellite states at signal emission time (light-time and
+///            Sagnac corrections), for a receiver and a set of satellites.
+///
+/// @details   The light time tau of a signal received at t (by a receiver at
+///            r) solves c*tau = |R3(wE*tau) * x(t-tau) - r|, where x is the
+///            satellite position in the ECEF frame (at emission) and R3 the
+///            rotation of the earth during the signal's flight (Sagnac
+///            effect). Instead of re-evaluating the orbit at every iteration,
+///            the orbit is evaluated once, at t-tau0 (tau0 a guess of tau),
+///            and tau is solved (Newton) on x(t-tau) = x0 + v0*(tau0-tau),
+///            using the velocity v0 that (prepared) broadcast and SP3
+///            evaluators return with the position. The error of the
+///            linearization is a*(tau-tau0)^2/2, i.e. below 1 mm for MEO
+///            satellites and the nominal guess (and negligible for a guess
+///            from the previous epoch); when needed, the orbit can be
+///            evaluated once more, at the solved emission time.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <cmath>
+#include <vector>
+#include "satsys.hpp"
+#include "prepared_ephemeris.hpp"
+#include "sp3.hpp"
+
+namespace ngpt
+{
+
+/// Light time (sec) used as initial guess, when none is given; about the
+/// mean light time of MEO satellites
+constexpr double nominal_light_time { 0.075e0 };
+
+/// Earth rotation rate (rad/sec) used for the Sagnac correction (WGS84)
+constexpr double sagnac_earth_rotation { 7.2921151467e-5 };
+
+/// @brief The state of a satellite at signal emission time
+struct EmissionState
+{
+  double state[6]; ///< Position (m) and velocity (m/sec) at emission, in the
+                   ///< ECEF frame at reception time
+  double dtsv;     ///< SV clock correction at emission (sec)
+  double tau;      ///< Light time (sec); at input, if > 0, the initial guess
+  double tau0;     ///< Light time (sec) the orbit was (last) evaluated at
+  double range;    ///< Geometric range (m), aka c*tau
+  int    status;   ///< 0 if solved; else the status of the orbit evaluation
+};
+
+/// @brief Solve for the light time and emission state of a set of
+///        satellites, given a receiver position.
+///
+/// The orbits are evaluated via source(i, tau, state, dtsv), which must
+/// compute the position and velocity (state, ECEF at emission, m and m/sec)
+/// and clock correction (dtsv, sec) of the i-th satellite at tau seconds
+/// before reception, returning 0 on success (anything > 0 denotes an error;
+/// < 0 a warning, the results are used). Each pass first evaluates all
+/// satellites and then solves tau for all of them (Newton iterations, on the
+/// linearized orbit). The results are rotated to the ECEF frame at reception
+/// (position and velocity). The clock correction is the one at the last
+/// evaluation (its drift over tau-tau0 is below 1e-12 sec). No memory is
+/// allocated; the evaluation epoch of each satellite is kept in its
+/// EmissionState.
+///
+/// @param[in]     rx          Receiver position (ECEF, m)
+/// @param[in]     num_sats    Number of satellites
+/// @param[in]     source      Orbit evaluator, as described above
+/// @param[in,out] sats        Array of num_sats elements; at input, tau (if
+///                            > 0) is the initial guess of the light time
+///                            (e.g. the solution of the previous epoch),
+///                            else nominal_light_time is used
+/// @param[in]     evaluations Number of orbit evaluations (passes); 1 is
+///                            enough for sub-millimeter (MEO) accuracy, 2
+///                            makes the linearization error negligible
+/// @return Number of satellites that could not be solved (status > 0)
+template<typename F>
+  int
+  solve_emission_time(const double* rx, int num_sats, F&& source,
+    EmissionState* sats, int evaluations=1) noexcept
+{
+  constexpr double c  { speed_of_light };
+  constexpr double we { sagnac_earth_rotation };
+  constexpr double LIMIT { 1e-14 };
+  if (evaluations < 1) evaluations = 1;
+  int failed = 0;
+
+  for (int e=0; e<evaluations; e++) {
+    // orbits of all satellites at the current light time
+    for (int i=0; i<num_sats; i++) {
+      EmissionState& s = sats[i];
+      s.tau0   = (s.tau > 0e0) ? s.tau : nominal_light_time;
+      s.status = source(i, s.tau0, s.state, s.dtsv);
+    }
+
+    // light time, on the linearized orbit
+    for (int i=0; i<num_sats; i++) {
+      EmissionState& s = sats[i];
+      if (s.status > 0) continue;
+      const double* x = s.state;
+      const double* v = s.state+3;
+      double tau = s.tau0, dt = 1e0, rho = 0e0;
+      for (int k=0; k<10 && std::abs(dt)>LIMIT; k++) {
+        const double d  = s.tau0 - tau;
+        const double px = x[0] + v[0]*d;
+        const double py = x[1] + v[1]*d;
+        const double pz = x[2] + v[2]*d;
+        const double ct = std::cos(we*tau), st = std::sin(we*tau);
+        const double rx0 = ct*px + st*py;
+        const double ry0 = ct*py - st*px;
+        const double dx = rx0 - rx[0], dy = ry0 - rx[1], dz = pz - rx[2];
+        rho = std::sqrt(dx*dx + dy*dy + dz*dz);
+        // d(rho vector)/d(tau): -R3*v + we*(y', -x', 0)
+        const double ddx = -(ct*v[0] + st*v[1]) + we*ry0;
+        const double ddy = -(ct*v[1] - st*v[0]) - we*rx0;
+        const double ddz = -v[2];
+        const double f   = c*tau - rho;
+        const double df  = c - (dx*ddx + dy*ddy + dz*ddz)/rho;
+        dt   = f/df;
+        tau -= dt;
+      }
+      s.tau   = tau;
+      s.range = c*tau;
+    }
+  }
+
+  // states at emission, rotated to the ECEF frame at reception
+  for (int i=0; i<num_sats; i++) {
+    EmissionState& s = sats[i];
+    if (s.status > 0) {
+      ++failed;
+      continue;
+    }
+    const double d  = s.tau0 - s.tau;
+    const double ct = std::cos(we*s.tau), st = std::sin(we*s.tau);
+    const double px = s.state[0] + s.state[3]*d;
+    const double py = s.state[1] + s.state[4]*d;
+    const double vx = s.state[3], vy = s.state[4];
+    s.state[0] = ct*px + st*py;
+    s.state[1] = ct*py - st*px;
+    s.state[2] += s.state[5]*d;
+    s.state[3] = ct*vx + st*vy;
+    s.state[4] = ct*vy - st*vx;
+  }
+  return failed;
+}
+
+/// @brief Emission states of satellites with (prepared) broadcast orbits.
+///
+/// @param[in]     rx          Receiver position (ECEF, m)
+/// @param[in]     t           Reception epoch (GPS time)
+/// @param[in]     eph         The prepared ephemeris of each satellite
+/// @param[in,out] sats        Array of eph.size() elements (see
+///                            solve_emission_time)
+/// @param[in]     evaluations Number of orbit evaluations
+/// @return Number of satellites that could not be solved
+/// @see solve_emission_time
+template<SATELLITE_SYSTEM S, typename T>
+  int
+  solve_emission_time(const double* rx, const ngpt::datetime<T>& t,
+    const std::vector<PreparedEphemeris<S>>& eph, EmissionState* sats,
+    int evaluations=1) noexcept
+{
+  // reception epoch in the time frame of each ephemeris (computed per
+  // evaluation, so that no array of epochs is needed)
+  return solve_emission_time(rx, static_cast<int>(eph.size()),
+    [&](int i, double tau, double* state, double& dtsv) {
+      return eph[i].state_and_clock(eph[i].epoch(t)-tau, state, dtsv);
+    }, sats, evaluations);
+}
+
+/// @brief Emission states of satellites with precise (SP3) orbits.
+///
+/// Note that SP3 clock corrections do not include the relativistic
+/// correction.
+///
+/// @param[in]     rx          Receiver position (ECEF, m)
+/// @param[in]     t           Reception epoch (in the time system of the file)
+/// @param[in]     sp3         The SP3 orbits
+/// @param[in]     idx         Array of num_sats satellite indexes (see
+///                            Sp3::sat_index)
+/// @param[in]     num_sats    Number of satellites
+/// @param[in,out] sats        Array of num_sats elements (see
+///                            solve_emission_time)
+/// @param[in]     evaluations Number of orbit evaluations
+/// @param[in]     order       Interpolation order
+/// @return Number of satellites that could not be solved
+/// @see solve_emission_time
+template<typename T>
+  int
+  solve_emission_time(const double* rx, const ngpt::datetime<T>& t,
+    const Sp3& sp3, const int* idx, int num_sats, EmissionState* sats,
+    int evaluations=1, int order=9) noexcept
+{
+  const double trx = sp3.seconds_since_start(t);
+  return solve_emission_time(rx, num_sats,
+    [&](int i, double tau, double* state, double& dtsv) {
+      return sp3.state_and_clock(idx[i], trx-tau, state, dtsv, order);
+    }, sats, evaluations);
+}
+
+} // ngpt
+
+#endif
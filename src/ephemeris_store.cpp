@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "ephemeris_store.hpp"
+
+using ngpt::EphemerisStore;
+using ngpt::NavDataFrame;
+
+namespace
+{
+/// Number of satellite systems that can have navigation frames (i.e. all
+/// but SATELLITE_SYSTEM::mixed)
+constexpr int num_systems { 7 };
+
+/// Default max age (in seconds) of frames per satellite system, in the order
+/// of ngpt::SATELLITE_SYSTEM. GPS frames with a fit interval use half of it
+/// instead.
+constexpr long default_max_age[] = {
+  7200L,   // gps; half of the (default) 4 hour fit interval
+  900L,    // glonass; frames are broadcast every 30 min
+  360L,    // sbas
+  14400L,  // galileo
+  21600L,  // beidou
+  7200L,   // qzss
+  7200L    // irnss
+};
+
+/// Index of the health flag in NavDataFrame::data__ per satellite system
+constexpr int health_index[] = {
+  24,  // gps
+  6,   // glonass
+  6,   // sbas
+  24,  // galileo
+  24,  // beidou
+  24,  // qzss
+  24   // irnss
+};
+
+/// @brief Slot of a satellite in the index, or -1 if the satellite cannot be
+///        stored (unknown system, PRN out of range).
+inline int
+__slot__(ngpt::SATELLITE_SYSTEM sys, int prn) noexcept
+{
+  const int s = static_cast<int>(sys);
+  if (s<0 || s>=num_systems || prn<1 || prn>=EphemerisStore::max_prn) {
+    return -1;
+  }
+  return s*EphemerisStore::max_prn + prn;
+}
+
+/// @brief An epoch as integer seconds since MJD 0.
+inline long
+__epoch_key__(const ngpt::datetime<ngpt::seconds>& t) noexcept
+{
+  return t.mjd().as_underlying_type()*86400L + t.sec().as_underlying_type();
+}
+
+/// @brief Check if a frame is flagged as healthy.
+inline bool
+__is_healthy__(const NavDataFrame& frame) noexcept
+{
+  return frame.data(health_index[static_cast<int>(frame.sys())]) == 0e0;
+}
+}// anonymous namespace
+
+/// @details Null constructor; the store holds no frames and the max ages are
+///          set to their defaults.
+EphemerisStore::EphemerisStore()
+  : __index(num_systems*max_prn+1, 0)
+  , __max_span(0)
+{
+  std::copy(default_max_age, default_max_age+num_systems, __max_age);
+}
+
+/// @details Read all data blocks of the navigation RINEX instance (see
+///          NavigationRnx::read_all_records) and build the index.
+/// @param[in] nav         The navigation RINEX instance
+/// @param[in] num_threads Number of threads to use when reading (see
+///                        NavigationRnx::read_all_records)
+/// @throw std::runtime_error if any of the data blocks fails to resolve
+EphemerisStore::EphemerisStore(NavigationRnx& nav, int num_threads)
+  : EphemerisStore()
+{
+  int status;
+  if ((status = append(nav, num_threads))) {
+    throw std::runtime_error("[ERROR] EphemerisStore::EphemerisStore Failed to read navigation frames; Error Code: "+std::to_string(status));
+  }
+}
+
+/// @details Defined here (and not in the header), so that it is not inlined
+///          in every translation unit using the store.
+EphemerisStore::~EphemerisStore() noexcept = default;
+
+/// @details Read all data blocks of the navigation RINEX instance and add
+///          them to the store. Frames for satellites already in the store
+///          are merged with the existing ones; if a frame with the same
+///          satellite and ToC already exists, the new one is ignored.
+///          Frames of satellites the store cannot hold (PRN >= max_prn) are
+///          ignored.
+/// @param[in] nav         The navigation RINEX instance
+/// @param[in] num_threads Number of threads to use when reading (see
+///                        NavigationRnx::read_all_records)
+/// @return    0 on success; else the error code returned by
+///            NavigationRnx::read_all_records; 10 if memory could not be
+///            allocated. On error, the store is not changed.
+int
+EphemerisStore::append(NavigationRnx& nav, int num_threads) noexcept
+{
+  std::vector<NavDataFrame> frames;
+  int status = nav.read_all_records(frames, num_threads);
+  if (status) return status;
+
+  try {
+    if (!__frames.empty()) {
+      frames.insert(frames.begin(), __frames.begin(), __frames.end());
+    }
+    __build_index__(std::move(frames));
+  } catch (std::exception&) {
+    return 10;
+  }
+  return 0;
+}
+
+/// @details Sort the frames per slot and ToC, remove duplicates and assign
+///          the index, the ToC and max age arrays.
+///          The new arrays are built aside and swapped in at the end, so
+///          that the store is not changed if an allocation fails.
+/// @param[in] frames All frames to be stored; existing frames (if any) must
+///                   be placed first, so that they take precedence over
+///                   new frames with the same satellite and ToC.
+/// @throw     std::bad_alloc if memory cannot be allocated
+void
+EphemerisStore::__build_index__(std::vector<NavDataFrame>&& frames)
+{
+  // sort (indexes to) frames per slot and ToC; keep file order for equal keys
+  std::vector<int>  slots (frames.size());
+  std::vector<long> keys (frames.size());
+  std::vector<std::size_t> order;
+  order.reserve(frames.size());
+  for (std::size_t i=0; i<frames.size(); i++) {
+    slots[i] = __slot__(frames[i].sys(), frames[i].prn());
+    keys[i]  = __epoch_key__(frames[i].toc());
+    if (slots[i]>=0) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(),
+    [&](std::size_t a, std::size_t b) {
+      return slots[a]<slots[b] || (slots[a]==slots[b] && keys[a]<keys[b]);
+  });
+  auto last = std::unique(order.begin(), order.end(),
+    [&](std::size_t a, std::size_t b) {
+      return slots[a]==slots[b] && keys[a]==keys[b];
+  });
+  order.erase(last, order.end());
+
+  // assign frames, ToCs and ages; count frames per slot
+  std::vector<NavDataFrame> sorted;
+  sorted.reserve(order.size());
+  std::vector<long> tocs (order.size());
+  std::vector<long> ages (order.size());
+  std::vector<std::size_t> index (__index.size(), 0);
+  long max_span = 0;
+  for (std::size_t i=0; i<order.size(); i++) {
+    sorted.push_back(frames[order[i]]);
+    tocs[i] = keys[order[i]];
+    ages[i] = max_age(sorted[i]);
+    if (ages[i]>max_span) max_span = ages[i];
+    ++index[slots[order[i]]+1];
+  }
+  std::partial_sum(index.begin(), index.end(), index.begin());
+
+  __frames.swap(sorted);
+  __tocs.swap(tocs);
+  __ages.swap(ages);
+  __index.swap(index);
+  __max_span = max_span;
+}
+
+/// @details Set the max age for all frames of a given satellite system. A
+///          frame of this system is only considered valid at epoch t, if
+///          |t - ToC| <= sec. For GPS, this value is only used for frames
+///          that do not record a fit interval.
+/// @param[in] sys The satellite system
+/// @param[in] sec The max age in seconds
+void
+EphemerisStore::set_max_age(SATELLITE_SYSTEM sys, long sec) noexcept
+{
+  const int s = static_cast<int>(sys);
+  if (s<0 || s>=num_systems) return;
+  __max_age[s] = sec;
+  __max_span = 0;
+  for (std::size_t i=0; i<__frames.size(); i++) {
+    __ages[i] = max_age(__frames[i]);
+    if (__ages[i]>__max_span) __max_span = __ages[i];
+  }
+}
+
+/// @details The max age of a frame, i.e. the half-width of the interval
+///          (centered at ToC) for which the frame is valid. For GPS frames
+///          that record a fit interval (in hours), this is half the fit
+///          interval; else it is the max age set for the satellite system.
+/// @param[in] frame A navigation data frame
+/// @return    The max age of the frame in seconds
+long
+EphemerisStore::max_age(const NavDataFrame& frame) const noexcept
+{
+  if (frame.sys() == SATELLITE_SYSTEM::gps && frame.data(28) > 0e0) {
+    return static_cast<long>(frame.data(28)*3600e0) / 2L;
+  }
+  return __max_age[static_cast<int>(frame.sys())];
+}
+
+/// @details Find the frame to use for a satellite at a given epoch. This is
+///          the frame with the ToC closest to t, that is valid at t (see
+///          EphemerisStore::max_age) and (optionally) healthy. The search is
+///          a binary search in the frames of the satellite, followed by a
+///          walk towards both directions, stopping as soon as frames are too
+///          far away from t to be valid.
+/// @param[in] sys          The satellite system
+/// @param[in] prn          The satellite PRN
+/// @param[in] t            The epoch (in the time scale of the satellite
+///                         system's ToC)
+/// @param[in] check_health If true, frames not marked as healthy are
+///                         skipped
+/// @return    A pointer to the frame to use, or nullptr if no valid frame
+///            exists. The pointer is valid for as long as the store is not
+///            altered.
+const NavDataFrame*
+EphemerisStore::find(SATELLITE_SYSTEM sys, int prn,
+  const ngpt::datetime<ngpt::seconds>& t, bool check_health) const noexcept
+{
+  const int slot = __slot__(sys, prn);
+  if (slot<0) return nullptr;
+
+  const long key = __epoch_key__(t);
+  const long *first = __tocs.data() + __index[slot];
+  const long *last  = __tocs.data() + __index[slot+1];
+  const long *it    = std::lower_bound(first, last, key);
+
+  // walk both ways, picking the closer frame at each step
+  const long *left  = it;
+  const long *right = it;
+  while (left>first || right<last) {
+    const long *cur;
+    if (left>first && (right==last || key-*(left-1) <= *right-key)) {
+      cur = --left;
+    } else {
+      cur = right++;
+    }
+    const long dt = (*cur>key) ? (*cur-key) : (key-*cur);
+    if (dt>__max_span) break;
+    const std::size_t idx = cur - __tocs.data();
+    if (dt<=__ages[idx] && (!check_health || __is_healthy__(__frames[idx]))) {
+      return &__frames[idx];
+    }
+  }
+  return nullptr;
+}
+
+/// @details Get all frames of a given satellite; frames are sorted by ToC.
+/// @param[in]  sys   The satellite system
+/// @param[in]  prn   The satellite PRN
+/// @param[out] first Pointer to the first frame of the satellite (nullptr if
+///                   there are none)
+/// @return     The number of frames of the satellite
+std::size_t
+EphemerisStore::frames(SATELLITE_SYSTEM sys, int prn,
+  const NavDataFrame*& first) const noexcept
+{
+  const int slot = __slot__(sys, prn);
+  first = nullptr;
+  if (slot<0) return 0;
+  std::size_t n = __index[slot+1] - __index[slot];
+  if (n) first = __frames.data() + __index[slot];
+  return n;
+}
+
+/// @details Number of satellites with at least one frame in the store.
+std::size_t
+EphemerisStore::num_satellites() const noexcept
+{
+  std::size_t n = 0;
+  for (std::size_t i=1; i<__index.size(); i++) {
+    if (__index[i]!=__index[i-1]) ++n;
+  }
+  return n;
+}
@@ -0,0 +1,119 @@
+#ifndef __GNSS_EPHEMERIS_STORE_HPP__
+#define __GNSS_EPHEMERIS_STORE_HPP__
+
+/// @file      ephemeris_store.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     In-memory store of navigation data frames, indexed per
+///            satellite and time.
+///
+/// @details   An EphemerisStore holds all navigation data frames of one (or
+///            more) navigation RINEX files. Frames are bucketed per satellite
+///            (aka satellite system and PRN) and sorted by their reference
+///            epoch (ToC), so that the frame to use for any satellite at any
+///            epoch is found via a binary search; the RINEX file is not
+///            needed after the store is built.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <vector>
+#include <cstddef>
+#include "navrnx.hpp"
+
+namespace ngpt
+{
+
+/// @class EphemerisStore
+/// Navigation data frames, sorted per satellite and reference epoch (ToC).
+///
+/// Internally, all frames are kept in one contiguous array, sorted by
+/// satellite slot (a function of satellite system and PRN) and ToC. A second
+/// array holds the start of each slot (CSR-like), and a third one the ToC of
+/// each frame as integer seconds, so that binary searches do not have to walk
+/// over the (large) frames themselves. Frames with the same satellite and
+/// ToC are only stored once (the first one read is kept).
+///
+/// A frame is valid for a time interval centered at its ToC; the half-width
+/// of the interval (aka the max age) depends on the satellite system (see
+/// EphemerisStore::max_age). For GPS, the fit interval recorded in the frame
+/// is used (if any). For GLONASS, the ToC is tb, the epoch that
+/// NavDataFrame::glo_stateNclock, GloPropagator and GloNavBatch propagate
+/// from, so any frame the store returns is within their 15 min interval.
+///
+/// @note Epochs passed to the store's methods must be in the same time scale
+///       as the ToC recorded in the RINEX files, i.e. GPS time for GPS, UTC
+///       for GLONASS, etc.
+class EphemerisStore
+{
+public:
+  /// Max PRN (+1) allowed per satellite system
+  static constexpr int max_prn { 64 };
+
+  /// @brief Null constructor; empty store.
+  EphemerisStore();
+
+  /// @brief Constructor from a navigation RINEX instance; read all frames.
+  explicit
+  EphemerisStore(NavigationRnx& nav, int num_threads=0);
+
+  /// @brief Destructor.
+  ~EphemerisStore() noexcept;
+
+  /// @brief Add all frames of a navigation RINEX instance.
+  int
+  append(NavigationRnx& nav, int num_threads=0) noexcept;
+
+  /// @brief Find the best valid frame for a satellite at a given epoch.
+  const NavDataFrame*
+  find(SATELLITE_SYSTEM sys, int prn, const ngpt::datetime<ngpt::seconds>& t,
+    bool check_health=true) const noexcept;
+
+  /// @brief All frames (sorted by ToC) for a given satellite.
+  std::size_t
+  frames(SATELLITE_SYSTEM sys, int prn, const NavDataFrame*& first)
+  const noexcept;
+
+  /// @brief Set the max age (in seconds) for the frames of a satellite
+  ///        system.
+  void
+  set_max_age(SATELLITE_SYSTEM sys, long sec) noexcept;
+
+  /// @brief The max age (in seconds) for a given frame.
+  long
+  max_age(const NavDataFrame& frame) const noexcept;
+
+  /// @brief Number of frames in store.
+  std::size_t
+  size() const noexcept
+  {return __frames.size();}
+
+  /// @brief Number of satellites in store.
+  std::size_t
+  num_satellites() const noexcept;
+
+private:
+  /// @brief Rebuild the index after frames are added.
+  void
+  __build_index__(std::vector<NavDataFrame>&& frames);
+
+  std::vector<NavDataFrame> __frames; ///< Frames, sorted by slot and ToC
+  std::vector<long>         __tocs;   ///< ToC of each frame in (integer)
+                                      ///< seconds
+  std::vector<long>         __ages;   ///< Max age of each frame in seconds
+  std::vector<std::size_t>  __index;  ///< Start of each slot in __frames
+  long                      __max_age[7];  ///< Max age per system (sec)
+  long                      __max_span;    ///< Max of __ages
+}; // EphemerisStore
+
+} // ngpt
+
+#endif
@@ -0,0 +1,140 @@
+#include <cmath>
+#include <stdexcept>
+#include "glo_propagator.hpp"
+#include "glonav.hpp"
+
+using ngpt::GloPropagator;
+
+namespace
+{
+/// @brief One Runge-Kutta 4 step of the J.2 equations of motion (exactly as
+///        in NavDataFrame::glo_ecef).
+/// @param[in]  y   State vector at t, [x,y,z,vx,vy,vz]
+/// @param[in]  k1  State derivative at t (aka glo_state_deriv(y))
+/// @param[in]  acc Lunisolar accelerations
+/// @param[in]  h   Step (sec); may be negative
+/// @param[out] yh  State vector at t+h
+void
+__rk4_step__(const double* y, const double* k1, const double* acc, double h,
+  double* yh) noexcept
+{
+  double k2[6], k3[6], k4[6], ytmp[6];
+  for (int i=0; i<6; i++) ytmp[i] = y[i] + (h/2e0)*k1[i];
+  glo_state_deriv(ytmp, acc, k2);
+  for (int i=0; i<6; i++) ytmp[i] = y[i] + (h/2e0)*k2[i];
+  glo_state_deriv(ytmp, acc, k3);
+  for (int i=0; i<6; i++) ytmp[i] = y[i] + h*k3[i];
+  glo_state_deriv(ytmp, acc, k4);
+  for (int i=0; i<6; i++) yh[i] = y[i] + (h/6)*(k1[i]+2*k2[i]+2*k3[i]+k4[i]);
+}
+}// anonymous namespace
+
+/// @details Integrate the state vector of the navigation message forward and
+///          backward from tb, with a fixed step, untill the whole interval
+///          [tb-span, tb+span] is covered. The reference epoch tb is the ToC
+///          of the frame (RINEX v3.x records tb as ToC, in UTC).
+/// @param[in] frame A GLONASS navigation data frame
+/// @param[in] span  Half-width of the interval to cover (seconds); GLONASS
+///                  messages are valid for +/- 15 min
+/// @param[in] step  Integration step (seconds); default is the step used by
+///                  NavDataFrame::glo_ecef
+/// @throw std::runtime_error if span or step are not positive
+GloPropagator::GloPropagator(const NavDataFrame& frame, double span,
+  double step)
+  : __tb(frame.toc())
+  , __h(step)
+  , __nderiv(0)
+  , __tau(frame.data(0))
+  , __gamma(frame.data(1))
+{
+  if (span<=0e0 || step<=0e0) {
+    throw std::runtime_error("[ERROR] GloPropagator::GloPropagator Invalid span/step");
+  }
+  __steps = static_cast<int>(std::ceil(span/step-1e-9));
+  __nodes.resize(9*(2*__steps+1));
+
+  // initial conditions at tb (node K)
+  double* node = __nodes.data() + 9*__steps;
+  const double acc[] = {frame.data(5), frame.data(9), frame.data(13)};
+  node[0] = frame.data(3);
+  node[1] = frame.data(7);
+  node[2] = frame.data(11);
+  node[3] = frame.data(4);
+  node[4] = frame.data(8);
+  node[5] = frame.data(12);
+  double xdot[6];
+  glo_state_deriv(node, acc, xdot);
+  ++__nderiv;
+  std::copy(xdot+3, xdot+6, node+6);
+
+  // integrate forward (dir=1) and backward (dir=-1); the derivative at each
+  // node is both the node's acceleration and the first RK stage of the
+  // next step
+  for (int dir=-1; dir<=1; dir+=2) {
+    const double* prev = __nodes.data() + 9*__steps;
+    double k1[6];
+    std::copy(prev+3, prev+9, k1);
+    for (int k=1; k<=__steps; k++) {
+      double* next = __nodes.data() + 9*(__steps+dir*k);
+      __rk4_step__(prev, k1, acc, dir*__h, next);
+      glo_state_deriv(next, acc, k1);
+      __nderiv += 4;
+      std::copy(k1+3, k1+6, next+6);
+      prev = next;
+    }
+  }
+}
+
+/// @details Compute the SV state vector at t = tb + dt, interpolating between
+///          the two integration steps enclosing t. Positions follow from a
+///          quintic Hermite polynomial (position, velocity and acceleration
+///          matched at both steps), velocities from its derivative; at the
+///          integration steps, the integrated states are returned.
+/// @param[in]  dt    Seconds since tb (t - tb); |dt| must not exceed the span
+///                   of the instance
+/// @param[out] state Array of size 6; SV centre of mass state vector (aka
+///                   [x,y,z,Vx,Vy,Vz]) in the ECEF PZ-90 frame, in meters,
+///                   meters/sec
+/// @param[out] dtsv  If not nullptr, the SV clock correction at t (seconds)
+/// @return     0 on success; 1 if t is outside the propagated interval
+///             (state is not assigned)
+int
+GloPropagator::state(double dt, double* state, double* dtsv) const noexcept
+{
+  const double span = __steps*__h;
+  if (dt<-span || dt>span) return 1;
+
+  // enclosing steps; i0 (i0+1) is the index of the left (right) node
+  int i0 = static_cast<int>(std::floor(dt/__h)) + __steps;
+  if (i0>=2*__steps) i0 = 2*__steps-1;
+  if (i0<0) i0 = 0;
+  const double* p0 = __nodes.data() + 9*i0;
+  const double* p1 = p0 + 9;
+  const double  s  = (dt - (i0-__steps)*__h) / __h;
+  const double  h  = __h;
+
+  // quintic Hermite basis (and derivatives wrt s)
+  const double s2 = s*s, s3 = s2*s, s4 = s3*s, s5 = s4*s;
+  const double H0 = 1e0 - 10e0*s3 + 15e0*s4 - 6e0*s5;
+  const double H1 = s - 6e0*s3 + 8e0*s4 - 3e0*s5;
+  const double H2 = 0.5e0*s2 - 1.5e0*s3 + 1.5e0*s4 - 0.5e0*s5;
+  const double H3 = 0.5e0*s3 - s4 + 0.5e0*s5;
+  const double H4 = -4e0*s3 + 7e0*s4 - 3e0*s5;
+  const double H5 = 10e0*s3 - 15e0*s4 + 6e0*s5;
+  const double D0 = -30e0*s2 + 60e0*s3 - 30e0*s4;
+  const double D1 = 1e0 - 18e0*s2 + 32e0*s3 - 15e0*s4;
+  const double D2 = s - 4.5e0*s2 + 6e0*s3 - 2.5e0*s4;
+  const double D3 = 1.5e0*s2 - 4e0*s3 + 2.5e0*s4;
+  const double D4 = -12e0*s2 + 28e0*s3 - 15e0*s4;
+  const double D5 = -D0;
+
+  for (int i=0; i<3; i++) {
+    state[i] = H0*p0[i] + h*(H1*p0[3+i] + H4*p1[3+i])
+             + h*h*(H2*p0[6+i] + H3*p1[6+i]) + H5*p1[i];
+    state[3+i] = (D0*p0[i] + D5*p1[i]) / h + (D1*p0[3+i] + D4*p1[3+i])
+               + h*(D2*p0[6+i] + D3*p1[6+i]);
+  }
+
+  if (dtsv) *dtsv = __tau + __gamma*dt;
+  return 0;
+}
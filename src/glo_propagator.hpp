@@ -0,0 +1,99 @@
+#ifndef __GLONASS_PROPAGATOR_HPP__
+#define __GLONASS_PROPAGATOR_HPP__
+
+/// @file      glo_propagator.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Propagation of a GLONASS navigation message with dense output.
+///
+/// @details   NavDataFrame::glo_ecef integrates the equations of motion from
+///            tb to the requested instant on every call. A GloPropagator
+///            integrates (once) forward and backward from tb, over the whole
+///            validity interval of the message, keeps the state at every step
+///            and answers any instant within the interval by (Hermite)
+///            interpolation between the two enclosing steps.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <vector>
+#include "navrnx.hpp"
+
+namespace ngpt
+{
+
+/// @class GloPropagator
+/// A GLONASS navigation message, propagated over its validity interval.
+///
+/// The state vector is integrated with the same Runge-Kutta 4 scheme (and
+/// equations of motion) as NavDataFrame::glo_ecef, i.e. the "simplified
+/// algorithm" of the GLONASS ICD, Appendix J.2, in the ECEF PZ-90 frame.
+/// Integration steps are at tb + k*h, k = -K, ..., K; for every step the
+/// position, velocity and acceleration are stored. Positions between steps
+/// are interpolated with a quintic Hermite polynomial (matching position,
+/// velocity and acceleration at both steps), velocities with its
+/// derivative.
+///
+/// Epochs are given as seconds since tb (aka t - tb), or as dates in UTC
+/// (the time scale of RINEX GLONASS ToC).
+class GloPropagator
+{
+public:
+  /// @brief Constructor; integrate the message over [tb-span, tb+span].
+  explicit
+  GloPropagator(const NavDataFrame& frame, double span=900e0,
+    double step=60e0);
+
+  /// @brief SV state vector (and optionally clock correction) at t - tb.
+  int
+  state(double dt, double* state, double* dtsv=nullptr) const noexcept;
+
+  /// @brief SV state vector (and optionally clock correction) at a date
+  ///        (UTC).
+  template<typename T>
+    int
+    state(const ngpt::datetime<T>& t, double* st, double* dtsv=nullptr)
+    const noexcept
+  {
+    T dsec = ngpt::delta_sec<T, ngpt::seconds>(t, __tb);
+    return state(dsec.to_fractional_seconds(), st, dtsv);
+  }
+
+  /// @brief tb as date (UTC).
+  ngpt::datetime<ngpt::seconds>
+  tb() const noexcept
+  {return __tb;}
+
+  /// @brief Half-width of the propagated interval (seconds).
+  double
+  span() const noexcept
+  {return __steps*__h;}
+
+  /// @brief Number of derivative evaluations spent at construction.
+  int
+  num_derivatives() const noexcept
+  {return __nderiv;}
+
+private:
+  ngpt::datetime<ngpt::seconds> __tb;     ///< tb (UTC)
+  double                        __h;      ///< Integration step (sec)
+  int                           __steps;  ///< Steps on each side of tb (K)
+  int                           __nderiv; ///< Derivative evaluations
+  double                        __tau;    ///< SV clock bias (-TauN)
+  double                        __gamma;  ///< SV relative frequency bias
+  std::vector<double>           __nodes;  ///< [x,y,z,vx,vy,vz,ax,ay,az] at
+                                          ///< each step, from tb-K*h to
+                                          ///< tb+K*h
+}; // GloPropagator
+
+} // ngpt
+
+#endif
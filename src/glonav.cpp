@@ -1,12 +1,17 @@
 #include <iostream>
 #include <stdexcept>
 #include <cerrno>
+#include <cmath>
+#include <algorithm>
 #include "navrnx.hpp"
+#include "glonav.hpp"
 #ifdef DEBUG
 #include "ggdatetime/datetime_write.hpp"
 #endif
 
 using ngpt::NavDataFrame;
+using ngpt::GloIntegrator;
+using ngpt::GloIntegrationStats;
 
 /// GLONASS:    
 ///                        : Time of Clock in UTC time
@@ -44,6 +49,16 @@ using ngpt::NavDataFrame;
 // integration step for glonass in seconds (h parameter for Runge-Kutta4)
 constexpr double h_step = 60e0;
 
+// max number of integration steps (any integrator)
+constexpr int max_steps = 1500;
+
+// relative (and absolute, in meters and meters/sec) tolerance of the local
+// error per step, for the adaptive integrators
+constexpr double dopri_tol = 1e-9;
+
+// first trial step of the adaptive integrators (seconds)
+constexpr double dopri_h0 = 120e0;
+
 // (m3/s2) geocentric gravitational constant (mass of the Earth included)
 constexpr double GM_GLO = 398600441.8e06;
 
@@ -164,6 +179,56 @@ noexcept
   return;
 }
 
+/// Batched version of glo_state_deriv: the system of ODE's described in J.2.1
+/// is evaluated for n satellites at once. All arrays are in
+/// Structure-of-Arrays layout, i.e. component k of satellite i is at index
+/// k*n+i:
+/// x    = [ x[0..n), y[0..n), z[0..n), Vx[0..n), Vy[0..n), Vz[0..n) ]
+/// xdot = [ Vx[0..n), Vy[0..n), Vz[0..n), Vdot_x[0..n), ... ]
+/// acc  = [ acc_x[0..n), acc_y[0..n), acc_z[0..n) ]
+/// The loop over satellites has no branches and no calls but std::sqrt, so
+/// that it is vectorized (across satellites) by the compiler. Results are
+/// identical to n calls to glo_state_deriv.
+///
+/// @param[in]  n    Number of satellites
+/// @param[in]  x    Array of length 6*n; state vectors
+/// @param[in]  acc  Array of length 3*n; lunisolar accelerations
+/// @param[out] xdot Array of length 6*n; the computed ODE system; must not
+///                  overlap with x or acc
+/// 
+/// @warning All units are in meters, meters/sec and meters2/sec
+///
+/// @note The loop is only vectorized if std::sqrt is allowed to not set
+///       errno (-fno-math-errno).
+void
+glo_state_deriv_batch(std::size_t n, const double* __restrict__ x,
+  const double* __restrict__ acc, double* __restrict__ xdot)
+noexcept
+{
+  const double omg2 = OMEGA_GLO*OMEGA_GLO;                    // ω2
+  // the six components of xdot never overlap
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+  for (std::size_t i=0; i<n; i++) {
+    const double xi = x[i], yi = x[n+i], zi = x[2*n+i];
+    const double vx = x[3*n+i], vy = x[4*n+i];
+    const double r2 = (xi*xi+yi*yi+zi*zi);
+    const double r3 = r2*std::sqrt(r2);
+    const double a = 1.5e0*J2_GLO*GM_GLO*(AE_GLO*AE_GLO)/r2/r3; // 3/2*J2*mu*Ae^2/r^5
+    const double b = 5e0*zi*zi/r2;                              // 5*z^2/r^2
+    const double c = -GM_GLO/r3-a*(1e0-b);                      // -mu/r^3-a(1-b)
+    xdot[i]     = vx;
+    xdot[n+i]   = vy;
+    xdot[2*n+i] = x[5*n+i];
+    xdot[3*n+i] = (c+omg2)*xi+2.0*OMEGA_GLO*vy+acc[i];
+    xdot[4*n+i] = (c+omg2)*yi-2.0*OMEGA_GLO*vx+acc[n+i];
+    xdot[5*n+i] = (c-2.0*a)*zi+acc[2*n+i];
+  }
+  
+  return;
+}
+
 /// This is the computation of the system of ODE's described in J.1 in 
 /// GLONASS ICD, par. J1 "Precise algorithm for determination of position and 
 /// velocity vector components for the SV’s center of mass for the given 
@@ -209,6 +274,158 @@ noexcept
   return;
 }
 
+namespace
+{
+/// Signature of the equations of motion (glo_state_deriv or
+/// glo_state_deriv_inertial)
+using glo_deriv_fn = void (*)(const double*, const double*, double*) noexcept;
+
+/// @brief Propagate a state vector with the classic Runge-Kutta 4 method
+///
+/// Steps are of h_step seconds; the last one is shortened so that the
+/// integration stops exactly at t1.
+///
+/// @param[in]    f     The equations of motion
+/// @param[in]    acc   Array of size 3; lunisolar accelerations
+/// @param[in,out] y    Array of size 6; state vector at t0 on input, at t1
+///                     on output
+/// @param[in]    t0    Initial epoch (sec)
+/// @param[in]    t1    Final epoch (sec); may be before t0
+/// @param[out]   stats Steps and derivative evaluations are added here
+/// @return 0 on success, 1 if the max number of steps was reached
+int
+__glo_rk4__(glo_deriv_fn f, const double* acc, double* y, double t0,
+  double t1, GloIntegrationStats& stats) noexcept
+{
+  double k1[6], k2[6], k3[6], k4[6], ytmp[6];
+  const double dir = t1>t0 ? 1e0 : -1e0;
+  double ti = t0;
+  while (dir*(t1-ti)>1e-9) {
+    if (stats.steps>=max_steps) return 1;
+    const double h = dir*std::min(h_step, dir*(t1-ti));
+    f(y, acc, k1);
+    for (int i=0; i<6; i++) ytmp[i] = y[i] + (h/2e0)*k1[i];
+    f(ytmp, acc, k2);
+    for (int i=0; i<6; i++) ytmp[i] = y[i] + (h/2e0)*k2[i];
+    f(ytmp, acc, k3);
+    for (int i=0; i<6; i++) ytmp[i] = y[i] + h*k3[i];
+    f(ytmp, acc, k4);
+    for (int i=0; i<6; i++) y[i] += (h/6)*(k1[i]+2*k2[i]+2*k3[i]+k4[i]);
+    ti += h;
+    ++stats.steps;
+    stats.derivatives += 4;
+  }
+  return 0;
+}
+
+/// @brief Propagate a state vector with the embedded Runge-Kutta 5(4)
+///        method of Dormand and Prince
+///
+/// The local error of every step is estimated from the difference of the
+/// embedded 5th and 4th order solutions; a step is accepted if, for every
+/// component, |err| <= dopri_tol*(1+|y|), and the next step is scaled by
+/// 0.9*err^(-1/5) (within [0.2, 5]). The last stage of an accepted step is
+/// the first of the next one (FSAL), so an accepted step costs 6 derivative
+/// evaluations. The solution is advanced with the 5th order formula.
+///
+/// @param[in]    f     The equations of motion
+/// @param[in]    acc   Array of size 3; lunisolar accelerations
+/// @param[in,out] y    Array of size 6; state vector at t0 on input, at t1
+///                     on output
+/// @param[in]    t0    Initial epoch (sec)
+/// @param[in]    t1    Final epoch (sec); may be before t0
+/// @param[out]   stats Steps and derivative evaluations are added here
+/// @return 0 on success, 1 if the max number of steps was reached
+///
+/// @cite Dormand J.R., Prince P.J., A family of embedded Runge-Kutta
+///       formulae, J. Comp. Appl. Math., Vol. 6, 1980
+int
+__glo_dopri5__(glo_deriv_fn f, const double* acc, double* y, double t0,
+  double t1, GloIntegrationStats& stats) noexcept
+{
+  // the equations of motion do not depend on t, hence the nodes (c_i) of
+  // the tableau are not needed
+  constexpr double a21=1e0/5;
+  constexpr double a31=3e0/40, a32=9e0/40;
+  constexpr double a41=44e0/45, a42=-56e0/15, a43=32e0/9;
+  constexpr double a51=19372e0/6561, a52=-25360e0/2187, a53=64448e0/6561,
+                   a54=-212e0/729;
+  constexpr double a61=9017e0/3168, a62=-355e0/33, a63=46732e0/5247,
+                   a64=49e0/176, a65=-5103e0/18656;
+  constexpr double a71=35e0/384, a73=500e0/1113, a74=125e0/192,
+                   a75=-2187e0/6784, a76=11e0/84;
+  constexpr double e1=71e0/57600, e3=-71e0/16695, e4=71e0/1920,
+                   e5=-17253e0/339200, e6=22e0/525, e7=-1e0/40;
+
+  double k1[6], k2[6], k3[6], k4[6], k5[6], k6[6], k7[6];
+  double ytmp[6], ynew[6];
+  const double dir = t1>t0 ? 1e0 : -1e0;
+  double ti = t0;
+  double h  = dir*std::min(dopri_h0, dir*(t1-t0));
+  bool   rejected = false;
+  f(y, acc, k1);
+  ++stats.derivatives;
+  while (dir*(t1-ti)>1e-9) {
+    if (stats.steps+stats.rejected>=max_steps) return 1;
+    if (dir*(ti+h-t1)>0e0) h = t1-ti;
+    for (int i=0; i<6; i++) ytmp[i] = y[i] + h*a21*k1[i];
+    f(ytmp, acc, k2);
+    for (int i=0; i<6; i++) ytmp[i] = y[i] + h*(a31*k1[i]+a32*k2[i]);
+    f(ytmp, acc, k3);
+    for (int i=0; i<6; i++)
+      ytmp[i] = y[i] + h*(a41*k1[i]+a42*k2[i]+a43*k3[i]);
+    f(ytmp, acc, k4);
+    for (int i=0; i<6; i++)
+      ytmp[i] = y[i] + h*(a51*k1[i]+a52*k2[i]+a53*k3[i]+a54*k4[i]);
+    f(ytmp, acc, k5);
+    for (int i=0; i<6; i++)
+      ytmp[i] = y[i] + h*(a61*k1[i]+a62*k2[i]+a63*k3[i]+a64*k4[i]+a65*k5[i]);
+    f(ytmp, acc, k6);
+    for (int i=0; i<6; i++)
+      ynew[i] = y[i] + h*(a71*k1[i]+a73*k3[i]+a74*k4[i]+a75*k5[i]+a76*k6[i]);
+    f(ynew, acc, k7);
+    stats.derivatives += 6;
+    // scaled local error estimate (max norm)
+    double err = 0e0;
+    for (int i=0; i<6; i++) {
+      double ei = h*(e1*k1[i]+e3*k3[i]+e4*k4[i]+e5*k5[i]+e6*k6[i]+e7*k7[i]);
+      double sc = dopri_tol*(1e0+std::max(std::abs(y[i]), std::abs(ynew[i])));
+      err = std::max(err, std::abs(ei)/sc);
+    }
+    double fac = (err>0e0) ? 0.9e0*std::pow(err, -0.2e0) : 5e0;
+    fac = std::min(5e0, std::max(0.2e0, fac));
+    if (err<=1e0) {
+      ti += h;
+      std::copy(ynew, ynew+6, y);
+      std::copy(k7, k7+6, k1);
+      ++stats.steps;
+      // do not grow the step right after a rejection
+      if (rejected) fac = std::min(fac, 1e0);
+      rejected = false;
+    } else {
+      ++stats.rejected;
+      rejected = true;
+    }
+    h *= fac;
+  }
+  return 0;
+}
+
+/// @brief Propagate a state vector from t0 to t1 with a given integrator.
+int
+__glo_integrate__(glo_deriv_fn f, const double* acc, double* y, double t0,
+  double t1, GloIntegrator integrator, GloIntegrationStats& stats) noexcept
+{
+  switch (integrator) {
+    case GloIntegrator::dopri5:
+      return __glo_dopri5__(f, acc, y, t0, t1, stats);
+    case GloIntegrator::rk4:
+    default:
+      return __glo_rk4__(f, acc, y, t0, t1, stats);
+  }
+}
+}// anonymous namespace
+
 /// @brief Transform ECEF (PZ90) coordinates to inertial
 ///
 /// The transformation is used in the precise algorithm for calculating SV
@@ -295,10 +512,18 @@ noexcept
 /// given instant in MT". Note that t_sod and tb_sec must not be more than
 /// 15min apart.
 ///
+/// The equations of motion are integrated either with Runge-Kutta 4 and a
+/// fixed step of 60 sec (as in the ICD; the last step is shortened to end
+/// at t_sod), or with an adaptive Dormand-Prince 5(4) scheme, which covers
+/// the 15min interval in a few, large steps.
+///
 /// @param[in]  t_sod  Seconds of day (as double) in MT
 /// @param[in]  tb_sec Seconds of day (as double) in MT
 /// @param[out] state  array of size 6; SV centre of mass state vector (aka
 ///                    [x,y,z,Vx,Vy,Vz]) at time t_sod in meters, meters/sec
+/// @param[in]  integrator The integrator to use
+/// @param[out] stats  If not nullptr, at output holds the number of steps and
+///                    derivative evaluations spent for this call
 /// @return an integer denoting the status: 0 means all ok, -1 means that the
 ///         computation is performed, but the time interval is more than 15min
 ///         apart; anything >0 denotes an error
@@ -306,7 +531,8 @@ noexcept
 /// @cite GLONASS-ICD, Appendix J, "Algorithms for determination of SV center of 
 ///       mass position and velocity vector components using ephemeris data"
 int
-NavDataFrame::glo_ecef(double t_sod, double tb_sec, double* state) 
+NavDataFrame::glo_ecef(double t_sod, double tb_sec, double* state,
+  GloIntegrator integrator, GloIntegrationStats* stats) 
 const noexcept
 {
   int status = 0;
@@ -329,57 +555,53 @@ const noexcept
   acc[1] = data__[9];
   acc[2] = data__[13];
   
+  GloIntegrationStats cost;
+  if (stats) *stats = cost;
+
   // quick return if tb == ti
   if (t_sod == tb_sec) {
     std::copy(x, x+6, state);
     return status;
   }
 
-  double k1[6], k2[6], k3[6], k4[6];
-  double ytmp[6], yti[6];
-  double h = t_sod>tb_sec?h_step:-h_step;
-  double ti= tb_sec;
   double t_lim = t_sod-std::round((t_sod-tb_sec)/86400)*86400;
-  int    max_it=0;
-  std::copy(x, x+6, yti);
-  // Perform Runge-Kutta 4th 
-  // while (std::abs(ti-t_lim)>1e-9 && ++max_it<1500) {
-  while ( h>0?ti<t_lim:ti>t_lim && ++max_it<1500) {
-    // compute k1
-    glo_state_deriv(yti, acc, k1);
-    // compute k2
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + (h/2e0)*k1[i];
-    glo_state_deriv(ytmp, acc, k2);
-    // compute k3
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + (h/2e0)*k2[i];
-    glo_state_deriv(ytmp, acc, k3);
-    // compute k4
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + h*k3[i];
-    glo_state_deriv(ytmp, acc, k4);
-    // update y
-    for (int i=0; i<6; i++) yti[i] += (h/6)*(k1[i]+2*k2[i]+2*k3[i]+k4[i]);
-    // update ti
-    ti += h;
-  }
-  if (max_it>=1500) {
-    std::cerr<<"\n[ERROR] NavDataFrame::glo_ecef() h="<<h<<", from "
-      <<tb_sec<<" to "<<t_lim<<" last t="<<ti;
+  int error = __glo_integrate__(glo_state_deriv, acc, x, tb_sec, t_lim,
+    integrator, cost);
+  if (stats) *stats = cost;
+  if (error) {
+    std::cerr<<"\n[ERROR] NavDataFrame::glo_ecef() Too many steps, from "
+      <<tb_sec<<" to "<<t_lim;
     return 10;
   }
 
   // copy results
-  std::copy(yti, yti+6, state);
+  std::copy(x, x+6, state);
 
   return status;
 }
 
+/// @brief Compute SV coordinates from navigation block (precise algorithm)
+///
+/// Same as glo_ecef, but following the "precise" algorithm of the ICD (J.1),
+/// i.e. the integration is performed in an inertial frame.
+///
+/// @param[in]  t_sod  Seconds of day (as double) in MT
+/// @param[in]  tb_sec Seconds of day (as double) in MT
+/// @param[out] xs, ys, zs SV coordinates at t_sod in the ECEF PZ-90 frame
+///                    (meters)
+/// @param[out] vel    If not nullptr, an array of size 3 holding the SV
+///                    velocity at t_sod (meters/sec)
+/// @param[in]  integrator The integrator to use
+/// @param[out] stats  If not nullptr, at output holds the number of steps and
+///                    derivative evaluations spent for this call
+/// @return 0 on success; anything else denotes an error
 int
-NavDataFrame::glo_ecef2(double t_sod, double tb_sec, double& xs, double& ys, double& zs, double* vel)
+NavDataFrame::glo_ecef2(double t_sod, double tb_sec, double& xs, double& ys, double& zs, double* vel,
+  GloIntegrator integrator, GloIntegrationStats* stats)
 const noexcept
 {
   double x[6], acc[3];
-  double k1[6], k2[6], k3[6], k4[6];
-  double ytmp[6], yti[6];
+  double ytmp[6];
   
   // tb as datetime instance in MT
   // ngpt::datetime<seconds> tb = glo_tb2date(true);
@@ -402,6 +624,9 @@ const noexcept
   acc[1] = data__[9];
   acc[2] = data__[13];
   
+  GloIntegrationStats cost;
+  if (stats) *stats = cost;
+
   // quick return if tb == ti
   if (t_sod == tb_sec) {
     xs = x[0];
@@ -412,41 +637,26 @@ const noexcept
   }
 
   // transform state vector to inertial frame
-  // tb as datetime instance in MT
-  ngpt::datetime<seconds> tb_dt = glo_tb2date(true);
+  // tb (aka ToC) as datetime instance in MT
+  ngpt::datetime<seconds> tb_dt = toc__;
+  tb_dt.add_seconds(ngpt::seconds(10800L));
   glo_ecef2inertial(x, tb_dt, ytmp, acc);
-  std::copy(ytmp, ytmp+6, x);
 
-  // Perform Runge-Kutta 4th 
-  std::copy(x, x+6, yti);
-  double h = t_sod>tb_sec?h_step:-h_step;
-  double ti= tb_sec;
+  // integrate in the inertial frame
   double t_lim = t_sod-std::round((t_sod-tb_sec)/86400)*86400;
-  int max_it=0;
-  // Perform Runge-Kutta 4th 
-  while (std::abs(ti-t_lim)>1e-9 && ++max_it<1500) {
-    // printf("\nt=%10.5f x=%+20.5f y=%+20.5f z=%+20.5f", ti, yti[0], yti[1], yti[2]);
-    // compute k1
-    glo_state_deriv_inertial(yti, acc, k1);
-    // compute k2
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + (h/2e0)*k1[i];
-    glo_state_deriv_inertial(ytmp, acc, k2);
-    // compute k3
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + (h/2e0)*k2[i];
-    glo_state_deriv_inertial(ytmp, acc, k3);
-    // compute k4
-    for (int i=0; i<6; i++) ytmp[i] = yti[i] + h*k3[i];
-    glo_state_deriv_inertial(ytmp, acc, k4);
-    // update y
-    for (int i=0; i<6; i++) yti[i] += (h/6)*(k1[i]+2*k2[i]+2*k3[i]+k4[i]);
-    // update ti
-    ti += h;
+  int error = __glo_integrate__(glo_state_deriv_inertial, acc, ytmp, tb_sec,
+    t_lim, integrator, cost);
+  if (stats) *stats = cost;
+  if (error) {
+    std::cerr<<"\n[ERROR] NavDataFrame::glo_ecef2() Too many steps, from "
+      <<tb_sec<<" to "<<t_lim;
+    return 10;
   }
 
-  // all done! result state vector is at yti in an inertial RF. convert to PZ90
-  // ti as datetime instance in MT
+  // all done! result state vector is at ytmp in an inertial RF. convert to
+  // PZ90; ti as datetime instance in MT
   ngpt::datetime<ngpt::seconds> tidt (tb_dt.mjd(), ngpt::seconds(t_sod));
-  glo_inertial2ecef(yti, tidt, x);
+  glo_inertial2ecef(ytmp, tidt, x);
 
   // copy results
   xs = x[0];
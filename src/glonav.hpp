@@ -0,0 +1,45 @@
+#ifndef __GLONASS_NAVIGATION_HPP__
+#define __GLONASS_NAVIGATION_HPP__
+
+/// @file      glonav.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Equations of motion for GLONASS broadcast ephemeris
+///            propagation.
+///
+/// @details   The systems of ODE's described in GLONASS ICD, Appendix J, used
+///            to propagate a GLONASS SV state vector from the reference time
+///            of the navigation message (tb) to any instant within its
+///            validity interval.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <cstddef>
+
+/// @brief State derivative, J.2.1 "Simplified algorithm" (ECEF PZ-90)
+void
+glo_state_deriv(const double *x, const double* acc, double *xdot)
+noexcept;
+
+/// @brief State derivative, J.1 "Precise algorithm" (inertial frame)
+void
+glo_state_deriv_inertial(const double *x, const double* acc, double *xdot)
+noexcept;
+
+/// @brief State derivative, J.2.1 "Simplified algorithm" (ECEF PZ-90), for
+///        n satellites in Structure-of-Arrays layout
+void
+glo_state_deriv_batch(std::size_t n, const double* __restrict__ x,
+  const double* __restrict__ acc, double* __restrict__ xdot)
+noexcept;
+
+#endif
@@ -0,0 +1,148 @@
+#include <cmath>
+#include <algorithm>
+#include <exception>
+#include "navbatch.hpp"
+#include "glonav.hpp"
+
+using ngpt::GloNavBatch;
+
+namespace
+{
+/// Max integration step (sec); the step of NavDataFrame::glo_ecef
+constexpr double MAX_STEP {60e0};
+
+/// Max interval (sec) between t and tb; the validity of a GLONASS message
+constexpr double MAX_INTERVAL {15*60e0};
+}// anonymous namespace
+
+/// @details Add a GLONASS navigation data frame; tb is the ToC of the frame
+///          (RINEX v3.x records tb as ToC, in UTC).
+/// @param[in] frame A navigation data frame (must be GLONASS)
+/// @return    0 if the frame was added; 1 if the frame is not a GLONASS
+///            frame (nothing added); 10 if memory could not be allocated
+///            (nothing added)
+int
+GloNavBatch::add(const NavDataFrame& frame) noexcept
+{
+  if (frame.sys() != SATELLITE_SYSTEM::glonass) return 1;
+
+  const std::size_t n = size();
+  try {
+    __p[X].push_back(frame.data(3));
+    __p[Y].push_back(frame.data(7));
+    __p[Z].push_back(frame.data(11));
+    __p[VX].push_back(frame.data(4));
+    __p[VY].push_back(frame.data(8));
+    __p[VZ].push_back(frame.data(12));
+    __p[AX].push_back(frame.data(5));
+    __p[AY].push_back(frame.data(9));
+    __p[AZ].push_back(frame.data(13));
+    __p[TB].push_back(epoch(frame.toc()));
+    __p[TAU].push_back(frame.data(0));
+    __p[GAMMA].push_back(frame.data(1));
+    __work.resize(WORK_PER_FRAME*(n+1));
+  } catch (std::exception&) {
+    for (auto& v : __p) v.resize(n);
+    return 10;
+  }
+
+  return 0;
+}
+
+/// @details Remove all frames; the reference day is not changed.
+void
+GloNavBatch::clear() noexcept
+{
+  for (auto& v : __p) v.clear();
+  __work.clear();
+}
+
+/// @details Propagate the state vector of every frame from its tb to t. The
+///          number of Runge-Kutta 4 steps K is the smallest such that
+///          |t-tb|/K <= 60 sec for all frames; frame i then takes K steps of
+///          (t-tb_i)/K seconds. The state vectors of all frames are kept in
+///          Structure-of-Arrays layout and every stage is evaluated with
+///          glo_state_deriv_batch, followed by a loop over all components of
+///          all frames; both are vectorized across satellites.
+///
+///          The output arrays are also in Structure-of-Arrays layout, aka
+///          component k of frame i is at index k*size()+i. Intermediate
+///          results are kept in the workspace of the instance (no memory is
+///          allocated here).
+///
+/// @param[in]  t     Epoch (UTC) in seconds since the start of the reference
+///                   day (see GloNavBatch::epoch)
+/// @param[out] state Array of size 6*size(); SV centre of mass state vectors
+///                   ([x,y,z,Vx,Vy,Vz]) in the ECEF PZ-90 frame, in meters,
+///                   meters/sec
+/// @param[out] dtsv  If not nullptr, an array of size size(); SV clock
+///                   corrections in seconds
+/// @return     0 if all went well; -1 if for some frame t and tb are more
+///             than 15 min apart (all state vectors are computed anyway)
+///
+/// @see NavDataFrame::glo_ecef
+int
+GloNavBatch::ecef(double t, double* state, double* dtsv) noexcept
+{
+  const std::size_t n = size();
+  if (!n) return 0;
+  const double* pTB = __p[TB].data();
+
+  // number of steps (common to all frames) and step of each frame
+  double max_dt = 0e0;
+  for (std::size_t i=0; i<n; i++) max_dt = std::max(max_dt, std::abs(t-pTB[i]));
+  const int steps = static_cast<int>(std::ceil(max_dt/MAX_STEP-1e-9));
+  const int status = (max_dt>MAX_INTERVAL) ? -1 : 0;
+
+  // workspace (sized by add): step/2 and step/6 of each frame,
+  // accelerations, 4 stages and the intermediate state vector
+  double* __restrict__ h2   = __work.data();
+  double* __restrict__ h6   = h2 + n;
+  double* __restrict__ acc  = h6 + n;
+  double* __restrict__ k1   = acc + 3*n;
+  double* __restrict__ k2   = k1 + 6*n;
+  double* __restrict__ k3   = k2 + 6*n;
+  double* __restrict__ k4   = k3 + 6*n;
+  double* __restrict__ ytmp = k4 + 6*n;
+  double* __restrict__ y    = state;
+
+  for (int k=0; k<6; k++) std::copy(__p[X+k].begin(), __p[X+k].end(), y+k*n);
+  for (int k=0; k<3; k++) std::copy(__p[AX+k].begin(), __p[AX+k].end(), acc+k*n);
+  for (std::size_t i=0; i<n; i++) {
+    const double h = steps ? (t-pTB[i])/steps : 0e0;
+    h2[i] = h/2e0;
+    h6[i] = h/6;
+  }
+
+  for (int s=0; s<steps; s++) {
+    glo_state_deriv_batch(n, y, acc, k1);
+    for (int k=0; k<6; k++) {
+      for (std::size_t i=0; i<n; i++) ytmp[k*n+i] = y[k*n+i] + h2[i]*k1[k*n+i];
+    }
+    glo_state_deriv_batch(n, ytmp, acc, k2);
+    for (int k=0; k<6; k++) {
+      for (std::size_t i=0; i<n; i++) ytmp[k*n+i] = y[k*n+i] + h2[i]*k2[k*n+i];
+    }
+    glo_state_deriv_batch(n, ytmp, acc, k3);
+    for (int k=0; k<6; k++) {
+      for (std::size_t i=0; i<n; i++) {
+        ytmp[k*n+i] = y[k*n+i] + (2e0*h2[i])*k3[k*n+i];
+      }
+    }
+    glo_state_deriv_batch(n, ytmp, acc, k4);
+    for (int k=0; k<6; k++) {
+      for (std::size_t i=0; i<n; i++) {
+        const std::size_t j = k*n+i;
+        y[j] += h6[i]*(k1[j]+2*k2[j]+2*k3[j]+k4[j]);
+      }
+    }
+  }
+
+  if (dtsv) {
+    const double* pTAU = __p[TAU].data();
+    const double* pGAMMA = __p[GAMMA].data();
+    for (std::size_t i=0; i<n; i++) dtsv[i] = pTAU[i] + pGAMMA[i]*(t-pTB[i]);
+  }
+
+  return status;
+}
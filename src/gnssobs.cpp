@@ -90,12 +90,7 @@ ObservationCode::ObservationCode(const char* str)
 std::string
 ObservationCode::to_string() const
 {
-  std::string str ("???");
-  char c0 = ngpt::observabletype_to_char(__type);
-  auto c1 = std::to_string(__band);
-  char c2 = __attr.as_char();
-  str[0] = c0;
-  str[1] = c1[0];
-  str[2] = c2;
-  return str;
+  const char str[] = {ngpt::observabletype_to_char(__type),
+    static_cast<char>('0' + __band), __attr.as_char()};
+  return std::string(str, 3);
 }
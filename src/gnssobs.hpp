@@ -21,6 +21,13 @@
 ///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
 ///            for more details.
 
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <functional>
+#include "satsys.hpp"
+
 namespace ngpt
 {
 
@@ -133,6 +140,16 @@ public:
   band() const noexcept
   {return __band;}
 
+  /// @brief Get the instance's observable type
+  OBSERVABLE_TYPE
+  type() const noexcept
+  {return __type;}
+
+  /// @brief Get the instance's attribute
+  ObservationAttribute
+  attribute() const noexcept
+  {return __attr;}
+
   /// @brief Cast to std::string
   std::string
   to_string() const;
@@ -143,6 +160,183 @@ private:
     ObservationAttribute __attr;
 }; // ObservationCode
 
+/// @class PackedObservationCode
+///
+/// A satellite system plus an observation code (e.g. GPS 'C1C') packed in a
+/// 16-bit integer, to be used as a key (e.g. in hash maps or when resolving
+/// the columns of a RINEX observation file). The bits are (MSB to LSB):
+///  +-----------+------------------+---------+---------------------------+
+///  | 15 (zero) | 14-12: satellite | 11-9:   | 8-5: band | 4-0: attribute|
+///  |           | system           | type    |           |               |
+///  +-----------+------------------+---------+---------------------------+
+/// where the system and the type are the values of the SATELLITE_SYSTEM and
+/// OBSERVABLE_TYPE enumerations, the band is 0-9 and the attribute is 0 for
+/// '?' (any) and 1-26 for 'A'-'Z'. Hence, comparing the packed integers
+/// orders codes on system, type, band and attribute.
+class PackedObservationCode
+{
+public:
+  /// @brief Default constructor; mixed system, any type, band 0, any
+  ///        attribute
+  constexpr
+  PackedObservationCode() noexcept
+  : __bits(pack(SATELLITE_SYSTEM::mixed, OBSERVABLE_TYPE::any, 0, 0))
+  {}
+
+  /// @brief Constructor from components.
+  /// @throw std::runtime_error if the band or the attribute is invalid (at
+  ///        compile time, an invalid code does not compile)
+  constexpr
+  PackedObservationCode(SATELLITE_SYSTEM s, OBSERVABLE_TYPE t, int band,
+    char attribute='?')
+  : __bits(pack(s, t, check_band(band), attribute_index(attribute)))
+  {}
+
+  /// @brief Constructor from a c-string, e.g. "C1C"; the first character is
+  ///        the type and the second the band; a missing (or blank) third
+  ///        character is treated as '?' (any attribute).
+  /// @throw std::runtime_error if the string cannot be resolved (at compile
+  ///        time, an invalid code does not compile)
+  constexpr
+  PackedObservationCode(SATELLITE_SYSTEM s, const char* str)
+  : __bits(pack(s, type_of(str[0]),
+      check_band(str[0] ? str[1]-'0' : -1),
+      (str[0] && str[1] && str[2] && str[2]!=' ')
+        ? attribute_index(str[2]) : 0))
+  {}
+
+  /// @brief Constructor from an ObservationCode.
+  /// @throw std::runtime_error if the band or the attribute is invalid
+  PackedObservationCode(SATELLITE_SYSTEM s, const ObservationCode& code)
+  : PackedObservationCode(s, code.type(), code.band(),
+      code.attribute().as_char())
+  {}
+
+  /// @brief The packed integer
+  constexpr std::uint16_t
+  bits() const noexcept
+  {return __bits;}
+
+  /// @brief The satellite system
+  constexpr SATELLITE_SYSTEM
+  satsys() const noexcept
+  {return static_cast<SATELLITE_SYSTEM>((__bits>>12) & 0x7);}
+
+  /// @brief The observable type
+  constexpr OBSERVABLE_TYPE
+  type() const noexcept
+  {return static_cast<OBSERVABLE_TYPE>((__bits>>9) & 0x7);}
+
+  /// @brief The frequency band
+  constexpr int
+  band() const noexcept
+  {return (__bits>>5) & 0xf;}
+
+  /// @brief The attribute ('?' for any)
+  constexpr char
+  attribute() const noexcept
+  {
+    const int a = __bits & 0x1f;
+    return a ? static_cast<char>('A' + a - 1) : '?';
+  }
+
+  /// @brief Unpack to an ObservationCode
+  ObservationCode
+  observation_code() const noexcept
+  {return ObservationCode(type(), band(), ObservationAttribute(attribute()));}
+
+  /// @brief Write the code (3 chars, e.g. "C1C") plus a null char to buf
+  ///        (no allocation).
+  void
+  to_chars(char* buf) const noexcept
+  {
+    buf[0] = observabletype_to_char(type());
+    buf[1] = static_cast<char>('0' + band());
+    buf[2] = attribute();
+    buf[3] = '\0';
+  }
+
+  constexpr bool
+  operator==(PackedObservationCode c) const noexcept
+  {return __bits == c.__bits;}
+
+  constexpr bool
+  operator!=(PackedObservationCode c) const noexcept
+  {return __bits != c.__bits;}
+
+  constexpr bool
+  operator<(PackedObservationCode c) const noexcept
+  {return __bits < c.__bits;}
+
+  constexpr bool
+  operator<=(PackedObservationCode c) const noexcept
+  {return __bits <= c.__bits;}
+
+  constexpr bool
+  operator>(PackedObservationCode c) const noexcept
+  {return __bits > c.__bits;}
+
+  constexpr bool
+  operator>=(PackedObservationCode c) const noexcept
+  {return __bits >= c.__bits;}
+
+private:
+  static constexpr std::uint16_t
+  pack(SATELLITE_SYSTEM s, OBSERVABLE_TYPE t, int band, int attr) noexcept
+  {
+    return static_cast<std::uint16_t>(
+        (static_cast<int>(s) << 12) | (static_cast<int>(t) << 9)
+      | (band << 5) | attr);
+  }
+
+  static constexpr int
+  check_band(int band)
+  {
+    return (band >= 0 && band <= 9)
+      ? band
+      : throw std::runtime_error("[ERROR] Invalid band in ObservationCode");
+  }
+
+  static constexpr int
+  attribute_index(char c)
+  {
+    return (c == '?')
+      ? 0
+      : ((c >= 'A' && c <= 'Z')
+          ? (c - 'A' + 1)
+          : throw std::runtime_error("[ERROR] Invalid attribute in ObservationCode"));
+  }
+
+  /// same as ngpt::char_to_observabletype, usable at compile time
+  static constexpr OBSERVABLE_TYPE
+  type_of(char c)
+  {
+    switch (c) {
+      case 'C' : return OBSERVABLE_TYPE::pseudorange;
+      case 'L' : return OBSERVABLE_TYPE::carrier_phase;
+      case 'D' : return OBSERVABLE_TYPE::doppler;
+      case 'S' : return OBSERVABLE_TYPE::signal_strength;
+      case 'I' : return OBSERVABLE_TYPE::ionosphere_phase_delay;
+      case 'X' : return OBSERVABLE_TYPE::receiver_channel_number;
+      default  : throw std::runtime_error("[ERROR] Cannot match char to observable type");
+    }
+  }
+
+  std::uint16_t __bits; ///< the packed code
+}; // PackedObservationCode
+
 } // ngpt
 
+namespace std
+{
+/// @brief Hash of a PackedObservationCode (the packed integer is unique)
+template<>
+  struct hash<ngpt::PackedObservationCode>
+{
+  std::size_t
+  operator()(ngpt::PackedObservationCode c) const noexcept
+  {return static_cast<std::size_t>(c.bits());}
+};
+} // std
+
 #endif
@@ -21,7 +21,6 @@
 ///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
 ///            for more details.
 
-#include <vector>
 #include "satsys.hpp"
 #include "gnssobs.hpp"
 
@@ -59,6 +58,13 @@ struct __ObsPart
   GnssRawObservable __type;
   double            __coef;
 
+  /// Default constructor; an empty part (any system, zero coefficient)
+  __ObsPart() noexcept
+  : __type(GnssRawObservable{ngpt::SATELLITE_SYSTEM::mixed,
+      ngpt::ObservationCode()}),
+    __coef(0e0)
+  {};
+
   __ObsPart(GnssRawObservable o, double c=1e0) noexcept
   : __type(o),
     __coef(c)
@@ -71,44 +77,138 @@ struct __ObsPart
     __coef(c)
   {};
 
-  /// nominal frequency multiplied by coefficient in MHz
+  /// nominal frequency multiplied by coefficient in MHz; uses the constexpr
+  /// per-band tables of satellite_system_traits<> (no lookup, no throw).
+  /// Invalid bands give 0.
+  /// @warning GLONASS FDMA (G1, G2) frequencies depend on the frequency
+  ///          channel of the satellite; 0 is returned for these (use
+  ///          frequency(int) instead).
   double
-  frequency() const;
+  frequency() const noexcept
+  {
+    using traits = ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::glonass>;
+    return (__type.satsys() == ngpt::SATELLITE_SYSTEM::glonass
+            && traits::is_fdma(__type.band()))
+      ? 0e0
+      : ngpt::nominal_frequency(__type.satsys(), __type.band()) * __coef;
+  }
+
+  /// frequency multiplied by coefficient in MHz, given the frequency channel
+  /// (k) of the satellite; k is only used for GLONASS FDMA bands (see
+  /// ngpt::glonass_frequency), where an invalid channel gives 0.
+  double
+  frequency(int channel) const noexcept
+  {
+    return (__type.satsys() == ngpt::SATELLITE_SYSTEM::glonass)
+      ? ngpt::glonass_frequency(__type.band(), channel) * __coef
+      : ngpt::nominal_frequency(__type.satsys(), __type.band()) * __coef;
+  }
+
+  /// true if the frequency depends on the frequency channel (aka this is a
+  /// GLONASS FDMA band)
+  bool
+  is_fdma() const noexcept
+  {
+    return __type.satsys() == ngpt::SATELLITE_SYSTEM::glonass
+      && ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::glonass>
+           ::is_fdma(__type.band());
+  }
 
 }; // __ObsPart
 
+/// @class GnssObservable
+///
+/// A GNSS observable, aka a linear combination of (up to max_parts) raw
+/// observables, e.g. L1 or the ionosphere-free combination of L1 and L2.
+/// The parts are held inline (no heap allocation) and the frequency of the
+/// combination is computed when a part is added, so that frequency() and
+/// wavelength() are just member accesses.
 class GnssObservable
 {
 public:
+  /// Max number of raw observables in a combination
+  static constexpr int max_parts { 4 };
+
   GnssObservable(ngpt::SATELLITE_SYSTEM sys, ngpt::ObservationCode code, 
     double coef=1e0)
   noexcept
-  {__vec.emplace_back(sys, code, coef);}
+  {add(sys, code, coef);}
   
   GnssObservable(GnssRawObservable obs, double coef=1e0)
   noexcept
-  {__vec.emplace_back(obs, coef);}
+  {add(obs, coef);}
 
-  void
+  /// Add a raw observable to the combination
+  /// @return 0 on success, 1 if the combination already holds max_parts
+  ///         parts (nothing is added)
+  int
   add(GnssRawObservable obs, double coef=1e0)
   noexcept
-  {__vec.emplace_back(obs, coef);}
+  {
+    if (__size == max_parts) return 1;
+    __parts[__size] = __ObsPart(obs, coef);
+    __frequency += __parts[__size].frequency();
+    __fdma = __fdma || __parts[__size].is_fdma();
+    ++__size;
+    return 0;
+  }
 
-  void
+  /// Add a raw observable to the combination
+  /// @return 0 on success, 1 if the combination already holds max_parts
+  ///         parts (nothing is added)
+  int
   add(ngpt::SATELLITE_SYSTEM sys, ngpt::ObservationCode code, 
     double coef=1e0)
   noexcept
-  {__vec.emplace_back(sys, code, coef);}
+  {return add(GnssRawObservable{sys, code}, coef);}
+
+  /// number of raw observables in the combination
+  int
+  num_parts() const noexcept
+  {return __size;}
 
+  /// frequency of the observable (aka linear combination) in MHz
+  /// @warning GLONASS FDMA components give 0; use frequency(int)
   double
   frequency() const noexcept
+  {return __frequency;}
+
+  /// frequency of the observable (aka linear combination) in MHz, given the
+  /// frequency channel of the satellite (only used for GLONASS FDMA bands;
+  /// e.g. from BernSatellit or NavDataFrame::glo_frequency_channel).
+  double
+  frequency(int channel) const noexcept
   {
+    if (!__fdma) return __frequency;
     double frequency = 0e0;
-    for (const auto& v : __vec) frequency += v.frequency();
+    for (int i=0; i<__size; i++) frequency += __parts[i].frequency(channel);
     return frequency;
   }
+
+  /// wavelength of the observable (aka linear combination) in meters; 0 if
+  /// the frequency is 0
+  double
+  wavelength() const noexcept
+  {
+    return (__frequency != 0e0)
+      ? ngpt::speed_of_light / (__frequency * 1e6)
+      : 0e0;
+  }
+
+  /// wavelength of the observable (aka linear combination) in meters, given
+  /// the frequency channel of the satellite (only used for GLONASS FDMA
+  /// bands); 0 if the frequency is 0
+  double
+  wavelength(int channel) const noexcept
+  {
+    const double f = frequency(channel);
+    return (f != 0e0) ? ngpt::speed_of_light / (f * 1e6) : 0e0;
+  }
 private:
-  std::vector<__ObsPart> __vec;
+  __ObsPart __parts[max_parts];  ///< the raw observables (first __size)
+  int       __size {0};          ///< number of raw observables
+  bool      __fdma {false};      ///< any GLONASS FDMA part?
+  double    __frequency {0e0};   ///< frequency (MHz), FDMA parts excluded
 }; // class GnssObservable
 
 } // namespace ngpt
@@ -39,11 +39,9 @@ using ngpt::NavDataFrame;
 ///             data__[29] : empty
 ///             data__[30] : empty                                       ---- 7
 
-/// WGS 84 value of the earth's gravitational constant for GPS user
-constexpr double mi_gps {3.986005e14};
-
-/// WGS 84 value of the earth's rotation rate
-constexpr double OMEGAE_dot {7.2921151467e-5};
+/// Constants of the GPS broadcast orbit model (WGS 84 GM, earth rotation
+/// rate, relativistic clock correction F)
+using gps_traits = ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::gps>;
 
 /// PZ-90/GLO mean angular velocity of the Earth relative to vernal equinox
 constexpr double OMEGA_E {7.2921151467e-5}; // units: rad/sec
@@ -51,18 +49,20 @@ constexpr double OMEGA_E {7.2921151467e-5}; // units: rad/sec
 /// Seconds in (GPS) week
 constexpr double SEC_IN_WEEK {604800e0};
 
-/// Constant F for SV Clock Correction in seconds/sqrt(meters)
-constexpr double F_CLOCK {-4.442807633e-10};
-
-/// @brief get SV coordinates (WGS84) from navigation block
+/// @brief get SV coordinates and velocity (WGS84) from navigation block
 /// 
 /// Compute the ECEF coordinates of position for the phase center of the SVs' 
-/// antennas. The time parameter should be given in GPS Time
+/// antennas. The time parameter should be given in GPS Time. If requested,
+/// the velocity is computed in the same pass, from the analytic derivatives
+/// of the orbital elements (IS-GPS-200H, Table 20-IV).
 /// @param[in] toe_sec  Time of Ephemeris as seconds in day
 /// @param[in] t_sec    Epoch as seconds in day
 /// @param[out] state SV x,y,z -components of antenna phase center position in 
-///             the WGS84 ECEF coordinate system in meters; the state array must
-///             have length >=3
+///             the WGS84 ECEF coordinate system in meters; the state array
+///             must have length >=3
+/// @param[out] Ek_ptr If not nullptr, the eccentric anomaly (rad)
+/// @param[out] vel If not nullptr, an array of length >=3; at output holds
+///             the vx,vy,vz -components of velocity in meters/sec
 /// @return Anything other than 0 denotes an error
 ///
 /// @note Input parameters toe_sec and t_sec should be referenced to the same,
@@ -70,7 +70,8 @@ constexpr double F_CLOCK {-4.442807633e-10};
 ///
 /// @see IS-GPS-200H, User Algorithm for Ephemeris Determination
 int
-NavDataFrame::gps_ecef(double toe_sec, double t_sec, double* state, double* Ek_ptr)
+NavDataFrame::gps_ecef(double toe_sec, double t_sec, double* state, double* Ek_ptr,
+  double* vel)
 const noexcept
 {
   int status = 0;
@@ -78,7 +79,7 @@ const noexcept
                                          //+ the Kepler equation for the 
                                          //+ eccentricity anomaly
   double A  (data__[10]*data__[10]);     //  Semi-major axis
-  double n0 (std::sqrt(mi_gps/(A*A*A))); //  Computed mean motion (rad/sec)
+  double n0 (std::sqrt(gps_traits::broadcast_gm/(A*A*A))); //  Computed mean motion (rad/sec)
   double tk (t_sec-toe_sec);
 #ifdef DEBUG
   if (tk<-302400e0 || tk>302400e0) {
@@ -108,7 +109,8 @@ const noexcept
   double sinE    (std::sin(E));
   double cosE    (std::cos(E));
   double ecosEm1 (1e0-e*cosE);
-  double vk_ar   ((std::sqrt(1e0-e*e)*sinE)/ecosEm1);
+  double sq1e2   (std::sqrt(1e0-e*e));
+  double vk_ar   ((sq1e2*sinE)/ecosEm1);
   double vk_pr   ((cosE-e)/ecosEm1);
   double vk      (std::atan2(vk_ar, vk_pr));            // True Anomaly
   double cosVk   (std::cos(vk));
@@ -129,18 +131,45 @@ const noexcept
   double ik      (data__[15]+dik+data__[19]*tk);        // Corrected Inclination
                                 
   // Positions in orbital plane
-  double xk_dot  (rk*std::cos(uk));
-  double yk_dot  (rk*std::sin(uk));
+  double cosuk   (std::cos(uk));
+  double sinuk   (std::sin(uk));
+  double xk_dot  (rk*cosuk);
+  double yk_dot  (rk*sinuk);
   
   // Corrected longitude of ascending node
-  double omega_k (data__[13]+(data__[18]-OMEGAE_dot)*tk-OMEGAE_dot*data__[11]);
+  constexpr double omegae {gps_traits::broadcast_earth_rotation};
+  double omega_k (data__[13]+(data__[18]-omegae)*tk-omegae*data__[11]);
   double sinOk   (std::sin(omega_k));
   double cosOk   (std::cos(omega_k));
   double cosik   (std::cos(ik));
+  double sinik   (std::sin(ik));
   
   state[0] = xk_dot*cosOk - yk_dot*sinOk*cosik;
   state[1] = xk_dot*sinOk + yk_dot*cosOk*cosik;
-  state[2] = yk_dot*std::sin(ik);
+  state[2] = yk_dot*sinik;
+  if (!vel) return status;
+
+  // Rates of the orbital elements (IS-GPS-200H, Table 20-IV)
+  double Ek_rate (n/ecosEm1);                           // Eccentric Anomaly
+  double vk_rate (Ek_rate*sq1e2/ecosEm1);               // True Anomaly
+  double ik_rate (data__[19]
+    +2e0*vk_rate*(data__[14]*cos2F-data__[12]*sin2F));  // Inclination
+  double uk_rate (vk_rate
+    +2e0*vk_rate*(data__[9]*cos2F-data__[7]*sin2F));    // Argument of Latitude
+  double rk_rate (e*A*Ek_rate*sinE
+    +2e0*vk_rate*(data__[4]*cos2F-data__[16]*sin2F));   // Radius
+  double Ok_rate (data__[18]-omegae);                   // Longitude of
+                                                        //+ ascending node
+
+  // Velocities in orbital plane
+  double xk_rate (rk_rate*cosuk-yk_dot*uk_rate);
+  double yk_rate (rk_rate*sinuk+xk_dot*uk_rate);
+
+  vel[0] = -xk_dot*Ok_rate*sinOk + xk_rate*cosOk - yk_rate*sinOk*cosik
+           -yk_dot*(Ok_rate*cosOk*cosik - ik_rate*sinOk*sinik);
+  vel[1] =  xk_dot*Ok_rate*cosOk + xk_rate*sinOk + yk_rate*cosOk*cosik
+           -yk_dot*(Ok_rate*sinOk*cosik + ik_rate*cosOk*sinik);
+  vel[2] =  yk_rate*sinik + yk_dot*ik_rate*cosik;
 
   // all done
   return status;
@@ -185,7 +214,7 @@ const noexcept
   if (!Ein) {
     // Solve (iteratively) Kepler's equation for Ek
     double A  (data__[10]*data__[10]);     //  Semi-major axis
-    double n0 (std::sqrt(mi_gps/(A*A*A))); //  Computed mean motion (rad/sec)
+    double n0 (std::sqrt(gps_traits::broadcast_gm/(A*A*A))); //  Computed mean motion (rad/sec)
     double n  (n0+data__[5]);              //  Corrected mean motion
     double Mk (data__[6]+n*dt);            //  Mean anomaly
     double E  (Mk);
@@ -202,7 +231,7 @@ const noexcept
   }
 
   // Compute Δtr relativistic correction term (seconds)
-  const double Dtr = F_CLOCK * (data__[8]*data__[10]*std::sin(Ek));
+  const double Dtr = gps_traits::broadcast_relativistic_f * (data__[8]*data__[10]*std::sin(Ek));
 
   // Compute correction
   double Dtsv = data__[0] + data__[1]*dt + (data__[2]*dt)*dt;
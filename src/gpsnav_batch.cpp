@@ -0,0 +1,266 @@
+#include <cmath>
+#include <type_traits>
+#include <exception>
+#include "navbatch.hpp"
+
+using ngpt::GpsNavBatch;
+
+namespace
+{
+/// Constants of the GPS broadcast orbit model (WGS 84 GM, earth rotation
+/// rate, relativistic clock correction F)
+using gps_traits = ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::gps>;
+
+/// Number of Newton iterations for Kepler's equation; starting from
+/// E0 = M + e*sin(M), the error is O(e^(2^(k+1))), i.e. at machine precision
+/// for e < 0.1 after 3 iterations.
+constexpr int KEPLER_ITERATIONS {4};
+
+/// 2/pi
+constexpr double TWO_OVER_PI {6.36619772367581382433e-01};
+
+/// pi/2 split in three parts (Cody-Waite reduction); the first two have (at
+/// least) 20 trailing zero bits, so that q*PIO2_1 and q*PIO2_2 are exact for
+/// |q| < 2^20.
+constexpr double PIO2_1 {1.57079632673412561417e+00};
+constexpr double PIO2_2 {6.07710050630396597660e-11};
+constexpr double PIO2_3 {2.02226624879595063154e-21};
+
+/// Adding and subtracting this number rounds a double (|x| < 2^51) to the
+/// nearest integer
+constexpr double ROUND_MAGIC {6755399441055744e0}; // 1.5*2^52
+
+/// @brief Sine and cosine of x, for |x| < 2^20 * pi/2 (branch-free).
+///
+/// The argument is reduced to r in [-pi/4, pi/4] (x = q*pi/2 + r) and the
+/// minimax polynomials of fdlibm's __kernel_sin/__kernel_cos are used for
+/// sin(r) and cos(r); the quadrant q selects/negates the results. Accuracy
+/// is within a couple of ulps of std::sin/std::cos. Always inlined, else
+/// the calling loops cannot be vectorized.
+inline __attribute__((always_inline)) void
+__sincos__(double x, double& s, double& c) noexcept
+{
+  constexpr double S1 {-1.66666666666666324348e-01};
+  constexpr double S2 { 8.33333333332248946124e-03};
+  constexpr double S3 {-1.98412698298579493134e-04};
+  constexpr double S4 { 2.75573137070700676789e-06};
+  constexpr double S5 {-2.50507602534068634195e-08};
+  constexpr double S6 { 1.58969099521155010221e-10};
+  constexpr double C1 { 4.16666666666666019037e-02};
+  constexpr double C2 {-1.38888888888741095749e-03};
+  constexpr double C3 { 2.48015872894767294178e-05};
+  constexpr double C4 {-2.75573143513906633035e-07};
+  constexpr double C5 { 2.08757232129817482790e-09};
+  constexpr double C6 {-1.13596475577881948265e-11};
+
+  const double q = (x*TWO_OVER_PI + ROUND_MAGIC) - ROUND_MAGIC;
+  const double r = ((x - q*PIO2_1) - q*PIO2_2) - q*PIO2_3;
+  const double z = r*r;
+  const double sr = r + r*z*(S1+z*(S2+z*(S3+z*(S4+z*(S5+z*S6)))));
+  const double cr = 1e0 - 0.5e0*z + z*z*(C1+z*(C2+z*(C3+z*(C4+z*(C5+z*C6)))));
+
+  // quadrant, as k = q mod 4 in {-2,-1,0,1,2}; kept in floating point, so
+  // that no integer conversions (or calls to floor) are needed
+  const double k  = q - 4e0*((q*0.25e0 + ROUND_MAGIC) - ROUND_MAGIC);
+  const double ak = std::abs(k);
+  s = ((ak==1e0) ? cr : sr) * ((k==-1e0 || ak==2e0) ? -1e0 : 1e0);
+  c = ((ak==1e0) ? sr : cr) * ((k== 1e0 || ak==2e0) ? -1e0 : 1e0);
+}
+}// anonymous namespace
+
+/// @details Add a GPS navigation data frame; all epoch-independent
+///          quantities are computed here and stored in the parameter arrays.
+/// @param[in] frame A navigation data frame (must be GPS)
+/// @return    0 if the frame was added; 1 if the frame is not a GPS frame
+///            (nothing added); 10 if memory could not be allocated (nothing
+///            added)
+///
+/// @see NavDataFrame::gps_ecef
+int
+GpsNavBatch::add(const NavDataFrame& frame) noexcept
+{
+  if (frame.sys() != SATELLITE_SYSTEM::gps) return 1;
+
+  const double sqrtA = frame.data(10);
+  const double sma   = sqrtA*sqrtA;
+  const double e     = frame.data(8);
+  const double toe   = frame.data(11);
+  const double week  = frame.data(21);
+
+  const std::size_t n = size();
+  try {
+    __p[A].push_back(sma);
+    __p[N].push_back(std::sqrt(gps_traits::broadcast_gm/(sma*sma*sma))+frame.data(5));
+    __p[M0].push_back(frame.data(6));
+    __p[E].push_back(e);
+    __p[SQ1E2].push_back(std::sqrt(1e0-e*e));
+    __p[SINW].push_back(std::sin(frame.data(17)));
+    __p[COSW].push_back(std::cos(frame.data(17)));
+    __p[CUC].push_back(frame.data(7));
+    __p[CUS].push_back(frame.data(9));
+    __p[CRC].push_back(frame.data(16));
+    __p[CRS].push_back(frame.data(4));
+    __p[CIC].push_back(frame.data(12));
+    __p[CIS].push_back(frame.data(14));
+    __p[I0].push_back(frame.data(15));
+    __p[IDOT].push_back(frame.data(19));
+    __p[OMEGA0].push_back(frame.data(13)-gps_traits::broadcast_earth_rotation*toe);
+    __p[OMEGAD].push_back(frame.data(18)-gps_traits::broadcast_earth_rotation);
+    __p[TOE].push_back((week-__ref_week)*604800e0+toe);
+    __p[TOC].push_back(epoch(frame.toc()));
+    __p[AF0].push_back(frame.data(0));
+    __p[AF1].push_back(frame.data(1));
+    __p[AF2].push_back(frame.data(2));
+    __p[FESQA].push_back(gps_traits::broadcast_relativistic_f*e*sqrtA);
+  } catch (std::exception&) {
+    for (auto& v : __p) v.resize(n);
+    return 10;
+  }
+
+  return 0;
+}
+
+/// @details Remove all frames; the reference week is not changed.
+void
+GpsNavBatch::clear() noexcept
+{
+  for (auto& v : __p) v.clear();
+}
+
+/// @details Compute the ECEF (WGS84) coordinates of every frame at every
+///          epoch, following the IS-GPS-200H user algorithm (as in
+///          NavDataFrame::gps_ecef), and optionally the SV clock correction
+///          (as in NavDataFrame::gps_dtsv, including the relativistic term;
+///          the eccentric anomaly used is the one computed for the position,
+///          aka at t - ToE).
+///
+///          For each epoch, all frames are processed in one loop over the
+///          parameter arrays; the loop body has no branches and no calls to
+///          libm (but std::sqrt), so that it can be vectorized. Kepler's
+///          equation is solved with a fixed number of Newton iterations, the
+///          true anomaly is never computed explicitly (sines and cosines of
+///          the argument of latitude follow from angle-addition identities).
+///
+///          Results for frame i at epoch j are written at index
+///          j*size() + i of the output arrays.
+///
+/// @param[in]  t          Epochs (GPS time) in seconds since the start of
+///                        the reference week (see GpsNavBatch::epoch)
+/// @param[in]  num_epochs Number of epochs in t
+/// @param[out] x          ECEF X-component of the SV position (m); size
+///                        must be at least num_epochs*size()
+/// @param[out] y          ECEF Y-component of the SV position (m)
+/// @param[out] z          ECEF Z-component of the SV position (m)
+/// @param[out] dtsv       If not nullptr, SV clock correction in seconds
+///                        (including relativistic correction, without
+///                        TGD)
+/// @return     Always 0
+int
+GpsNavBatch::ecef(const double* t, std::size_t num_epochs, double* x,
+  double* y, double* z, double* dtsv) const noexcept
+{
+  const std::size_t n = size();
+  const double* __restrict__ pA     = __p[A].data();
+  const double* __restrict__ pN     = __p[N].data();
+  const double* __restrict__ pM0    = __p[M0].data();
+  const double* __restrict__ pE     = __p[E].data();
+  const double* __restrict__ pSQ1E2 = __p[SQ1E2].data();
+  const double* __restrict__ pSINW  = __p[SINW].data();
+  const double* __restrict__ pCOSW  = __p[COSW].data();
+  const double* __restrict__ pCUC   = __p[CUC].data();
+  const double* __restrict__ pCUS   = __p[CUS].data();
+  const double* __restrict__ pCRC   = __p[CRC].data();
+  const double* __restrict__ pCRS   = __p[CRS].data();
+  const double* __restrict__ pCIC   = __p[CIC].data();
+  const double* __restrict__ pCIS   = __p[CIS].data();
+  const double* __restrict__ pI0    = __p[I0].data();
+  const double* __restrict__ pIDOT  = __p[IDOT].data();
+  const double* __restrict__ pOM0   = __p[OMEGA0].data();
+  const double* __restrict__ pOMD   = __p[OMEGAD].data();
+  const double* __restrict__ pTOE   = __p[TOE].data();
+  const double* __restrict__ pTOC   = __p[TOC].data();
+  const double* __restrict__ pAF0   = __p[AF0].data();
+  const double* __restrict__ pAF1   = __p[AF1].data();
+  const double* __restrict__ pAF2   = __p[AF2].data();
+  const double* __restrict__ pFESQA = __p[FESQA].data();
+
+  // the kernel; clock corrections are only computed if with_clock is true
+  auto kernel = [=](auto with_clock) {
+    for (std::size_t j=0; j<num_epochs; j++) {
+      const double tj = t[j];
+      double* __restrict__ xj = x + j*n;
+      double* __restrict__ yj = y + j*n;
+      double* __restrict__ zj = z + j*n;
+      double* __restrict__ dj = decltype(with_clock)::value ? dtsv + j*n : nullptr;
+
+      // output arrays never overlap with the parameter arrays
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+      for (std::size_t i=0; i<n; i++) {
+        const double e  = pE[i];
+        const double tk = tj - pTOE[i];
+        const double Mk = pM0[i] + pN[i]*tk;
+
+        // Kepler's equation, Newton iterations
+        double sinE, cosE;
+        __sincos__(Mk, sinE, cosE);
+        double Ek = Mk + e*sinE;
+        for (int k=0; k<KEPLER_ITERATIONS; k++) {
+          __sincos__(Ek, sinE, cosE);
+          Ek -= (Ek - e*sinE - Mk) / (1e0 - e*cosE);
+        }
+        __sincos__(Ek, sinE, cosE);
+
+        // true anomaly (as sine/cosine) and argument of latitude F = v + omega
+        const double ecosEm1 = 1e0 - e*cosE;
+        const double sinv    = pSQ1E2[i]*sinE / ecosEm1;
+        const double cosv    = (cosE-e) / ecosEm1;
+        const double sinF    = sinv*pCOSW[i] + cosv*pSINW[i];
+        const double cosF    = cosv*pCOSW[i] - sinv*pSINW[i];
+        const double sin2F   = 2e0*sinF*cosF;
+        const double cos2F   = (cosF-sinF)*(cosF+sinF);
+
+        // second harmonic perturbations
+        const double duk = pCUS[i]*sin2F + pCUC[i]*cos2F;
+        const double drk = pCRS[i]*sin2F + pCRC[i]*cos2F;
+        const double dik = pCIS[i]*sin2F + pCIC[i]*cos2F;
+
+        // corrected argument of latitude, radius and inclination
+        double sindu, cosdu;
+        __sincos__(duk, sindu, cosdu);
+        const double sinu = sinF*cosdu + cosF*sindu;
+        const double cosu = cosF*cosdu - sinF*sindu;
+        const double rk   = pA[i]*ecosEm1 + drk;
+        double sini, cosi;
+        __sincos__(pI0[i] + dik + pIDOT[i]*tk, sini, cosi);
+
+        // positions in orbital plane
+        const double xk = rk*cosu;
+        const double yk = rk*sinu;
+
+        // corrected longitude of ascending node
+        double sinO, cosO;
+        __sincos__(pOM0[i] + pOMD[i]*tk, sinO, cosO);
+
+        xj[i] = xk*cosO - yk*sinO*cosi;
+        yj[i] = xk*sinO + yk*cosO*cosi;
+        zj[i] = yk*sini;
+
+        // clock correction, including the relativistic term
+        if constexpr (decltype(with_clock)::value) {
+          const double dt = tj - pTOC[i];
+          dj[i] = pAF0[i] + pAF1[i]*dt + (pAF2[i]*dt)*dt + pFESQA[i]*sinE;
+        }
+      }
+    }
+  };
+
+  if (dtsv) {
+    kernel(std::true_type{});
+  } else {
+    kernel(std::false_type{});
+  }
+
+  return 0;
+}
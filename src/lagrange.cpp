@@ -0,0 +1,88 @@
+#include "lagrange.hpp"
+
+int
+ngpt::lagrange_coefficients(double tau, int num_epochs, int order, int& first,
+  int& nodes, double* c)
+noexcept
+{
+  if (order < 1 || order > lagrange_max_order || order >= num_epochs) return 2;
+  if (!(tau >= 0e0 && tau <= num_epochs-1)) return 1;
+
+  first = static_cast<int>(tau) - order/2;
+  if (first > num_epochs-1-order) first = num_epochs-1-order;
+  if (first < 0) first = 0;
+  const double x = tau - first;
+
+  const double* w = lagrange_weights.weight[order];
+  double sum = 0e0;
+  for (int j=0; j<=order; j++) {
+    const double dx = x - j;
+    if (dx == 0e0) {
+      first += j;
+      nodes  = 1;
+      c[0]   = 1e0;
+      return 0;
+    }
+    c[j] = w[j] / dx;
+    sum += c[j];
+  }
+  const double inv = 1e0 / sum;
+  for (int j=0; j<=order; j++) c[j] *= inv;
+  nodes = order+1;
+  return 0;
+}
+
+int
+ngpt::lagrange_derivative_coefficients(double tau, int num_epochs, int order,
+  int& first, double* c, double* dc)
+noexcept
+{
+  if (order < 1 || order > lagrange_max_order || order >= num_epochs) return 2;
+  if (!(tau >= 0e0 && tau <= num_epochs-1)) return 1;
+
+  first = static_cast<int>(tau) - order/2;
+  if (first > num_epochs-1-order) first = num_epochs-1-order;
+  if (first < 0) first = 0;
+  const double x = tau - first;
+  const double* w = lagrange_weights.weight[order];
+
+  // the epoch closest to x
+  int m = static_cast<int>(x + 0.5e0);
+  if (m > order) m = order;
+
+  double r[lagrange_max_order+1];
+  if (x == m) {
+    double sum = 0e0;
+    for (int j=0; j<=order; j++) {
+      c[j] = 0e0;
+      if (j == m) continue;
+      dc[j] = (w[j]/w[m]) / (m-j);
+      sum += dc[j];
+    }
+    c[m]  = 1e0;
+    dc[m] = -sum;
+    return 0;
+  }
+
+  double sum = 0e0;
+  for (int j=0; j<=order; j++) {
+    r[j] = 1e0 / (x-j);
+    c[j] = w[j]*r[j];
+    sum += c[j];
+  }
+  const double inv = 1e0 / sum;
+  for (int j=0; j<=order; j++) c[j] *= inv;
+
+  // T = sum_{k!=m} c_k r_k and Q = sum_{k!=m} c_k
+  double T = 0e0, Q = 0e0;
+  for (int k=0; k<=order; k++) {
+    if (k == m) continue;
+    T += c[k]*r[k];
+    Q += c[k];
+  }
+  for (int j=0; j<=order; j++) {
+    dc[j] = (j == m) ? c[m]*(T - r[m]*Q)
+                     : c[j]*(T - r[j]*Q + c[m]*(r[m]-r[j]));
+  }
+  return 0;
+}
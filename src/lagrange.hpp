@@ -0,0 +1,109 @@
+#ifndef __EQUISPACED_LAGRANGE_HPP__
+#define __EQUISPACED_LAGRANGE_HPP__
+
+/// @file      lagrange.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Lagrange interpolation on equally spaced epochs (e.g. the
+///            epochs of SP3 or clock RINEX files).
+///
+/// @details   Interpolation uses the (second) barycentric form of the
+///            Lagrange polynomial. For equally spaced nodes 0, 1, ..., n the
+///            barycentric weights are w_j = (-1)^j C(n,j), independent of the
+///            spacing; they are computed once (at compile time) for all
+///            orders up to ngpt::lagrange_max_order.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+namespace ngpt
+{
+
+/// Max interpolation order (aka polynomial degree) supported
+constexpr int lagrange_max_order { 15 };
+
+/// Barycentric weights of equally spaced nodes, per order (i.e.
+/// weight[n][j] = (-1)^j C(n,j), for j in [0, n])
+struct LagrangeWeights
+{
+  double weight[lagrange_max_order+1][lagrange_max_order+1];
+};
+
+/// @brief Compute the barycentric weights for all orders
+constexpr LagrangeWeights
+make_lagrange_weights() noexcept
+{
+  LagrangeWeights t {};
+  for (int n=0; n<=lagrange_max_order; n++) {
+    double binomial = 1e0;
+    for (int j=0; j<=n; j++) {
+      t.weight[n][j] = (j%2) ? -binomial : binomial;
+      binomial = binomial*(n-j)/(j+1);
+    }
+  }
+  return t;
+}
+
+/// Barycentric weights of equally spaced nodes, for all orders
+inline constexpr LagrangeWeights lagrange_weights = make_lagrange_weights();
+
+/// @brief Interpolation window and coefficients on equally spaced epochs.
+///
+/// Find the order+1 (consecutive) epochs to interpolate from, i.e. a window
+/// centered at tau (when tau is not close to the first or last epoch), and
+/// their coefficients c_j = (w_j/(x-j)) / sum_k(w_k/(x-k)), where x is tau
+/// relative to the first epoch of the window. The interpolated value is then
+/// sum_j(c_j*f[first+j]). When tau is exactly on an epoch, the window only
+/// holds that epoch (with a coefficient of 1).
+///
+/// @param[in]  tau        Interpolation epoch, in units of the interval,
+///                        relative to the first epoch
+/// @param[in]  num_epochs Number of (equally spaced) epochs
+/// @param[in]  order      Interpolation order (in [1, lagrange_max_order])
+/// @param[out] first      Index of the first epoch of the window
+/// @param[out] nodes      Number of epochs in the window (order+1 or 1)
+/// @param[out] c          The coefficients (nodes elements; order+1 must be
+///                        writable)
+/// @return 0 on success; 1 if tau is outside [0, num_epochs-1]; 2 if the
+///         order is invalid or there are too few epochs
+int
+lagrange_coefficients(double tau, int num_epochs, int order, int& first,
+  int& nodes, double* c) noexcept;
+
+/// @brief Interpolation window, coefficients and derivative coefficients on
+///        equally spaced epochs.
+///
+/// Same as lagrange_coefficients, but the window always holds order+1
+/// epochs and the coefficients of the derivative (with respect to tau) are
+/// also computed, i.e. dc_j = c_j * sum_{k!=j} c_k (r_k - r_j), with
+/// r_k = 1/(x-k). The sums are split around the epoch m closest to x, so that
+/// no 1-c_m (or r_m, as x approaches m) cancellation occurs. When tau is
+/// exactly on an epoch m, c is the unit vector e_m and
+/// dc_j = (w_j/w_m)/(m-j), for j!=m (dc_m = -sum of the rest). The
+/// interpolated derivative is sum_j(dc_j*f[first+j]) (per interval; divide by
+/// the interval for per second).
+///
+/// @param[in]  tau        Interpolation epoch, in units of the interval,
+///                        relative to the first epoch
+/// @param[in]  num_epochs Number of (equally spaced) epochs
+/// @param[in]  order      Interpolation order (in [1, lagrange_max_order])
+/// @param[out] first      Index of the first epoch of the window
+/// @param[out] c          The coefficients (order+1 elements)
+/// @param[out] dc         The derivative coefficients (order+1 elements)
+/// @return 0 on success; 1 if tau is outside [0, num_epochs-1]; 2 if the
+///         order is invalid or there are too few epochs
+int
+lagrange_derivative_coefficients(double tau, int num_epochs, int order,
+  int& first, double* c, double* dc) noexcept;
+
+} // ngpt
+
+#endif
@@ -0,0 +1,78 @@
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mmap_file.hpp"
+
+using ngpt::MappedFile;
+
+/// @details Open the file and map all of its contents (read-only) in memory.
+///          The file descriptor is closed right after mapping; the mapping
+///          stays valid untill the instance is destroyed. An empty file is
+///          not an error; nothing is mapped (aka begin() == end()).
+/// @param[in] filename  The name of the file to map
+/// @throw std::runtime_error if the file cannot be opened or mapped
+MappedFile::MappedFile(const char* filename)
+  : __data(nullptr)
+  , __size(0)
+{
+  int fd = ::open(filename, O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("[ERROR] MappedFile::MappedFile Failed to open file "+std::string(filename));
+  }
+
+  struct stat sb;
+  if (::fstat(fd, &sb) < 0) {
+    ::close(fd);
+    throw std::runtime_error("[ERROR] MappedFile::MappedFile Failed to stat file "+std::string(filename));
+  }
+
+  if (sb.st_size > 0) {
+    void* ptr = ::mmap(nullptr, static_cast<std::size_t>(sb.st_size),
+                       PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("[ERROR] MappedFile::MappedFile Failed to map file "+std::string(filename));
+    }
+    // we are going to read the region front to back
+    ::madvise(ptr, static_cast<std::size_t>(sb.st_size), MADV_SEQUENTIAL);
+    __data = static_cast<const char*>(ptr);
+    __size = static_cast<std::size_t>(sb.st_size);
+  }
+
+  ::close(fd);
+}
+
+/// @details Unmap the region if any.
+MappedFile::~MappedFile() noexcept
+{
+  unmap();
+}
+
+/// @details Move assignment; any mapping the instance holds is released and
+///          the mapping of the input instance changes owner.
+MappedFile&
+MappedFile::operator=(MappedFile&& a) noexcept
+{
+  if (this != &a) {
+    unmap();
+    __data = a.__data;
+    __size = a.__size;
+    a.__data = nullptr;
+    a.__size = 0;
+  }
+  return *this;
+}
+
+/// @details Release the mapped region (if any) and reset the instance.
+void
+MappedFile::unmap() noexcept
+{
+  if (__data) {
+    ::munmap(const_cast<char*>(__data), __size);
+    __data = nullptr;
+    __size = 0;
+  }
+}
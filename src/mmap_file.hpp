@@ -0,0 +1,95 @@
+#ifndef __GNSS_MMAP_FILE_HPP__
+#define __GNSS_MMAP_FILE_HPP__
+
+/// @file      mmap_file.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Read-only memory mapping of (text) files.
+///
+/// @details   A MappedFile maps a whole file in (read-only) memory, so that
+///            readers can resolve records directly from the mapped region
+///            instead of copying every line via std::ifstream::getline.
+///            The mapping is released when the instance is destroyed.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <cstddef>
+
+namespace ngpt
+{
+
+/// @class MappedFile
+/// A read-only, private memory mapping of a whole file. The mapped region is
+/// not null-terminated; always use MappedFile::end() (or size()) to stop.
+class MappedFile
+{
+public:
+  /// @brief Null constructor; nothing mapped.
+  MappedFile() noexcept
+  : __data(nullptr)
+  , __size(0)
+  {};
+
+  /// @brief Constructor from filename; maps the whole file.
+  explicit
+  MappedFile(const char*);
+
+  /// @brief Destructor; unmap the region (if any).
+  ~MappedFile() noexcept;
+
+  /// @brief Copy not allowed !
+  MappedFile(const MappedFile&) = delete;
+
+  /// @brief Assignment not allowed !
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// @brief Move Constructor (the mapping changes owner).
+  MappedFile(MappedFile&& a) noexcept
+  : __data(a.__data)
+  , __size(a.__size)
+  { a.__data = nullptr; a.__size = 0; }
+
+  /// @brief Move assignment operator (the mapping changes owner).
+  MappedFile& operator=(MappedFile&& a) noexcept;
+
+  /// @brief Start of the mapped region.
+  const char*
+  begin() const noexcept
+  {return __data;}
+
+  /// @brief One-past-the-end of the mapped region.
+  const char*
+  end() const noexcept
+  {return __data+__size;}
+
+  /// @brief Size of the mapped region (aka the file) in bytes.
+  std::size_t
+  size() const noexcept
+  {return __size;}
+
+  /// @brief Check if anything is mapped.
+  bool
+  is_mapped() const noexcept
+  {return __data != nullptr;}
+
+private:
+  /// @brief Release the mapping.
+  void
+  unmap() noexcept;
+
+  const char* __data; ///< Start of mapped region
+  std::size_t __size; ///< Size of mapped region in bytes
+}; // MappedFile
+
+} // ngpt
+
+#endif
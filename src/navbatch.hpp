@@ -0,0 +1,273 @@
+#ifndef __GNSS_NAVIGATION_BATCH_HPP__
+#define __GNSS_NAVIGATION_BATCH_HPP__
+
+/// @file      navbatch.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Batch evaluation of broadcast orbits for many satellites and
+///            epochs.
+///
+/// @details   Navigation data frames are stored in Structure-of-Arrays
+///            layout (one array per orbital parameter), so that the same
+///            computation is applied to consecutive elements of plain arrays.
+///            The evaluation kernels are branch-free (fixed number of Kepler
+///            iterations, polynomial sine/cosine, no atan2) so that they can
+///            be vectorized by the compiler (e.g. -O3 -march=native for
+///            AVX2/AVX-512 targets).
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include "navrnx.hpp"
+
+namespace ngpt
+{
+
+/// @class GpsNavBatch
+/// A set of GPS navigation data frames, stored as Structure-of-Arrays, that
+/// can be evaluated at a set of epochs in one go.
+///
+/// All epochs (input and internal) are expressed as seconds since the start
+/// of a reference GPS week, given at construction. Hence, time differences
+/// (t - ToE, t - ToC) are plain subtractions, also accross week crossovers.
+///
+/// The results are compatible with NavDataFrame::gps_ecef and
+/// NavDataFrame::gps_dtsv; differences are at the sub-millimeter level.
+class GpsNavBatch
+{
+public:
+  /// @brief Constructor; set the reference GPS week.
+  explicit
+  GpsNavBatch(int ref_week=0) noexcept
+  : __ref_week(ref_week)
+  {};
+
+  /// @brief Add a (GPS) navigation data frame.
+  int
+  add(const NavDataFrame& frame) noexcept;
+
+  /// @brief Remove all frames.
+  void
+  clear() noexcept;
+
+  /// @brief Number of frames.
+  std::size_t
+  size() const noexcept
+  {return __p[0].size();}
+
+  /// @brief The reference GPS week.
+  int
+  ref_week() const noexcept
+  {return __ref_week;}
+
+  /// @brief Transform a date (GPS time) to seconds since the start of the
+  ///        reference week.
+  template<typename T>
+    double
+    epoch(const ngpt::datetime<T>& t) const noexcept
+  {return seconds_since_gps_week(t, __ref_week);}
+
+  /// @brief Compute ECEF positions (and optionally clock corrections) for
+  ///        all frames at all epochs.
+  int
+  ecef(const double* t, std::size_t num_epochs, double* x, double* y,
+    double* z, double* dtsv=nullptr) const noexcept;
+
+private:
+  /// Index of each (epoch-independent) parameter in __p
+  enum : int {
+    A,      ///< Semi-major axis (m)
+    N,      ///< Corrected mean motion (rad/sec)
+    M0,     ///< Mean anomaly at reference time (rad)
+    E,      ///< Eccentricity
+    SQ1E2,  ///< sqrt(1-e^2)
+    SINW,   ///< sin(omega), omega is the argument of perigee
+    COSW,   ///< cos(omega)
+    CUC,    ///< Cuc (rad)
+    CUS,    ///< Cus (rad)
+    CRC,    ///< Crc (m)
+    CRS,    ///< Crs (m)
+    CIC,    ///< Cic (rad)
+    CIS,    ///< Cis (rad)
+    I0,     ///< Inclination at reference time (rad)
+    IDOT,   ///< Rate of inclination (rad/sec)
+    OMEGA0, ///< OMEGA0 - OMEGAE_dot*ToE(sec of week) (rad)
+    OMEGAD, ///< OMEGADOT - OMEGAE_dot (rad/sec)
+    TOE,    ///< ToE (sec since reference week)
+    TOC,    ///< ToC (sec since reference week)
+    AF0,    ///< SV clock bias (sec)
+    AF1,    ///< SV clock drift (sec/sec)
+    AF2,    ///< SV clock drift rate (sec/sec^2)
+    FESQA,  ///< F*e*sqrt(A), for the relativistic clock correction (sec)
+    NUM_PARAMS
+  };
+
+  int                                          __ref_week; ///< Reference week
+  std::array<std::vector<double>, NUM_PARAMS>  __p;        ///< Parameters
+}; // GpsNavBatch
+
+/// @class GloNavBatch
+/// A set of GLONASS navigation data frames (e.g. one per satellite of the
+/// constellation), stored as Structure-of-Arrays, that can be propagated to
+/// an epoch in one go.
+///
+/// All epochs (input and internal) are expressed as seconds (UTC) since the
+/// start of a reference day (MJD), given at construction.
+///
+/// The state vectors of all frames are integrated simultaneously with the
+/// Runge-Kutta 4 scheme and the equations of motion of
+/// NavDataFrame::glo_ecef (GLONASS ICD, Appendix J.2); every frame takes the
+/// same number of steps, so that each Runge-Kutta stage is one (vectorizable)
+/// loop over all frames. The step of each frame is t-tb divided by the number
+/// of steps, which is chosen so that no step exceeds 60 sec. Results are
+/// compatible with NavDataFrame::glo_ecef at the sub-millimeter level.
+///
+/// The integration workspace is a member, sized as frames are added, so that
+/// GloNavBatch::ecef does not allocate; hence, GloNavBatch::ecef is not const
+/// and an instance must not be propagated by more than one thread at a time.
+class GloNavBatch
+{
+public:
+  /// @brief Constructor; set the reference day (MJD).
+  explicit
+  GloNavBatch(long ref_mjd=0) noexcept
+  : __ref_mjd(ref_mjd)
+  {};
+
+  /// @brief Add a (GLONASS) navigation data frame.
+  int
+  add(const NavDataFrame& frame) noexcept;
+
+  /// @brief Remove all frames.
+  void
+  clear() noexcept;
+
+  /// @brief Number of frames.
+  std::size_t
+  size() const noexcept
+  {return __p[0].size();}
+
+  /// @brief The reference day (MJD).
+  long
+  ref_mjd() const noexcept
+  {return __ref_mjd;}
+
+  /// @brief Transform a date (UTC) to seconds since the start of the
+  ///        reference day.
+  template<typename T>
+    double
+    epoch(const ngpt::datetime<T>& t) const noexcept
+  {
+    const long days = t.mjd().as_underlying_type() - __ref_mjd;
+    return static_cast<double>(days)*86400e0 + t.sec().to_fractional_seconds();
+  }
+
+  /// @brief Compute ECEF (PZ-90) state vectors (and optionally clock
+  ///        corrections) for all frames at an epoch.
+  int
+  ecef(double t, double* state, double* dtsv=nullptr) noexcept;
+
+private:
+  /// Index of each parameter in __p; the first six are the state vector at
+  /// tb, in the order of the state vectors passed to glo_state_deriv_batch
+  enum : int {
+    X, Y, Z,    ///< Position at tb (m)
+    VX, VY, VZ, ///< Velocity at tb (m/sec)
+    AX, AY, AZ, ///< Lunisolar acceleration (m/sec^2)
+    TB,         ///< tb (sec since reference day)
+    TAU,        ///< SV clock bias (sec), aka -TauN
+    GAMMA,      ///< SV relative frequency bias, aka +GammaN
+    NUM_PARAMS
+  };
+
+  /// Size of the workspace per frame: step/2 and step/6, accelerations, 4
+  /// stages and the intermediate state vector
+  static constexpr std::size_t WORK_PER_FRAME { 2 + 3 + 5*6 };
+
+  long                                         __ref_mjd; ///< Reference day
+  std::array<std::vector<double>, NUM_PARAMS>  __p;       ///< Parameters
+  std::vector<double>                          __work;    ///< Workspace of
+                                                          ///< ecef
+}; // GloNavBatch
+
+/// @class SbasNavBatch
+/// A set of SBAS navigation data frames (e.g. one per GEO satellite), stored
+/// as Structure-of-Arrays, that can be propagated to an epoch in one go.
+///
+/// All epochs (input and internal) are expressed as seconds (GPS time) since
+/// the start of a reference GPS week, given at construction.
+///
+/// The state vectors of all frames are propagated with the second order
+/// (Taylor) expansion of NavDataFrame::sbas_ecef; the messages are valid for
+/// a few minutes only, so no integration is needed and each component is
+/// one (vectorizable) loop over all frames. Results are identical to
+/// NavDataFrame::sbas_ecef and NavDataFrame::sbas_dtsv.
+class SbasNavBatch
+{
+public:
+  /// @brief Constructor; set the reference GPS week.
+  explicit
+  SbasNavBatch(int ref_week=0) noexcept
+  : __ref_week(ref_week)
+  {};
+
+  /// @brief Add an (SBAS) navigation data frame.
+  int
+  add(const NavDataFrame& frame) noexcept;
+
+  /// @brief Remove all frames.
+  void
+  clear() noexcept;
+
+  /// @brief Number of frames.
+  std::size_t
+  size() const noexcept
+  {return __p[0].size();}
+
+  /// @brief The reference GPS week.
+  int
+  ref_week() const noexcept
+  {return __ref_week;}
+
+  /// @brief Transform a date (GPS time) to seconds since the start of the
+  ///        reference week.
+  template<typename T>
+    double
+    epoch(const ngpt::datetime<T>& t) const noexcept
+  {return seconds_since_gps_week(t, __ref_week);}
+
+  /// @brief Compute ECEF state vectors (and optionally clock corrections)
+  ///        for all frames at an epoch.
+  int
+  ecef(double t, double* state, double* dtsv=nullptr) const noexcept;
+
+private:
+  /// Index of each parameter in __p
+  enum : int {
+    X, Y, Z,    ///< Position at ToC (m)
+    VX, VY, VZ, ///< Velocity at ToC (m/sec)
+    AX, AY, AZ, ///< Acceleration (m/sec^2)
+    TOC,        ///< ToC (sec since reference week)
+    AGF0,       ///< SV clock bias (sec)
+    AGF1,       ///< SV relative frequency bias (sec/sec)
+    NUM_PARAMS
+  };
+
+  int                                          __ref_week; ///< Reference week
+  std::array<std::vector<double>, NUM_PARAMS>  __p;        ///< Parameters
+}; // SbasNavBatch
+
+} // ngpt
+
+#endif
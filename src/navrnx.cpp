@@ -3,7 +3,9 @@
 #include <cstring>
 #include <stdexcept>
 #include <cerrno>
+#include <thread>
 #include "navrnx.hpp"
+#include "rinex.hpp"
 #include "ggdatetime/datetime_read.hpp"
 
 using ngpt::NavDataFrame;
@@ -64,98 +66,108 @@ noexcept
   return lines_to_read;
 }
 
-/// @brief Replace all occurancies of 'D' or 'd' with 'E' in given c-string.
-/// @param[in] line A c-string; the replacement will happen 'in-place' so at
-///                 exit the string may be different.
-inline void
-__for2cpp__(char* line) noexcept
+/// @details Resolve a double, written in (at most) M characters (i.e. in the
+///          format D19.x as in RINEX 3.x). 'D', 'd' or 'E' exponents are
+///          accepted as is; the line is not modified and the conversion
+///          never reads past the field or the line (which may not be
+///          null-terminated, e.g. when memory-mapped).
+/// @param[in]  field Start of the field
+/// @param[in]  eol   End of the line the field belongs to (one-past-the-last
+///                   character of the line)
+/// @param[out] val   The resolved double
+/// @return  True if the number was resolved and assigned; false otherwise
+/// @see ngpt::rinex::fixed_width_to_double
+template<int M>
+  inline bool
+  __field2double__(const char* field, const char* eol, double& val) noexcept
 {
-  char* c = line;
-  while (*c) {
-    if (*c == 'D' || *c == 'd') *c = 'E';
-    ++c;
-  }
-  return;
+  const int sz = (eol-field < M) ? static_cast<int>(eol-field) : M;
+  if (sz <= 0) return false;
+  return ngpt::rinex::fixed_width_to_double(field, sz, val);
 }
 
 /// @details Resolve a string of N doubles, written with M digits (i.e. in the
 ///          format N*D19.x as in RINEX 3.x) and asigne them to data[0,N).
-/// @param[in]  line  A c-string containing N doubles written with M digits
+/// @param[in]  line  A string containing N doubles written with M digits
+/// @param[in]  eol   End of the line (one-past-the-last character)
 /// @param[out] data  An array of (at least) N-1 elements; the resolved doubles
 ///                   will be written in data[0]...data[N-1]
 /// @return  True if all numbers were resolved and assigned; false otherwise
-/// @warning The function will check 'errno'. Be sure that it is 0 at input. If
-///          an error occurs in the function call, it may be set to !=0, so be
-///          sure to clear it (aka 'errno') after exit.
 template<int N, int M>
   inline bool
-  __char2double__(const char* line, double* data) noexcept
+  __char2double__(const char* line, const char* eol, double* data) noexcept
 {
-  char* end;
+  // whole line available; resolve all fields in one go
+  if (eol-line >= N*M) {
+    return ngpt::rinex::fixed_width_to_doubles<N,M>(line, data);
+  }
   for (int i=0; i<N; i++) {
-    data[i] = std::strtod(line, &end);
-    if (line == end) return false;
+    if (!__field2double__<M>(line, eol, data[i])) return false;
     line+=M;
   }
-  return (errno) ? false : true;
+  return true;
 }
 
 /// @details Resolve a string of N doubles, written with M digits (i.e. in the
 ///          format N*D19.x as in RINEX 3.x) and asigne them to data[0,N).
-/// @param[in]  line  A c-string containing N doubles written with M digits
+/// @param[in]  line  A string containing N doubles written with M digits
+/// @param[in]  eol   End of the line (one-past-the-last character)
 /// @param[out] data  An array of (at least) N-1 elements; the resolved doubles
 ///                   will be written in data[0]...data[N-1]
 /// @return  True if all numbers were resolved and assigned; false otherwise
-/// @warning The function will check 'errno'. Be sure that it is 0 at input. If
-///          an error occurs in the function call, it may be set to !=0, so be
-///          sure to clear it (aka 'errno') after exit.
 /// @note exactly the same as the template version, only we don't know how many
 /// doubles we are resolving at compile time.
 template<int M>
   inline bool
-  __char2double__(const char* line, double* data, int N) noexcept
+  __char2double__(const char* line, const char* eol, double* data, int N)
+  noexcept
 {
-  char* end;
   for (int i=0; i<N; i++) {
-    data[i] = std::strtod(line, &end);
-    if (line == end) return false;
+    if (!__field2double__<M>(line, eol, data[i])) return false;
     line+=M;
   }
-  return (errno) ? false : true;
+  return true;
 }
 
 /// @details: Resolve a Nav. RINEX v3.x data block to a NavDataFrame. The
-///           function expect that the first line to be read is:
+///           first line to be provided by the line source is:
 ///           "SV/ EPOCH / SV CLK". Depending on the satellite system (to be
 ///           resolved from the first line) it will read the respective number
 ///           of lines and resolve them.
-/// @param[in] inp Input file (nav RINEX v3) stream, placed before (aka first
-///                line to be read is:) "SV/ EPOCH / SV CLK"
+/// @param[in] next_line A callable with signature
+///                bool(const char*& bol, const char*& eol), providing the
+///                next line to resolve (start and one-past-the-end); it
+///                should return false if no line can be provided.
 /// @return    Anything other than 0 denotes an error.
-/// @todo the line toc__ = ngpt::strptime_ymd_hms<ngpt::seconds>(line+3); may
-/// throw! what can i do about this?
-int
-NavDataFrame::set_from_rnx3(std::ifstream& inp) noexcept
+template<typename F>
+  int
+  NavDataFrame::__set_from_rnx3__(F&& next_line) noexcept
 {
-  char line[MAX_RECORD_CHARS];
+  const char *line, *eol;
   char* str_end;
 
   // Read the first line.
   // ------------------------------------------------------------
-  if (!inp.getline(line, MAX_RECORD_CHARS)) {
+  if (!next_line(line, eol)) {
     return 1;
   }
-  sys__ = ngpt::char_to_satsys(*line);
-  toc__ = ngpt::strptime_ymd_hms<ngpt::seconds>(line+3);
+  if (eol-line < 23) return 2;
+  try {
+    sys__ = ngpt::char_to_satsys(*line);
+    toc__ = ngpt::strptime_ymd_hms<ngpt::seconds>(line+3);
+  } catch (std::exception&) {
+    return 2;
+  }
   prn__ = std::strtol(line+1, &str_end, 10);
   if (!prn__ || errno == ERANGE) {
     errno = 0;
     return 2;
   }
-  // replace 'D' or 'd' with 'e' in remaining floats
-  __for2cpp__(line+23);
-  if (!__char2double__<3,19>(line+23, data__)) {
-    errno = 0;
+  // slots not present in this block (e.g. the spare records) must not hold
+  // values from any previously resolved block
+  std::memset(data__, 0, sizeof(data__));
+  // resolve remaining floats
+  if (!__char2double__<3,19>(line+23, eol, data__)) {
     return 3;
   }
 
@@ -168,33 +180,26 @@ NavDataFrame::set_from_rnx3(std::ifstream& inp) noexcept
   // read all but the last line (** all but galileo or beidou **)
   if (sys__ != SATELLITE_SYSTEM::galileo && sys__ != SATELLITE_SYSTEM::beidou) {
     for (ln=0; ln<lines_in_block-1; ln++) {
-      if (!inp.getline(line, MAX_RECORD_CHARS)) {
+      if (!next_line(line, eol)) {
         return 5;
       }
-      // replace 'D' or 'd' with 'e'
-      __for2cpp__(line);
       // read 4 doubles into data__
-      if (!__char2double__<4,19>(line+4, data__+3+ln*4)) {
-        errno = 0;
+      if (!__char2double__<4,19>(line+4, eol, data__+3+ln*4)) {
         return 6;
       }
     }
   } else { // galileo and beidou have an empty record in line #5
     for (ln=0; ln<lines_in_block-1; ln++) {
-      if (!inp.getline(line, MAX_RECORD_CHARS)) {
+      if (!next_line(line, eol)) {
         return 5;
       }
-      // replace 'D' or 'd' with 'e'
-      __for2cpp__(line);
       // read 4 doubles into data__
       if (ln!=4) {
-        if (!__char2double__<4,19>(line+4, data__+3+ln*4)) {
-          errno = 0;
+        if (!__char2double__<4,19>(line+4, eol, data__+3+ln*4)) {
           return 6;
         }
       } else {
-        if (!__char2double__<3,19>(line+4, data__+3+ln*4)) {
-          errno = 0;
+        if (!__char2double__<3,19>(line+4, eol, data__+3+ln*4)) {
           return 6;
         }
       }
@@ -202,44 +207,89 @@ NavDataFrame::set_from_rnx3(std::ifstream& inp) noexcept
   }
 
   // read last line
-  if (!inp.getline(line, MAX_RECORD_CHARS)) {
+  if (!next_line(line, eol)) {
     return 7;
   }
-  // replace 'D' or 'd' with 'e'
-  __for2cpp__(line);
   // read remaining last_line_recs doubles into data__
-  if (!__char2double__<19>(line+4, data__+3+ln*4, last_line_recs)) {
-    errno = 0;
+  if (!__char2double__<19>(line+4, eol, data__+3+ln*4, last_line_recs)) {
     return 8;
   }
 
-  // If we read a GLONASS navigation frame, convert SV state vector to meters
-  // (originaly in km)
-  if (sys__ == SATELLITE_SYSTEM::glonass) {
+  // If we read a GLONASS or SBAS navigation frame, convert SV state vector to
+  // meters (originaly in km)
+  if (sys__ == SATELLITE_SYSTEM::glonass || sys__ == SATELLITE_SYSTEM::sbas) {
     for (int i : {3,4,5,7,8,9,11,12,13}) data__[i]*=1e3;
   }
 
   return 0;
 }
 
+/// @details: Resolve a Nav. RINEX v3.x data block to a NavDataFrame. The
+///           function expect that the first line to be read is:
+///           "SV/ EPOCH / SV CLK". Depending on the satellite system (to be
+///           resolved from the first line) it will read the respective number
+///           of lines and resolve them.
+/// @param[in] inp Input file (nav RINEX v3) stream, placed before (aka first
+///                line to be read is:) "SV/ EPOCH / SV CLK"
+/// @return    Anything other than 0 denotes an error.
+int
+NavDataFrame::set_from_rnx3(std::ifstream& inp) noexcept
+{
+  char line[MAX_RECORD_CHARS];
+  return __set_from_rnx3__([&](const char*& bol, const char*& eol) -> bool {
+    if (!inp.getline(line, MAX_RECORD_CHARS)) return false;
+    bol = line;
+    eol = line + std::strlen(line);
+    return true;
+  });
+}
+
+/// @details: Resolve a Nav. RINEX v3.x data block held in memory (e.g. a 
+///           memory-mapped file) to a NavDataFrame. No line is copied; the
+///           block is resolved directly from the buffer.
+/// @param[in,out] buf At input, the start of the line "SV/ EPOCH / SV CLK";
+///                    at output (if no error occurs) the start of the line
+///                    following the block.
+/// @param[in] end     End of the buffer (one-past-the-last character)
+/// @return    Anything other than 0 denotes an error.
+int
+NavDataFrame::set_from_rnx3(const char*& buf, const char* end) noexcept
+{
+  return __set_from_rnx3__([&](const char*& bol, const char*& eol) -> bool {
+    return ngpt::rinex::next_line(buf, end, bol, eol);
+  });
+}
+
 /// @details NavigationRnx constructor, using a filename. The constructor will
 ///          initialize (set) the _filename attribute and also (try to)
 ///          open the input stream (i.e. _istream).
 ///          If the file is successefuly opened, the constructor will read
 ///          the header and assign info.
-/// @param[in] filename  The filename of the Rinex file
-NavigationRnx::NavigationRnx(const char* filename)
+///          If memory_map is set, the whole file is mapped in memory after
+///          the header is read and all data blocks are resolved directly from
+///          the mapped region (no per-line copies); the input stream is then
+///          closed.
+/// @param[in] filename   The filename of the Rinex file
+/// @param[in] memory_map Read data blocks from a memory-mapped file
+NavigationRnx::NavigationRnx(const char* filename, bool memory_map)
   : __filename   (filename)
   , __istream    (filename, std::ios_base::in)
   , __satsys     (SATELLITE_SYSTEM::mixed)
   , __version    (0e0)
   , __end_of_head(0)
+  , __mmap       ()
+  , __mcur       (nullptr)
 {
   int j;
   if ((j=read_header())) {
       if (__istream.is_open()) __istream.close();
       throw std::runtime_error("[ERROR] Failed to read (nav) RINEX header; Error Code: "+std::to_string(j));
   }
+  if (memory_map) {
+    __istream.close();
+    __mmap = MappedFile(filename);
+    __mcur = __mmap.begin() + static_cast<std::streamoff>(__end_of_head);
+  }
 }
 
 /// Read a RINEX Navigation v3.x header and assign vital information.
@@ -299,6 +349,11 @@ NavigationRnx::read_header() noexcept
 int
 NavigationRnx::read_next_record(NavDataFrame& nav) noexcept
 {
+  if (__mmap.is_mapped()) {
+    if (__mcur < __mmap.end()) return nav.set_from_rnx3(__mcur, __mmap.end());
+    return -1;
+  }
+
   int c;
   if ( (c=__istream.peek()) != EOF ) {
     return nav.set_from_rnx3(__istream);
@@ -322,7 +377,9 @@ NavigationRnx::read_next_record(NavDataFrame& nav) noexcept
 int
 NavigationRnx::ignore_next_block() noexcept
 {
-  char s = __istream.peek();
+  char s = __mmap.is_mapped()
+    ? ((__mcur < __mmap.end()) ? *__mcur : EOF)
+    : __istream.peek();
   if (s == EOF) {
     __istream.clear();
     return -1;
@@ -335,9 +392,19 @@ NavigationRnx::ignore_next_block() noexcept
     return 1;
   }
 
-  char line[MAX_RECORD_CHARS];
   int last_line_recs = 0;
   int lines_in_block = __lines_per_satsys_v3__(sys, last_line_recs);
+  if (__mmap.is_mapped()) {
+    const char *bol, *eol;
+    for (int ln=0; ln<lines_in_block; ln++) {
+      if (!ngpt::rinex::next_line(__mcur, __mmap.end(), bol, eol)) {
+        return 2;
+      }
+    }
+    return 0;
+  }
+
+  char line[MAX_RECORD_CHARS];
   // read and skip lines
   for (int ln=0; ln<lines_in_block; ln++) {
     if (!__istream.getline(line, MAX_RECORD_CHARS)) {
@@ -358,7 +425,9 @@ ngpt::SATELLITE_SYSTEM
 NavigationRnx::peak_satsys(int& status) noexcept
 {
   status = 0 ;
-  char s = __istream.peek();
+  char s = __mmap.is_mapped()
+    ? ((__mcur < __mmap.end()) ? *__mcur : EOF)
+    : __istream.peek();
   if (s == EOF) {
     status = -1;
     return SATELLITE_SYSTEM::mixed;
@@ -372,10 +441,183 @@ NavigationRnx::peak_satsys(int& status) noexcept
   }
 }
 
-/// @details Set the nav RINEX stream to end of header, ready to restart
-///          reading nav data blocks
+/// @details Set the nav RINEX stream (or the position in the memory-mapped
+///          file) to end of header, ready to restart reading nav data blocks
 void
 NavigationRnx::rewind() noexcept
 {
+  if (__mmap.is_mapped()) {
+    __mcur = __mmap.begin() + static_cast<std::streamoff>(__end_of_head);
+    return;
+  }
   __istream.seekg(__end_of_head);
 }
+
+/// @details Given any position in the data section of a (memory-mapped)
+///          nav. RINEX v3.x file, find the start of the next data block. In
+///          RINEX v3.x, the first line of each block starts with the satellite
+///          system identifier, while all following lines start with 4 blanks
+///          (format 4X,4D19.12); hence a block starts at the first line not
+///          starting with a whitespace.
+/// @param[in] pos  Any position in the data section (but not its first
+///                 character)
+/// @param[in] end  End of the buffer
+/// @return    The start of the first block starting at or after pos (or end)
+static const char*
+__next_block_start__(const char* pos, const char* end) noexcept
+{
+  const char *bol, *eol;
+  // move to the start of the line at or after pos
+  --pos;
+  ngpt::rinex::next_line(pos, end, bol, eol);
+  while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r')) {
+    ngpt::rinex::next_line(pos, end, bol, eol);
+  }
+  return pos;
+}
+
+/// @details Resolve all data blocks in the buffer [start, stop).
+/// @param[in]  start  Start of the first data block
+/// @param[in]  stop   End of the last data block
+/// @param[out] frames Resolved data frames are appended here
+/// @return     0 if all blocks were resolved; else the error code of the
+///             first block that failed (frames holds all blocks before it)
+/// @throw      std::bad_alloc if frames cannot grow (the caller catches it)
+static int
+__resolve_blocks__(const char* start, const char* stop,
+  std::vector<NavDataFrame>& frames)
+{
+  NavDataFrame block;
+  int status = 0;
+  while (start < stop) {
+    if ((status = block.set_from_rnx3(start, stop))) return status;
+    frames.push_back(block);
+  }
+  return 0;
+}
+
+/// @details Read and resolve all data blocks (after the header) of the file.
+///          If the instance reads from a memory-mapped file, the data section
+///          is split in (about) equally sized chunks, aligned at block
+///          boundaries (see __next_block_start__), which are resolved in
+///          parallel, each on its own thread. The resolved chunks are then
+///          merged in file order, so that frames hold exactly what successive
+///          calls to read_next_record would return. If the file is not
+///          memory-mapped, the blocks are read sequentially from the stream.
+///          In any case, the current position of the instance in the file is
+///          not changed.
+/// @param[out] frames      All data blocks in the file (in file order); any
+///                         elements it holds at input are removed.
+/// @param[in]  num_threads Number of threads to use; if <= 0 the number of
+///                         concurrent threads supported by the hardware is
+///                         used.
+/// @return     0 if all blocks were resolved; else the error code of the
+///             first block that failed to resolve (frames holds all blocks
+///             before it); 10 if memory could not be allocated (frames is
+///             empty). Failure to spawn threads is not an error; the
+///             remaining chunks are resolved on the calling thread.
+int
+NavigationRnx::read_all_records(std::vector<NavDataFrame>& frames,
+  int num_threads) noexcept
+{
+  frames.clear();
+  try {
+    return __read_all_records__(frames, num_threads);
+  } catch (std::exception&) {
+    frames.clear();
+    return 10;
+  }
+}
+
+/// @details Implementation of NavigationRnx::read_all_records; may throw
+///          (std::bad_alloc) on allocation failure. Threads (if any) are
+///          always joined before returning (or throwing), and exceptions
+///          thrown within a worker are caught and reported as status 10.
+int
+NavigationRnx::__read_all_records__(std::vector<NavDataFrame>& frames,
+  int num_threads)
+{
+
+  // not memory-mapped; sequential read from the stream
+  if (!__mmap.is_mapped()) {
+    auto pos = __istream.tellg();
+    __istream.seekg(__end_of_head);
+    NavDataFrame block;
+    int status;
+    while (!(status = read_next_record(block))) frames.push_back(block);
+    __istream.clear();
+    __istream.seekg(pos);
+    return (status < 0) ? 0 : status;
+  }
+
+  const char* start = __mmap.begin() + static_cast<std::streamoff>(__end_of_head);
+  const char* stop  = __mmap.end();
+  
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads <= 0) num_threads = 1;
+  }
+  // keep chunks large enough (~100 blocks) to amortize thread creation
+  constexpr std::ptrdiff_t min_chunk_size { 64*MAX_RECORD_CHARS*8 };
+  if ((stop-start)/num_threads < min_chunk_size) {
+    num_threads = static_cast<int>((stop-start)/min_chunk_size);
+    if (num_threads <= 0) num_threads = 1;
+  }
+
+  // chunk limits, aligned to block starts
+  std::vector<const char*> limits (num_threads+1);
+  limits[0] = start;
+  limits[num_threads] = stop;
+  const std::ptrdiff_t chunk_size = (stop-start)/num_threads;
+  for (int i=1; i<num_threads; i++) {
+    const char* pos = start + i*chunk_size;
+    if (pos < limits[i-1]) pos = limits[i-1];
+    limits[i] = __next_block_start__(pos, stop);
+  }
+
+  // resolve each chunk in its own vector; the first chunk is resolved
+  // directly in frames (reserved for the whole file), so that only the
+  // following chunks are copied when merging
+  std::vector<std::vector<NavDataFrame>> chunks (num_threads);
+  std::vector<int> status (num_threads, 0);
+  auto worker = [&](int i) noexcept {
+    std::vector<NavDataFrame>& out = i ? chunks[i] : frames;
+    try {
+      out.reserve((limits[i ? i+1 : num_threads]-limits[i])/(4*80));
+      status[i] = __resolve_blocks__(limits[i], limits[i+1], out);
+    } catch (std::exception&) {
+      status[i] = 10;
+    }
+  };
+  if (num_threads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> pool;
+    pool.reserve(num_threads-1);
+    try {
+      for (int i=1; i<num_threads; i++) pool.emplace_back(worker, i);
+    } catch (std::exception&) {
+      // failed to spawn thread(s); resolve the remaining chunks here
+      for (int i=static_cast<int>(pool.size())+1; i<num_threads; i++) {
+        worker(i);
+      }
+    }
+    worker(0);
+    for (auto& t : pool) t.join();
+  }
+
+  // merge in file order, stopping at the first error
+  for (int i=0; i<num_threads; i++) {
+    if (status[i] == 10) {
+      frames.clear();
+      return 10;
+    }
+  }
+  if (status[0]) return status[0];
+  for (int i=1; i<num_threads; i++) {
+    frames.insert(frames.end(), chunks[i].begin(), chunks[i].end());
+    if (status[i]) return status[i];
+  }
+
+  return 0;
+}
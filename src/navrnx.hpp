@@ -2,8 +2,10 @@
 #define __NAVIGATION_RINEX_HPP__
 
 #include <fstream>
+#include <vector>
 #include "ggdatetime/dtcalendar.hpp"
 #include "satsys.hpp"
+#include "mmap_file.hpp"
 #ifdef DEBUG
 #include "ggdatetime/datetime_write.hpp"
 #endif
@@ -11,6 +13,40 @@
 namespace ngpt
 {
 
+/// @brief Seconds since the start of a given GPS week.
+/// @param[in] t    A date in GPS time
+/// @param[in] week The reference GPS week
+/// @return    Seconds from the start of week to t (may be negative or larger
+///            than the seconds in a week, if t is in another week)
+template<typename T>
+  double
+  seconds_since_gps_week(const ngpt::datetime<T>& t, int week) noexcept
+{
+  constexpr long gps_mjd0 { 44244L }; // MJD of GPS week 0, day 0
+  const long days = t.mjd().as_underlying_type() - gps_mjd0 - 7L*week;
+  return static_cast<double>(days)*86400e0 + t.sec().to_fractional_seconds();
+}
+
+/// Max interval (sec) between an epoch and the ToC of an SBAS GEO navigation
+/// message; the (en-route) time-out of the message (RTCA DO-229)
+constexpr double sbas_max_interval {360e0};
+
+/// @brief Integrators available for GLONASS broadcast orbit propagation.
+///
+/// rk4    : classic Runge-Kutta 4, fixed step of 60 sec (the ICD choice)
+/// dopri5 : embedded Runge-Kutta 5(4) of Dormand and Prince, with step size
+///          (error) control
+enum class GloIntegrator : char
+{ rk4, dopri5 };
+
+/// @brief Cost of a GLONASS orbit propagation (one call).
+struct GloIntegrationStats
+{
+  int steps{0};       ///< Accepted integration steps
+  int rejected{0};    ///< Rejected steps (adaptive integrators only)
+  int derivatives{0}; ///< Evaluations of the equations of motion
+};
+
 /// QZSS:       data__[0]  : Time of Clock
 ///             data__[0]  : SV clock bias in seconds
 ///             data__[1]  : SV clock drift in m/sec
@@ -34,11 +70,21 @@ namespace ngpt
 ///             data__[1]  : SV relative frequency bias, aka aGf1
 ///             data__[2]  : Transmission time of message (start of the 
 ///                          message) in GPS seconds of the week
-///             data__[x]  : Satellite position X (km)
-///             data__[x]  : velocity X dot (km/sec)
-///             data__[x]  : X acceleration (km/sec2)
-///             data__[x]  : Health:SBAS:See Section 8.3.3 bit mask for:
+///             data__[3]  : Satellite position X (km)
+///             data__[4]  : velocity X dot (km/sec)
+///             data__[5]  : X acceleration (km/sec2)
+///             data__[6]  : Health:SBAS:See Section 8.3.3 bit mask for:
 ///                          health, health availability and User Range Accuracy. 
+///             data__[7]  : Satellite position Y (km)
+///             data__[8]  : velocity Y dot (km/sec)
+///             data__[9]  : Y acceleration (km/sec2)
+///             data__[10] : Accuracy code (URA, meters)
+///             data__[11] : Satellite position Z (km)
+///             data__[12] : velocity Z dot (km/sec)
+///             data__[13] : Z acceleration (km/sec2)
+///             data__[14] : IODN (Issue of Data Navigation)
+///             (position, velocity and acceleration components are converted
+///             to meters when the block is resolved, as for GLONASS)
 /// IRNSS:      data__[0]  : Time of Clock in IRNSS time
 ///             data__[0]  : SV clock bias in seconds
 ///             data__[1]  : SV clock drift in m/sec
@@ -59,10 +105,16 @@ public:
   int
   set_from_rnx3(std::ifstream& inp) noexcept;
   
-  /// @brief get SV coordinates (WGS84) from navigation block
-  /// see IS-GPS-200H, User Algorithm for Ephemeris Determination
+  /// @brief Set from a RINEX 3.x navigation data block held in memory
+  int
+  set_from_rnx3(const char*& buf, const char* end) noexcept;
+  
+  /// @brief get SV coordinates (and optionally velocity) (WGS84) from
+  /// navigation block; see IS-GPS-200H, User Algorithm for Ephemeris
+  /// Determination
   int
-  gps_ecef(double toe_sec, double t_sec, double* state, double* Ek=nullptr)
+  gps_ecef(double toe_sec, double t_sec, double* state, double* Ek=nullptr,
+    double* vel=nullptr)
   const noexcept;
 
   template<typename T>
@@ -78,20 +130,42 @@ public:
   glo_tb2date(bool to_MT) const noexcept;
 
   int
-  glo_ecef(double t_insod, double tb_sod, double* state)
+  glo_ecef(double t_insod, double tb_sod, double* state,
+    GloIntegrator integrator=GloIntegrator::rk4,
+    GloIntegrationStats* stats=nullptr)
   const noexcept;
   int
-  glo_ecef2(double t_insod, double tb_sod, double& x, double& y, double& z, double* vel=nullptr)
+  glo_ecef2(double t_insod, double tb_sod, double& x, double& y, double& z, double* vel=nullptr,
+    GloIntegrator integrator=GloIntegrator::rk4,
+    GloIntegrationStats* stats=nullptr)
   const noexcept;
   
   int
   gps_dtsv(double dt, double& dt_sv, double* Ek_in=nullptr) const noexcept;
   int
   glo_dtsv(double t_tm, double toe_tm, double& dtsv) const noexcept;
+
+  /// @brief SBAS SV state vector (ECEF) from the navigation block, dt seconds
+  ///        after ToC
+  int
+  sbas_ecef(double dt, double* state) const noexcept;
+
+  /// @brief SBAS SV clock correction, dt seconds after ToC
+  int
+  sbas_dtsv(double dt, double& dtsv) const noexcept;
   
+  /// @brief GPS SV position (and optionally velocity) in WGS84 and clock
+  ///        correction at epoch t (GPS Time)
+  /// @param[in]  t     Epoch in GPS Time
+  /// @param[out] state Array of length >=3; SV x,y,z (meters)
+  /// @param[out] dt    SV clock correction (seconds)
+  /// @param[out] vel   If not nullptr, array of length >=3; SV vx,vy,vz
+  ///                   (meters/sec)
+  /// @return Anything other than 0 denotes an error
   template<typename T>
     int
-    gps_stateNclock(ngpt::datetime<T> t, double* state, double& dt)
+    gps_stateNclock(ngpt::datetime<T> t, double* state, double& dt,
+      double* vel=nullptr)
     const noexcept
   {
     int status = 0;
@@ -105,7 +179,7 @@ public:
     } else if (t.mjd()<toe.mjd()) {
       t_sec = t_sec - 86400e0;
     }
-    if ( (status=gps_ecef(toe_sec, t_sec, state)) ) return status;
+    if ( (status=gps_ecef(toe_sec, t_sec, state, nullptr, vel)) ) return status;
     // dt from ToC
     auto   dt_ = ngpt::delta_sec(t, toc__);
     double dti = dt_.to_fractional_seconds();
@@ -117,16 +191,22 @@ public:
   ///        epoch epoch using the simplified algorithm
   /// @param[in] epoch The time in UTC for which we want the SV state
   /// @param[out] The SV centre of mass state vector in meters, meters/sec
+  /// @param[in] integrator Integrator used to propagate the state vector
+  /// @param[out] stats If not nullptr, the cost of the propagation
   template<typename T>
     int
-    glo_stateNclock(ngpt::datetime<T> t, double* state, double& dt)
+    glo_stateNclock(ngpt::datetime<T> t, double* state, double& dt,
+      GloIntegrator integrator=GloIntegrator::rk4,
+      GloIntegrationStats* stats=nullptr)
     const noexcept
   {
     int status = 0;
     constexpr seconds secmt (10800L);
-    // t_i and t_b to MT
+    // t_i and t_b to MT; tb is the ToC (RINEX v3.x records tb as ToC, in
+    // UTC), the epoch GloPropagator and GloNavBatch also propagate from
     t.add_seconds(secmt);
-    ngpt::datetime<seconds> tb = glo_tb2date(true);
+    ngpt::datetime<seconds> tb = toc__;
+    tb.add_seconds(secmt);
     double sec = t.sec().to_fractional_seconds();
     double tb_sec = tb.sec().to_fractional_seconds();
     // reference ti and tb to the same day (it may happen? that ti and tb are
@@ -136,7 +216,7 @@ public:
     } else if (t.mjd()<tb.mjd()) {
       sec = sec - 86400e0;
     }
-    if ( (status=glo_ecef(sec, tb_sec, state)) ) return status;
+    if ( (status=glo_ecef(sec, tb_sec, state, integrator, stats)) ) return status;
     if ( (status=glo_dtsv(sec, tb_sec, dt)) ) return status;
     return 0;
   }
@@ -160,6 +240,12 @@ public:
   SATELLITE_SYSTEM
   sys() const noexcept { return sys__; }
 
+  /// @brief GLONASS frequency channel (aka frequency number, data__[10]);
+  ///        only meaningful for GLONASS frames.
+  int
+  glo_frequency_channel() const noexcept
+  { return static_cast<int>(data__[10]); }
+
   int
   prn() const noexcept { return prn__; }
 
@@ -173,6 +259,11 @@ public:
   satsys() const noexcept {return sys__;}
   
 private:
+  /// @brief Resolve a data block, reading lines via the given line source
+  template<typename F>
+    int
+    __set_from_rnx3__(F&& next_line) noexcept;
+
   SATELLITE_SYSTEM              sys__{};     ///< Satellite system
   int                           prn__{};     ///< PRN as in Rinex 3x
   ngpt::datetime<ngpt::seconds> toc__{};     ///< Time of clock
@@ -187,7 +278,7 @@ public:
   
   /// @brief Constructor from filename
   explicit
-  NavigationRnx(const char*);
+  NavigationRnx(const char*, bool memory_map=false);
   
   /// @brief Destructor (closing the file is not mandatory, but nevertheless)
   ~NavigationRnx() noexcept 
@@ -225,17 +316,36 @@ public:
   void
   rewind() noexcept;
 
+  /// @brief Read and resolve all data blocks (in parallel if the file is
+  ///        memory-mapped)
+  int
+  read_all_records(std::vector<NavDataFrame>& frames, int num_threads=0)
+  noexcept;
+
+  /// @brief Check if data blocks are read from a memory-mapped file
+  bool
+  is_memory_mapped() const noexcept
+  {return __mmap.is_mapped();}
+
 private:
   
   /// @brief Read RINEX header; assign info
   int
   read_header() noexcept;
 
+  /// @brief Implementation of read_all_records (may throw on allocation
+  ///        failure)
+  int
+  __read_all_records__(std::vector<NavDataFrame>& frames, int num_threads);
+
   std::string            __filename;    ///< The name of the file
   std::ifstream          __istream;     ///< The infput (file) stream
   SATELLITE_SYSTEM       __satsys;      ///< satellite system
   float                  __version;     ///< Rinex version (e.g. 3.4)
   pos_type               __end_of_head; ///< Mark the 'END OF HEADER' field
+  MappedFile             __mmap;        ///< The file mapped in memory (if
+                                        ///< memory mapping is used)
+  const char*            __mcur;        ///< Current position in __mmap
 };// NavigationRnx
 
 }// ngpt
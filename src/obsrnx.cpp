@@ -0,0 +1,408 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "obsrnx.hpp"
+#include "rinex.hpp"
+
+using ngpt::ObservationEpoch;
+using ngpt::ObservationRnx;
+using ngpt::PackedObservationCode;
+using ngpt::rinex::fixed_width_to_int;
+
+/// Max chars in a header line (should be 80, but some files exceed it).
+constexpr int MAX_HEADER_CHARS { 256 };
+
+/// Max header lines.
+constexpr int MAX_HEADER_LINES { 1000 };
+
+/// Chars per observation in an observation record (format F14.3,I1,I1)
+constexpr int OBS_CHARS { 16 };
+
+/// Width of the value of an observation
+constexpr int OBS_VALUE_CHARS { 14 };
+
+/// @details Check if a field only holds whitespaces.
+static bool
+__is_blank__(const char* str, int width) noexcept
+{
+  for (int i=0; i<width; i++) if (str[i]!=' ') return false;
+  return true;
+}
+
+/// @details Remove a trailing carriage return (aka DOS line endings).
+static void
+__strip_cr__(const char* bol, const char*& eol) noexcept
+{
+  if (eol>bol && eol[-1]=='\r') --eol;
+}
+
+/// @details Prepare the buffer for an epoch of nsats satellites and ncodes
+///          columns. The buffer only grows (never shrinks); its capacity is
+///          (at least) doubled when it has to grow. All observations of the
+///          epoch are set to missing (NaN, with 0 LLI and SSI).
+/// @return  0 on success; 1 if the buffer could not be allocated
+int
+ObservationEpoch::reset(int nsats, int ncodes) noexcept
+{
+  if (nsats > __capacity || ncodes != __ncodes) {
+    int capacity = std::max(__capacity, 32);
+    while (capacity < nsats) capacity *= 2;
+    try {
+      __sys.resize(capacity);
+      __prn.resize(capacity);
+      __values.resize(static_cast<std::size_t>(capacity)*ncodes);
+      __lli.resize(static_cast<std::size_t>(capacity)*ncodes);
+      __ssi.resize(static_cast<std::size_t>(capacity)*ncodes);
+    } catch (std::exception&) {
+      __capacity = __nsats = __ncodes = 0;
+      return 1;
+    }
+    __capacity = capacity;
+    __ncodes   = ncodes;
+  }
+  __nsats = nsats;
+  for (int c=0; c<ncodes; c++) {
+    const std::size_t offset = static_cast<std::size_t>(c)*__capacity;
+    std::fill_n(__values.data()+offset, nsats,
+      std::numeric_limits<double>::quiet_NaN());
+    std::memset(__lli.data()+offset, 0, nsats);
+    std::memset(__ssi.data()+offset, 0, nsats);
+  }
+  return 0;
+}
+
+/// @details ObservationRnx constructor, using a filename. The constructor
+///          will open the input stream, read the header and assign info;
+///          all observation codes of the header are selected.
+///          If memory_map is set, the whole file is mapped in memory after
+///          the header is read and all epochs are resolved directly from
+///          the mapped region (no per-line copies); the input stream is then
+///          closed.
+/// @param[in] filename   The filename of the Rinex file
+/// @param[in] memory_map Read epochs from a memory-mapped file
+/// @throw     std::runtime_error if the header cannot be resolved
+ObservationRnx::ObservationRnx(const char* filename, bool memory_map)
+  : __filename   (filename)
+  , __istream    (filename, std::ios_base::in)
+  , __satsys     (SATELLITE_SYSTEM::mixed)
+  , __version    (0e0)
+  , __end_of_head(0)
+  , __mmap       ()
+  , __mcur       (nullptr)
+{
+  int j;
+  if ((j=read_header())) {
+      if (__istream.is_open()) __istream.close();
+      throw std::runtime_error("[ERROR] Failed to read (obs) RINEX header; Error Code: "+std::to_string(j));
+  }
+  select_codes(std::vector<PackedObservationCode>{});
+  if (memory_map) {
+    __istream.close();
+    __mmap = MappedFile(filename);
+    __mcur = __mmap.begin() + static_cast<std::streamoff>(__end_of_head);
+  }
+}
+
+/// Read a RINEX Observation v3.x header and assign vital information, aka
+/// the version, the satellite system and the observation codes of every
+/// satellite system ('SYS / # / OBS TYPES'). The function will read all
+/// header lines, stoping after the line: "END OF HEADER"
+/// @return  Anything other than 0 denotes an error.
+int
+ObservationRnx::read_header() noexcept
+{
+  char line[MAX_HEADER_CHARS];
+  char* str_end;
+
+  // The stream should be open by now!
+  if (!__istream.is_open()) return 1;
+
+  // Go to the top of the file.
+  __istream.seekg(0);
+
+  // Read the first line. Get version, data-type and sat. system.
+  // ------------------------------------------------------------
+  __istream.getline(line, MAX_HEADER_CHARS);
+  if (std::strlen(line) < 41) return 10;
+  __version = std::strtof(line, &str_end);
+  if (str_end == line) return 10; // transformation to float has failed
+  if (__version < 3e0 || __version >= 4e0) return 13;
+  if (line[20] != 'O') return 11;
+  try {
+    // blank means GPS
+    __satsys = (line[40]==' ')
+      ? SATELLITE_SYSTEM::gps
+      : ngpt::char_to_satsys(line[40]);
+  } catch (std::runtime_error& e) {
+    return 12;
+  }
+
+  // Keep on readling lines until 'END OF HEADER'.
+  // ----------------------------------------------------
+  for (auto& v : __codes) v.clear();
+  int dummy_it = 0, remaining = 0, max_codes = 0;
+  SATELLITE_SYSTEM sys = SATELLITE_SYSTEM::mixed;
+  while (dummy_it < MAX_HEADER_LINES && __istream.getline(line, MAX_HEADER_CHARS)) {
+    const std::size_t sz = std::strlen(line);
+    if (sz < 61) {
+      ++dummy_it;
+      continue;
+    }
+    if (!std::strncmp(line+60, "END OF HEADER", 13)) break;
+    if (!std::strncmp(line+60, "SYS / # / OBS TYPES", 19)) {
+      // a new satellite system, or the continuation of the previous one
+      if (line[0] != ' ') {
+        if (remaining) return 14;
+        try {
+          sys = ngpt::char_to_satsys(line[0]);
+        } catch (std::exception&) {
+          return 14;
+        }
+        if (!fixed_width_to_int(line+3, 3, remaining) || remaining < 0) {
+          return 14;
+        }
+        __codes[static_cast<int>(sys)].clear();
+      } else if (!remaining) {
+        return 14;
+      }
+      for (int i=0; i<13 && remaining; i++, remaining--) {
+        char code[4] = {line[7+4*i], line[8+4*i], line[9+4*i], '\0'};
+        try {
+          __codes[static_cast<int>(sys)].emplace_back(sys, code);
+        } catch (std::exception&) {
+          return 15;
+        }
+      }
+      max_codes = std::max(max_codes,
+        static_cast<int>(__codes[static_cast<int>(sys)].size()));
+    }
+    ++dummy_it;
+  }
+  if (dummy_it >= MAX_HEADER_LINES || !__istream.good()) {
+    return 20;
+  }
+  if (remaining || !max_codes) return 16;
+
+  // Mark the end of header
+  __end_of_head = __istream.tellg();
+
+  // line buffer for stream reads; an observation record holds at most
+  // 3 + 16 * max_codes chars (allow for trailing blanks)
+  try {
+    __line.resize(3 + OBS_CHARS*max_codes + 64);
+  } catch (std::exception&) {
+    return 21;
+  }
+
+  // All done !
+  return 0;
+}
+
+/// @details Select the observation codes to resolve; these will be the
+///          columns of every ObservationEpoch resolved (in the given order).
+///          A code of SATELLITE_SYSTEM::mixed matches the code of any
+///          satellite system (e.g. mixed 'C1C' holds the C1C observations of
+///          GPS, GLONASS, Galileo, ...). Columns of the file that are not
+///          selected are skipped without conversion.
+/// @param[in] codes The observation codes to resolve; if empty, all codes in
+///                  the header are selected (one column per code of every
+///                  satellite system).
+/// @return    0 on success; 1 if none of the codes is in the header (the
+///            selection is still applied, aka all columns will be missing);
+///            2 if the selection could not be stored
+int
+ObservationRnx::select_codes(const std::vector<PackedObservationCode>& codes)
+noexcept
+{
+  try {
+    __selected.clear();
+    if (codes.empty()) {
+      for (const auto& v : __codes) {
+        __selected.insert(__selected.end(), v.begin(), v.end());
+      }
+    } else {
+      __selected = codes;
+    }
+    int found = 0;
+    for (int s=0; s<num_systems; s++) {
+      __columns[s].assign(__codes[s].size(), -1);
+      __last_column[s] = 0;
+      for (std::size_t c=0; c<__codes[s].size(); c++) {
+        const PackedObservationCode code = __codes[s][c];
+        const PackedObservationCode any (SATELLITE_SYSTEM::mixed, code.type(),
+          code.band(), code.attribute());
+        auto it = std::find_if(__selected.begin(), __selected.end(),
+          [=](PackedObservationCode p) {return p==code || p==any;});
+        if (it != __selected.end()) {
+          __columns[s][c] = static_cast<int>(it-__selected.begin());
+          __last_column[s] = static_cast<int>(c) + 1;
+          ++found;
+        }
+      }
+    }
+    return found ? 0 : 1;
+  } catch (std::exception&) {
+    return 2;
+  }
+}
+
+/// @details: Resolve an epoch of a RINEX v3.x observation file, aka the
+///           epoch record ('>') and the observation records of all its
+///           satellites. Event records (epoch flags 2 to 5) and their
+///           special records are skipped.
+/// @param[in] next_line A callable with signature
+///                bool(const char*& bol, const char*& eol), providing the
+///                next line to resolve (start and one-past-the-end); it
+///                should return false if no line can be provided.
+/// @param[out] obs      The resolved epoch
+/// @return    < 0 EOF encountered (no epoch record)
+///            = 0 All ok
+///            > 0 Error
+template<typename F>
+  int
+  ObservationRnx::__read_epoch__(F&& next_line, ObservationEpoch& obs)
+  noexcept
+{
+  const char *line, *eol;
+  int flag, nsats;
+
+  // the epoch record; skip events (and blank lines)
+  for (;;) {
+    if (!next_line(line, eol)) return -1;
+    __strip_cr__(line, eol);
+    if (eol == line) continue;
+    if (*line != '>' || eol-line < 35) return 1;
+    flag = line[31] - '0';
+    if (flag < 0 || flag > 6) return 2;
+    if (!fixed_width_to_int(line+32, 3, nsats) || nsats < 0) return 2;
+    if (flag < 2 || flag == 6) break;
+    for (int i=0; i<nsats; i++) {
+      if (!next_line(line, eol)) return 3;
+    }
+  }
+
+  int y, mo, d, h, mi;
+  double sec, clock = 0e0;
+  if (!fixed_width_to_int(line+2, 4, y)
+      || !fixed_width_to_int(line+7, 2, mo)
+      || !fixed_width_to_int(line+10, 2, d)
+      || !fixed_width_to_int(line+13, 2, h)
+      || !fixed_width_to_int(line+16, 2, mi)
+      || !ngpt::rinex::fixed_width_to_double(line+18, 11, sec)) {
+    return 4;
+  }
+  if (eol-line > 41) {
+    const int w = (eol-line-41 < 15) ? static_cast<int>(eol-line-41) : 15;
+    if (!ngpt::rinex::fixed_width_to_double(line+41, w, clock)
+        && !__is_blank__(line+41, w)) {
+      return 4;
+    }
+  }
+  try {
+    obs.__epoch = ngpt::datetime<ngpt::microseconds>(ngpt::year(y),
+      ngpt::month(mo), ngpt::day_of_month(d), ngpt::hours(h),
+      ngpt::minutes(mi), ngpt::microseconds(std::lround(sec*1e6)));
+  } catch (std::exception&) {
+    return 4;
+  }
+  obs.__flag  = flag;
+  obs.__clock = clock;
+
+  if (obs.reset(nsats, static_cast<int>(__selected.size()))) return 5;
+  const std::size_t stride = obs.__capacity;
+  double* values = obs.__values.data();
+  unsigned char* llis = obs.__lli.data();
+  unsigned char* ssis = obs.__ssi.data();
+
+  // the observation records
+  for (int i=0; i<nsats; i++) {
+    if (!next_line(line, eol)) return 6;
+    __strip_cr__(line, eol);
+    if (eol-line < 3) return 7;
+    SATELLITE_SYSTEM s;
+    try {
+      s = ngpt::char_to_satsys(*line);
+    } catch (std::exception&) {
+      return 7;
+    }
+    int prn;
+    if (!fixed_width_to_int(line+1, 2, prn)) return 7;
+    obs.__sys[i] = s;
+    obs.__prn[i] = prn;
+
+    const int* columns = __columns[static_cast<int>(s)].data();
+    const int ncolumns = __last_column[static_cast<int>(s)];
+    const char* field = line + 3;
+    for (int c=0; c<ncolumns && field<eol; c++, field+=OBS_CHARS) {
+      const int j = columns[c];
+      if (j < 0) continue;
+      const int w = (eol-field < OBS_VALUE_CHARS)
+        ? static_cast<int>(eol-field)
+        : OBS_VALUE_CHARS;
+      const std::size_t k = j*stride + i;
+      if (ngpt::rinex::fixed_width_to_double(field, w, values[k])) {
+        if (eol-field > 14 && field[14]>='0' && field[14]<='9') {
+          llis[k] = field[14] - '0';
+        }
+        if (eol-field > 15 && field[15]>='0' && field[15]<='9') {
+          ssis[k] = field[15] - '0';
+        }
+      } else if (!__is_blank__(field, w)) {
+        return 8;
+      } else {
+        values[k] = std::numeric_limits<double>::quiet_NaN();
+      }
+    }
+  }
+
+  return 0;
+}
+
+/// @details Read and resolve the next epoch (see ObservationRnx::select_codes
+///          for the columns resolved).
+/// @param[out] obs An ObservationEpoch where the epoch is resolved to; its
+///                 buffer is reused
+/// @return   < 0 EOF encountered
+///           = 0 All ok; epoch resolved & obs assigned
+///           > 0 Error; epoch not resolved
+int
+ObservationRnx::read_next_epoch(ObservationEpoch& obs) noexcept
+{
+  if (__mmap.is_mapped()) {
+    return __read_epoch__([&](const char*& bol, const char*& eol) -> bool {
+      return ngpt::rinex::next_line(__mcur, __mmap.end(), bol, eol);
+    }, obs);
+  }
+
+  const std::streamsize sz = static_cast<std::streamsize>(__line.size());
+  int status = __read_epoch__([&](const char*& bol, const char*& eol) -> bool {
+    if (!__istream.getline(__line.data(), sz)) return false;
+    bol = __line.data();
+    eol = bol + std::strlen(bol);
+    return true;
+  }, obs);
+  if (status < 0) {
+    if (__istream.eof()) {
+      __istream.clear();
+      return -1;
+    }
+    return 50;
+  }
+  return status;
+}
+
+/// @details Set the obs RINEX stream (or the position in the memory-mapped
+///          file) to end of header, ready to restart reading epochs
+void
+ObservationRnx::rewind() noexcept
+{
+  if (__mmap.is_mapped()) {
+    __mcur = __mmap.begin() + static_cast<std::streamoff>(__end_of_head);
+    return;
+  }
+  __istream.clear();
+  __istream.seekg(__end_of_head);
+}
@@ -0,0 +1,240 @@
+#ifndef __OBSERVATION_RINEX_HPP__
+#define __OBSERVATION_RINEX_HPP__
+
+/// @file      obsrnx.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Reader for RINEX v3.x observation files.
+///
+/// @details   An ObservationRnx reads the header of a RINEX v3.x observation
+///            file (including the 'SYS / # / OBS TYPES' records) and resolves
+///            epoch records, one at a time, into an ObservationEpoch. The
+///            epoch buffer is reused from epoch to epoch; it only allocates
+///            when an epoch holds more satellites than any previous one.
+///            Only the observation codes selected by the user are resolved;
+///            all other columns are skipped without conversion.
+///
+/// @see       RINEX v3.04, ftp://ftp.igs.org/pub/data/format/rinex304.pdf
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include "ggdatetime/dtcalendar.hpp"
+#include "satsys.hpp"
+#include "gnssobs.hpp"
+#include "mmap_file.hpp"
+
+namespace ngpt
+{
+
+/// @class ObservationEpoch
+///
+/// An epoch of (resolved) observations, in Structure-of-Arrays layout: for
+/// each of the selected observation codes (aka columns), the values of all
+/// satellites of the epoch are contiguous in memory, i.e. value(sat, code)
+/// is values(code)[sat]. Missing observations are NaN, with LLI and SSI set
+/// to 0.
+class ObservationEpoch
+{
+public:
+  /// @brief Null constructor; the buffer is allocated by the reader
+  ObservationEpoch() noexcept
+  {};
+
+  /// @brief Epoch (in the time system of the file)
+  ngpt::datetime<ngpt::microseconds>
+  epoch() const noexcept
+  {return __epoch;}
+
+  /// @brief Epoch flag (0: OK, 1: power failure, 6: cycle slip records)
+  int
+  flag() const noexcept
+  {return __flag;}
+
+  /// @brief Receiver clock offset in seconds (0 if not recorded)
+  double
+  clock_offset() const noexcept
+  {return __clock;}
+
+  /// @brief Number of satellites in the epoch
+  int
+  num_sats() const noexcept
+  {return __nsats;}
+
+  /// @brief Number of columns (aka the selected observation codes)
+  int
+  num_codes() const noexcept
+  {return __ncodes;}
+
+  /// @brief Satellite system of the i-th satellite
+  SATELLITE_SYSTEM
+  satsys(int sat) const noexcept
+  {return __sys[sat];}
+
+  /// @brief PRN of the i-th satellite
+  int
+  prn(int sat) const noexcept
+  {return __prn[sat];}
+
+  /// @brief Values of all satellites for a column (num_sats() elements)
+  const double*
+  values(int code) const noexcept
+  {return __values.data() + code*__capacity;}
+
+  /// @brief Value of an observation (NaN if missing)
+  double
+  value(int sat, int code) const noexcept
+  {return __values[code*__capacity+sat];}
+
+  /// @brief Loss of lock indicator of an observation (0 if blank)
+  int
+  lli(int sat, int code) const noexcept
+  {return __lli[code*__capacity+sat];}
+
+  /// @brief Signal strength indicator of an observation (0 if blank)
+  int
+  ssi(int sat, int code) const noexcept
+  {return __ssi[code*__capacity+sat];}
+
+private:
+  friend class ObservationRnx;
+
+  /// @brief Prepare the buffer for an epoch of nsats satellites and ncodes
+  ///        columns; all observations are set to missing
+  int
+  reset(int nsats, int ncodes) noexcept;
+
+  ngpt::datetime<ngpt::microseconds> __epoch{};  ///< Epoch
+  int                        __flag{0};          ///< Epoch flag
+  double                     __clock{0e0};       ///< Rec. clock offset (sec)
+  int                        __nsats{0};         ///< Satellites in epoch
+  int                        __ncodes{0};        ///< Columns
+  int                        __capacity{0};      ///< Max satellites (stride)
+  std::vector<SATELLITE_SYSTEM> __sys;           ///< Satellite systems
+  std::vector<int>           __prn;              ///< PRNs
+  std::vector<double>        __values;           ///< Values, per column
+  std::vector<unsigned char> __lli;              ///< LLIs, per column
+  std::vector<unsigned char> __ssi;              ///< SSIs, per column
+}; // ObservationEpoch
+
+/// @class ObservationRnx
+///
+/// Reader for RINEX v3.x observation files. By default, all observation codes
+/// in the header are resolved (one column for every code of every satellite
+/// system); use ObservationRnx::select_codes to only resolve the codes
+/// needed. Event records (epoch flags 2 to 5) are skipped.
+class ObservationRnx
+{
+public:
+  /// Let's not write this more than once.
+  typedef std::ifstream::pos_type pos_type;
+
+  /// @brief Constructor from filename
+  explicit
+  ObservationRnx(const char*, bool memory_map=false);
+
+  /// @brief Destructor (closing the file is not mandatory, but nevertheless)
+  ~ObservationRnx() noexcept
+  {
+    if (__istream.is_open()) __istream.close();
+  }
+
+  /// @brief Copy not allowed !
+  ObservationRnx(const ObservationRnx&) = delete;
+
+  /// @brief Assignment not allowed !
+  ObservationRnx& operator=(const ObservationRnx&) = delete;
+
+  /// @brief Move Constructor.
+  ObservationRnx(ObservationRnx&& a)
+  noexcept(std::is_nothrow_move_constructible<std::ifstream>::value) = default;
+
+  /// @brief Move assignment operator.
+  ObservationRnx& operator=(ObservationRnx&& a)
+  noexcept(std::is_nothrow_move_assignable<std::ifstream>::value) = default;
+
+  /// @brief Select the observation codes (aka columns) to resolve
+  int
+  select_codes(const std::vector<PackedObservationCode>& codes) noexcept;
+
+  /// @brief The selected observation codes (aka the columns of an epoch)
+  const std::vector<PackedObservationCode>&
+  selected_codes() const noexcept
+  {return __selected;}
+
+  /// @brief Observation codes of a satellite system, as in the header
+  const std::vector<PackedObservationCode>&
+  obs_codes(SATELLITE_SYSTEM s) const noexcept
+  {return __codes[static_cast<int>(s)];}
+
+  /// @brief Read and resolve the next epoch
+  int
+  read_next_epoch(ObservationEpoch&) noexcept;
+
+  /// @brief Set the stream to end of header
+  void
+  rewind() noexcept;
+
+  /// @brief Rinex version (e.g. 3.04)
+  float
+  version() const noexcept
+  {return __version;}
+
+  /// @brief Satellite system of the file
+  SATELLITE_SYSTEM
+  satsys() const noexcept
+  {return __satsys;}
+
+  /// @brief Check if epochs are read from a memory-mapped file
+  bool
+  is_memory_mapped() const noexcept
+  {return __mmap.is_mapped();}
+
+private:
+  /// Number of satellite systems (SATELLITE_SYSTEM enumerators)
+  static constexpr int num_systems { 8 };
+
+  /// @brief Read RINEX header; assign info
+  int
+  read_header() noexcept;
+
+  /// @brief Resolve an epoch, reading lines via the given line source
+  template<typename F>
+    int
+    __read_epoch__(F&& next_line, ObservationEpoch& obs) noexcept;
+
+  std::string            __filename;    ///< The name of the file
+  std::ifstream          __istream;     ///< The infput (file) stream
+  SATELLITE_SYSTEM       __satsys;      ///< satellite system
+  float                  __version;     ///< Rinex version (e.g. 3.4)
+  pos_type               __end_of_head; ///< Mark the 'END OF HEADER' field
+  MappedFile             __mmap;        ///< The file mapped in memory (if
+                                        ///< memory mapping is used)
+  const char*            __mcur;        ///< Current position in __mmap
+  std::vector<char>      __line;        ///< Line buffer (stream reads)
+  /// Observation codes per satellite system, as in the header
+  std::vector<PackedObservationCode> __codes[num_systems];
+  /// Selected observation codes (aka columns)
+  std::vector<PackedObservationCode> __selected;
+  /// Column of every observation code in the header (per satellite system),
+  /// or -1 if not selected
+  std::vector<int>       __columns[num_systems];
+  /// Number of header observation codes to resolve per satellite system
+  /// (aka last selected plus one)
+  int                    __last_column[num_systems];
+};// ObservationRnx
+
+}// ngpt
+
+#endif
@@ -0,0 +1,183 @@
+#include <cmath>
+#include <stdexcept>
+#include "prepared_ephemeris.hpp"
+
+using ngpt::PreparedEphemeris;
+using ngpt::SATELLITE_SYSTEM;
+
+/// @details Compute and store all epoch-independent quantities of the frame.
+///          For BeiDou GEO satellites, the longitude of the ascending node
+///          is propagated in the inertial frame (i.e. __omegad holds
+///          OMEGADOT, not OMEGADOT - OMEGAE_dot); the earth rotation is
+///          applied after the -5 degrees rotation of the BDS-SIS-ICD.
+/// @param[in] frame A navigation data frame of system S
+/// @throw std::runtime_error if the frame is not of system S
+template<SATELLITE_SYSTEM S>
+PreparedEphemeris<S>::PreparedEphemeris(const NavDataFrame& frame)
+{
+  if (frame.sys() != S) {
+    throw std::runtime_error("[ERROR] PreparedEphemeris::PreparedEphemeris Frame is not of the expected satellite system");
+  }
+  constexpr double omegae {traits::broadcast_earth_rotation};
+  const double sqrtA = frame.data(10);
+  if constexpr (S == SATELLITE_SYSTEM::beidou) {
+    __geo  = traits::is_geo(frame.prn());
+  } else {
+    __geo  = false;
+  }
+  __week   = static_cast<int>(frame.data(21));
+  __toe    = frame.data(11);
+  __toc    = seconds_since_gps_week(frame.toc(), __week+traits::week_offset);
+  __A      = sqrtA*sqrtA;
+  __n      = std::sqrt(traits::broadcast_gm/(__A*__A*__A))+frame.data(5);
+  __M0     = frame.data(6);
+  __e      = frame.data(8);
+  __sq1e2  = std::sqrt(1e0-__e*__e);
+  __sinw   = std::sin(frame.data(17));
+  __cosw   = std::cos(frame.data(17));
+  __cuc    = frame.data(7);
+  __cus    = frame.data(9);
+  __crc    = frame.data(16);
+  __crs    = frame.data(4);
+  __cic    = frame.data(12);
+  __cis    = frame.data(14);
+  __i0     = frame.data(15);
+  __idot   = frame.data(19);
+  __omega0 = frame.data(13)-omegae*__toe;
+  __omegad = __geo ? frame.data(18) : frame.data(18)-omegae;
+  __af0    = frame.data(0);
+  __af1    = frame.data(1);
+  __af2    = frame.data(2);
+  __fesqa  = traits::broadcast_relativistic_f*__e*sqrtA;
+}
+
+/// @details Compute SV position and velocity in the ECEF frame of the
+///          system, and the SV clock correction (including the relativistic
+///          term), using the user algorithm of the system's ICD (IS-GPS-200H,
+///          Galileo OS-SIS-ICD, BDS-SIS-ICD, IS-QZSS-PNT, IRNSS SPS ICD; all
+///          share the same model, with different constants). Kepler's
+///          equation is solved once (Newton iterations) and the same
+///          eccentric anomaly is used for position, velocity and relativistic
+///          correction. Velocity components are the analytic derivatives of
+///          the position (IS-GPS-200H, Table 20-IV).
+/// @param[in]  t     Epoch (system time) in seconds since the start of the
+///                   frame's week (see PreparedEphemeris::epoch)
+/// @param[out] state SV position (m) and velocity (m/sec) in the ECEF frame,
+///                   as [x, y, z, vx, vy, vz]; size must be >= 6
+/// @param[out] dtsv  SV clock correction in seconds; includes relativistic
+///                   correction, not the TGD/BGD
+/// @param[out] dtrel If not nullptr, the relativistic correction (already
+///                   included in dtsv) in seconds
+/// @return     0 on success; 1 if Kepler's equation did not converge
+template<SATELLITE_SYSTEM S>
+int
+PreparedEphemeris<S>::state_and_clock(double t, double* state, double& dtsv,
+  double* dtrel) const noexcept
+{
+  constexpr double LIMIT {1e-14};
+  const double tk = t - __toe;
+  const double Mk = __M0 + __n*tk;
+
+  // Solve (Newton) Kepler's equation for Ek
+  double Ek = Mk + __e*std::sin(Mk);
+  double dE = 1e0;
+  int i;
+  for (i=0; std::abs(dE)>LIMIT && i<20; i++) {
+    dE  = (Ek - __e*std::sin(Ek) - Mk) / (1e0 - __e*std::cos(Ek));
+    Ek -= dE;
+  }
+  if (i>=20) return 1;
+  const double sinE = std::sin(Ek);
+  const double cosE = std::cos(Ek);
+
+  // true anomaly (as sine/cosine) and argument of latitude F = v + omega
+  const double ecosEm1 = 1e0 - __e*cosE;
+  const double sinv    = __sq1e2*sinE / ecosEm1;
+  const double cosv    = (cosE-__e) / ecosEm1;
+  const double sinF    = sinv*__cosw + cosv*__sinw;
+  const double cosF    = cosv*__cosw - sinv*__sinw;
+  const double sin2F   = 2e0*sinF*cosF;
+  const double cos2F   = (cosF-sinF)*(cosF+sinF);
+
+  // second harmonic perturbations
+  const double duk = __cus*sin2F + __cuc*cos2F;
+  const double drk = __crs*sin2F + __crc*cos2F;
+  const double dik = __cis*sin2F + __cic*cos2F;
+
+  // corrected argument of latitude, radius and inclination
+  const double sindu = std::sin(duk);
+  const double cosdu = std::cos(duk);
+  const double sinu  = sinF*cosdu + cosF*sindu;
+  const double cosu  = cosF*cosdu - sinF*sindu;
+  const double rk    = __A*ecosEm1 + drk;
+  const double ik    = __i0 + dik + __idot*tk;
+  const double sini  = std::sin(ik);
+  const double cosi  = std::cos(ik);
+
+  // positions in orbital plane
+  const double xk = rk*cosu;
+  const double yk = rk*sinu;
+
+  // corrected longitude of ascending node
+  const double omegak = __omega0 + __omegad*tk;
+  const double sinO   = std::sin(omegak);
+  const double cosO   = std::cos(omegak);
+
+  state[0] = xk*cosO - yk*sinO*cosi;
+  state[1] = xk*sinO + yk*cosO*cosi;
+  state[2] = yk*sini;
+
+  // rates
+  const double Ek_dot = __n / ecosEm1;
+  const double vk_dot = Ek_dot*__sq1e2 / ecosEm1;
+  const double ik_dot = __idot + 2e0*vk_dot*(__cis*cos2F - __cic*sin2F);
+  const double uk_dot = vk_dot + 2e0*vk_dot*(__cus*cos2F - __cuc*sin2F);
+  const double rk_dot = __e*__A*Ek_dot*sinE
+                      + 2e0*vk_dot*(__crs*cos2F - __crc*sin2F);
+  const double xk_dot = rk_dot*cosu - yk*uk_dot;
+  const double yk_dot = rk_dot*sinu + xk*uk_dot;
+
+  state[3] = -xk*__omegad*sinO + xk_dot*cosO - yk_dot*sinO*cosi
+           - yk*(__omegad*cosO*cosi - ik_dot*sinO*sini);
+  state[4] = xk*__omegad*cosO + xk_dot*sinO + yk_dot*cosO*cosi
+           - yk*(__omegad*sinO*cosi + ik_dot*cosO*sini);
+  state[5] = yk_dot*sini + yk*ik_dot*cosi;
+
+  // BeiDou GEO: state is in the (user-defined) inertial frame; rotate by
+  // -5 degrees about the x-axis and by OMEGAE_dot*tk about the z-axis
+  if constexpr (S == SATELLITE_SYSTEM::beidou) {
+    if (__geo) {
+      constexpr double omegae {traits::broadcast_earth_rotation};
+      const double cf = std::cos(traits::geo_frame_rotation);
+      const double sf = std::sin(traits::geo_frame_rotation);
+      const double ct = std::cos(omegae*tk);
+      const double st = std::sin(omegae*tk);
+      const double u0 = state[0];
+      const double u1 = cf*state[1] + sf*state[2];
+      const double u2 = cf*state[2] - sf*state[1];
+      const double du0 = state[3];
+      const double du1 = cf*state[4] + sf*state[5];
+      const double du2 = cf*state[5] - sf*state[4];
+      state[0] = ct*u0 + st*u1;
+      state[1] = ct*u1 - st*u0;
+      state[2] = u2;
+      state[3] = ct*du0 + st*du1 + omegae*state[1];
+      state[4] = ct*du1 - st*du0 - omegae*state[0];
+      state[5] = du2;
+    }
+  }
+
+  // clock correction
+  const double dt  = t - __toc;
+  const double rel = __fesqa*sinE;
+  dtsv = __af0 + __af1*dt + (__af2*dt)*dt + rel;
+  if (dtrel) *dtrel = rel;
+
+  return 0;
+}
+
+template class ngpt::PreparedEphemeris<SATELLITE_SYSTEM::gps>;
+template class ngpt::PreparedEphemeris<SATELLITE_SYSTEM::galileo>;
+template class ngpt::PreparedEphemeris<SATELLITE_SYSTEM::qzss>;
+template class ngpt::PreparedEphemeris<SATELLITE_SYSTEM::beidou>;
+template class ngpt::PreparedEphemeris<SATELLITE_SYSTEM::irnss>;
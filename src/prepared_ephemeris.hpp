@@ -0,0 +1,156 @@
+#ifndef __GNSS_PREPARED_EPHEMERIS_HPP__
+#define __GNSS_PREPARED_EPHEMERIS_HPP__
+
+/// @file      prepared_ephemeris.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Broadcast (Keplerian) ephemeris with all epoch-independent
+///            quantities precomputed.
+///
+/// @details   A NavDataFrame holds the broadcast parameters as they are
+///            recorded in the RINEX file; every call to
+///            NavDataFrame::gps_ecef and NavDataFrame::gps_dtsv recomputes
+///            quantities that do not depend on the epoch (semi-major axis,
+///            mean motion, sqrt(1-e^2), ...) and gps_dtsv solves Kepler's
+///            equation once more. A GpsPreparedEphemeris computes all these
+///            once, at construction, and evaluates position, velocity and
+///            clock correction in one pass, solving Kepler's equation only
+///            once per epoch. The same (templated) kernel serves GPS, Galileo,
+///            QZSS, BeiDou and IRNSS frames.
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include "navrnx.hpp"
+
+namespace ngpt
+{
+
+/// @class PreparedEphemeris
+/// A navigation data frame of a Keplerian (broadcast orbit) satellite system,
+/// aka GPS, Galileo, QZSS, BeiDou or IRNSS, prepared for (fast) repeated
+/// evaluation.
+///
+/// All systems share the same evaluation kernel; the system-specific
+/// quantities (GM, earth rotation rate, relativistic constant F, week and
+/// time scale offsets) are taken from satellite_system_traits<S> at compile
+/// time, so there is no branching on the satellite system at run time. For
+/// BeiDou, GEO satellites (see satellite_system_traits::is_geo) are
+/// evaluated in the rotated frame of the BDS-SIS-ICD.
+///
+/// Epochs are given as seconds since the start of the frame's week (aka
+/// the week of ToE), in the time scale of the system (e.g. BDT for BeiDou);
+/// use PreparedEphemeris::epoch to transform a date in GPS time. Epochs
+/// outside the week are allowed (negative or > 604800).
+///
+/// @tparam S The satellite system; one of gps, galileo, qzss, beidou or
+///           irnss
+template<SATELLITE_SYSTEM S>
+  class PreparedEphemeris
+{
+public:
+  /// The satellite system traits (broadcast orbit model constants)
+  using traits = satellite_system_traits<S>;
+
+  /// @brief Constructor from a navigation data frame (of system S).
+  explicit
+  PreparedEphemeris(const NavDataFrame& frame);
+
+  /// @brief Transform a date (GPS time) to seconds since the start of the
+  ///        frame's week, in the time scale of the system.
+  template<typename T>
+    double
+    epoch(const ngpt::datetime<T>& t) const noexcept
+  {
+    return seconds_since_gps_week(t, __week+traits::week_offset)
+      - traits::time_offset;
+  }
+
+  /// @brief Compute SV position, velocity and clock correction.
+  int
+  state_and_clock(double t, double* state, double& dtsv,
+    double* dtrel=nullptr) const noexcept;
+
+  /// @brief Compute SV position, velocity and clock correction at a date
+  ///        (GPS time).
+  template<typename T>
+    int
+    state_and_clock(const ngpt::datetime<T>& t, double* state, double& dtsv,
+      double* dtrel=nullptr) const noexcept
+  {return state_and_clock(epoch(t), state, dtsv, dtrel);}
+
+  /// @brief The week of ToE (as recorded in the frame, e.g. BDT week).
+  int
+  week() const noexcept
+  {return __week;}
+
+  /// @brief ToE in seconds of week.
+  double
+  toe() const noexcept
+  {return __toe;}
+
+  /// @brief Check if the frame is evaluated as a (BeiDou) GEO orbit.
+  bool
+  is_geo() const noexcept
+  {return __geo;}
+
+private:
+  int    __week;   ///< Week (of ToE)
+  bool   __geo;    ///< BeiDou GEO satellite
+  double __toe;    ///< ToE (sec of week)
+  double __toc;    ///< ToC (sec since start of __week)
+  double __A;      ///< Semi-major axis (m)
+  double __n;      ///< Corrected mean motion (rad/sec)
+  double __M0;     ///< Mean anomaly at reference time (rad)
+  double __e;      ///< Eccentricity
+  double __sq1e2;  ///< sqrt(1-e^2)
+  double __sinw;   ///< sin(omega), omega is the argument of perigee
+  double __cosw;   ///< cos(omega)
+  double __cuc;    ///< Cuc (rad)
+  double __cus;    ///< Cus (rad)
+  double __crc;    ///< Crc (m)
+  double __crs;    ///< Crs (m)
+  double __cic;    ///< Cic (rad)
+  double __cis;    ///< Cis (rad)
+  double __i0;     ///< Inclination at reference time (rad)
+  double __idot;   ///< Rate of inclination (rad/sec)
+  double __omega0; ///< OMEGA0 - OMEGAE_dot*ToE (rad)
+  double __omegad; ///< OMEGADOT - OMEGAE_dot (rad/sec); OMEGADOT for GEO
+  double __af0;    ///< SV clock bias (sec)
+  double __af1;    ///< SV clock drift (sec/sec)
+  double __af2;    ///< SV clock drift rate (sec/sec^2)
+  double __fesqa;  ///< F*e*sqrt(A), relativistic clock correction (sec)
+}; // PreparedEphemeris
+
+/// A GPS navigation data frame, prepared for (fast) repeated evaluation.
+using GpsPreparedEphemeris = PreparedEphemeris<SATELLITE_SYSTEM::gps>;
+
+/// A Galileo navigation data frame, prepared for (fast) repeated evaluation.
+using GalPreparedEphemeris = PreparedEphemeris<SATELLITE_SYSTEM::galileo>;
+
+/// A QZSS navigation data frame, prepared for (fast) repeated evaluation.
+using QzsPreparedEphemeris = PreparedEphemeris<SATELLITE_SYSTEM::qzss>;
+
+/// A BeiDou navigation data frame, prepared for (fast) repeated evaluation.
+using BdsPreparedEphemeris = PreparedEphemeris<SATELLITE_SYSTEM::beidou>;
+
+/// An IRNSS navigation data frame, prepared for (fast) repeated evaluation.
+using IrnPreparedEphemeris = PreparedEphemeris<SATELLITE_SYSTEM::irnss>;
+
+extern template class PreparedEphemeris<SATELLITE_SYSTEM::gps>;
+extern template class PreparedEphemeris<SATELLITE_SYSTEM::galileo>;
+extern template class PreparedEphemeris<SATELLITE_SYSTEM::qzss>;
+extern template class PreparedEphemeris<SATELLITE_SYSTEM::beidou>;
+extern template class PreparedEphemeris<SATELLITE_SYSTEM::irnss>;
+
+} // ngpt
+
+#endif
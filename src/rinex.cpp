@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "rinex.hpp"
+
+namespace
+{
+/// Exactly representable powers of 10 (as doubles), i.e. 10^0 ... 10^22
+constexpr double exact_pow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// @brief Check if 8 consecutive chars (packed in a 64-bit word) are all
+///        decimal digits (SWAR).
+inline bool
+__is_eight_digits__(std::uint64_t w) noexcept
+{
+  return !(((w + 0x4646464646464646ULL) | (w - 0x3030303030303030ULL))
+           & 0x8080808080808080ULL);
+}
+
+/// @brief Convert 8 consecutive decimal digits (packed in a 64-bit word,
+///        little endian) to an integer (SWAR).
+inline std::uint32_t
+__eight_digits_to_int__(std::uint64_t w) noexcept
+{
+  constexpr std::uint64_t mask = 0x000000FF000000FFULL;
+  constexpr std::uint64_t mul1 = 0x000F424000000064ULL; // 100+(1000000<<32)
+  constexpr std::uint64_t mul2 = 0x0000271000000001ULL; // 1+(10000<<32)
+  w -= 0x3030303030303030ULL;
+  w  = (w * 10) + (w >> 8);
+  w  = (((w & mask) * mul1) + (((w >> 16) & mask) * mul2)) >> 32;
+  return static_cast<std::uint32_t>(w);
+}
+}// anonymous namespace
+
+/// @details The field is scanned once; the mantissa digits after the decimal
+///          point are consumed 8 at a time (SWAR) when possible. See the
+///          declaration for the rounding guarantees.
+bool
+ngpt::rinex::fixed_width_to_double(const char* str, int width, double& val)
+noexcept
+{
+  const char* p = str;
+  const char* e = str + width;
+
+  // skip leading whitespaces
+  while (p<e && *p==' ') ++p;
+  if (p==e) return false;
+
+  // sign
+  bool negative = false;
+  if (*p=='-') {
+    negative = true;
+    ++p;
+  } else if (*p=='+') {
+    ++p;
+  }
+
+  // mantissa as integer, with a decimal exponent
+  std::uint64_t mant = 0;
+  int ndigits = 0, dexp = 0;
+  while (p<e && *p>='0' && *p<='9') {
+    mant = mant*10 + static_cast<std::uint64_t>(*p-'0');
+    ++ndigits;
+    ++p;
+  }
+  if (p<e && *p=='.') {
+    ++p;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::uint64_t w;
+    while (e-p>=8 && ndigits+8<=19) {
+      std::memcpy(&w, p, sizeof(w));
+      if (!__is_eight_digits__(w)) break;
+      mant = mant*100000000ULL + __eight_digits_to_int__(w);
+      ndigits += 8;
+      dexp -= 8;
+      p += 8;
+    }
+#endif
+    while (p<e && *p>='0' && *p<='9') {
+      mant = mant*10 + static_cast<std::uint64_t>(*p-'0');
+      ++ndigits;
+      --dexp;
+      ++p;
+    }
+  }
+  if (!ndigits) return false;
+
+  // exponent (if any)
+  int exp = 0;
+  if (p<e && (*p=='D' || *p=='d' || *p=='E' || *p=='e')) {
+    ++p;
+    bool eneg = false;
+    if (p<e && *p=='-') {
+      eneg = true;
+      ++p;
+    } else if (p<e && *p=='+') {
+      ++p;
+    }
+    // no digits after the marker (e.g. "1.5D") means a zero exponent, as
+    // for std::strtod (which stops at the marker)
+    while (p<e && *p>='0' && *p<='9') {
+      if (exp<10000) exp = exp*10 + (*p-'0');
+      ++p;
+    }
+    if (eneg) exp = -exp;
+  }
+
+  // only trailing whitespaces allowed
+  while (p<e && *p==' ') ++p;
+  if (p!=e) return false;
+
+  dexp += exp;
+  if (!mant) {
+    val = negative ? -0e0 : 0e0;
+    return true;
+  }
+  if (ndigits<=19 && mant<=(1ULL<<53) && dexp>=-22 && dexp<=22) {
+    const double m = static_cast<double>(mant);
+    val = (dexp<0) ? m/exact_pow10[-dexp] : m*exact_pow10[dexp];
+    if (negative) val = -val;
+    return true;
+  }
+
+  // slow path; copy, replace exponent char and use strtod
+  char buf[64];
+  std::memcpy(buf, str, width);
+  buf[width] = '\0';
+  for (int i=0; i<width; i++) if (buf[i]=='D' || buf[i]=='d') buf[i]='E';
+  char* end;
+  val = std::strtod(buf, &end);
+  return end != buf;
+}
+
+/// @details No character outside [str, str+width) is read.
+bool
+ngpt::rinex::fixed_width_to_int(const char* str, int width, int& val)
+noexcept
+{
+  const char* e = str + width;
+  while (str<e && *str==' ') ++str;
+  bool negative = false;
+  if (str<e && (*str=='-' || *str=='+')) negative = (*str++=='-');
+  if (str==e || *str<'0' || *str>'9') return false;
+  int v = 0;
+  while (str<e && *str>='0' && *str<='9') v = v*10 + (*str++ - '0');
+  while (str<e && *str==' ') ++str;
+  if (str!=e) return false;
+  val = negative ? -v : v;
+  return true;
+}
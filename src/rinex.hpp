@@ -1,6 +1,8 @@
 #ifndef __RINEX_GNSS_HPP__
 #define __RINEX_GNSS_HPP__
 
+#include <cstring>
+
 namespace ngpt
 {
 namespace rinex
@@ -16,6 +18,86 @@ namespace rinex
   {
     return y<=79 ? 2000+y : 1900+y;
   }
+
+  /// @brief Resolve an integer written in a fixed-width field (e.g. the
+  ///        I2/I4 fields of epoch lines); leading and trailing whitespaces
+  ///        and a sign are allowed.
+  /// @param[in]  str   Start of the field
+  /// @param[in]  width Number of characters in the field
+  /// @param[out] val   The resolved integer
+  /// @return True if the field holds a valid integer and val was assigned;
+  ///         false otherwise (e.g. blank field, invalid characters)
+  bool
+  fixed_width_to_int(const char* str, int width, int& val) noexcept;
+
+  /// @brief Resolve a floating point number written in a fixed-width field.
+  ///
+  /// The field may hold leading/trailing whitespaces, a sign, a mantissa (with
+  /// or without a decimal point) and an (optional) exponent marked by any of
+  /// 'D', 'd', 'E' or 'e' (e.g. " -.123456789012D-03", "-1.234567890123E-03"
+  /// as written in RINEX files in the format D19.12). An exponent marker
+  /// (and sign) not followed by digits is ignored, as std::strtod does. The
+  /// input string is never modified and no character outside
+  /// [str, str+width) is read.
+  ///
+  /// When the mantissa fits in 53 bits and the (decimal) exponent is at most
+  /// 22 in magnitude, the result is computed with a single (correctly
+  /// rounded) floating point operation, hence it is bit-exact with what
+  /// std::strtod returns for the same string (after replacing 'D' with 'E').
+  /// Any other case is delegated to std::strtod.
+  ///
+  /// @param[in]  str   Start of the field
+  /// @param[in]  width Number of characters in the field (must be < 64)
+  /// @param[out] val   The resolved number
+  /// @return True if the field holds a valid number and val was assigned;
+  ///         false otherwise (e.g. blank field, invalid characters)
+  bool
+  fixed_width_to_double(const char* str, int width, double& val) noexcept;
+
+  /// @brief Resolve N consecutive floating point numbers, each written in a
+  ///        field of M characters (e.g. a RINEX 3.x navigation data line
+  ///        holds 4 fields of D19.12).
+  /// @param[in]  str  Start of the first field; N*M characters must be
+  ///                  readable
+  /// @param[out] data Array of (at least) N elements; at output data[0,N)
+  /// @return True if all numbers were resolved; false otherwise
+  template<int N, int M>
+    inline bool
+    fixed_width_to_doubles(const char* str, double* data) noexcept
+  {
+    static_assert(M<64, "Field width too large");
+    for (int i=0; i<N; i++) {
+      if (!fixed_width_to_double(str, M, data[i])) return false;
+      str += M;
+    }
+    return true;
+  }
+
+  /// @brief Find the next line in a memory buffer (e.g. a memory-mapped
+  ///        file).
+  /// @param[in,out] cur At input the start of the line; at output the start
+  ///                    of the following line (or end)
+  /// @param[in]  end    End of the buffer
+  /// @param[out] bol    Start of the line
+  /// @param[out] eol    End of the line (one-past-the-last character; the
+  ///                    newline character is not included)
+  /// @return  False if there are no more lines in the buffer; true otherwise
+  inline bool
+  next_line(const char*& cur, const char* end, const char*& bol,
+    const char*& eol) noexcept
+  {
+    if (cur >= end) return false;
+    bol = cur;
+    const char* nl = static_cast<const char*>(std::memchr(cur, '\n', end-cur));
+    if (nl) {
+      eol = nl;
+      cur = nl+1;
+    } else {
+      eol = end;
+      cur = end;
+    }
+    return true;
+  }
 }// rinex
 }// ngpt
 
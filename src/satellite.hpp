@@ -27,11 +27,6 @@
 namespace ngpt
 {
 
-  int              __prn;     ///< PRN or slot number (GLONASS) or the
-                              ///< SVID number (Galileo),
-  int              __svn;     ///< SVN number (GPS), GLONASS number,
-                              ///< GSAT number (Galileo) or SVN number
-                              ///< (QZSS); blank (Compass, SBAS)
 /// @class Satellite
 /// This class is used to represent a GNSS satellite belonging to any GNSSystem
 /// Different GNSS have/use different identifiers for their constellations, so
@@ -1,143 +1,6 @@
 #include <stdexcept>
 #include "satsys.hpp"
 
-/// Initialize the static frequency map for GPS. Values are {index, frequency}.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::gps>
-    ::frequency_map =
-{
-  { 1, 1575.42e0 },
-  { 2, 1227.60e0 },
-  { 5, 1176.45e0 }
-};
-
-/// Initialize the static frequency map for GPS.
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::gps>
-    ::valid_atributes =
-{
-  { 1, std::string("CSLXPWYMN?" ) },
-  { 2, std::string("CDSLXPWYMN?") },
-  { 5, std::string("IQX?"       ) }
-};
-
-/// Initialize the static frequency map for GLONASS.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::glonass>
-    ::frequency_map =
-{
-  { 1, 1602.000e0 },
-  { 2, 1246.000e0 },
-  { 3, 1202.025e0 }
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::glonass>
-    ::valid_atributes =
-{
-  { 1, std::string("CP?" ) },
-  { 2, std::string("CP?" ) },
-  { 3, std::string("IQX?") }
-};
-
-/// Initialize the static frequency map for GALILEO.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::galileo>
-    ::frequency_map =
-{
-  { 1, 1575.420e0 }, ///< E1
-  { 5, 1176.450e0 }, ///< E5a
-  { 7, 1207.140e0 }, ///< E5b
-  { 8, 1191.795e0 }, ///< E5(E5a+E5b)
-  { 6, 1278.750e0 }  ///< E6
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::galileo>
-    ::valid_atributes =
-{
-  { 1, std::string("ABCXZ?") },
-  { 5, std::string("IQX?"  ) },
-  { 7, std::string("IQX?"  ) },
-  { 8, std::string("IQX?"  ) },
-  { 6, std::string("ABCXZ?") }
-};
-
-/// Initialize the static frequency map for SBAS.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::sbas>
-    ::frequency_map =
-{
-  { 1, 1575.42e0 },
-  { 5, 1176.45e0 }
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::sbas>
-    ::valid_atributes =
-{
-  { 1, std::string("C?"  ) },
-  { 5, std::string("IQX?") }
-};
-
-/// Initialize the static frequency map for QZSS.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::qzss>
-    ::frequency_map =
-{
-  { 1, 1575.42e0 },
-  { 2, 1227.60e0 },
-  { 5, 1176.45e0 },
-  { 6, 1278.75e0 } ///< LEX
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::qzss>
-    ::valid_atributes =
-{
-  { 1, std::string("CSLXZ?") },
-  { 2, std::string("SLX?"  ) },
-  { 5, std::string("IQX?"  ) },
-  { 6, std::string("SLX?"  ) }
-};
-
-/// Initialize the static frequency map for BDS.
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::beidou>
-    ::frequency_map =
-{
-  { 1, 1561.098e0 },
-  { 2, 1207.140e0 },
-  { 3, 1268.520e0 }
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::beidou>
-    ::valid_atributes =
-{
-  { 1, std::string("IQX?") },
-  { 2, std::string("IQX?") },
-  { 3, std::string("IQX?") }
-};
-
-/// Initialize the static frequency map for IRNSS.
-/// \todo in \cite rnx303 the 2nd frequency band is denoted as 'S'
-const std::map<int, double>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::irnss>
-    ::frequency_map =
-{
-  { 5, 1176.450e0 },
-  { 9, 2492.028e0 }
-};
-
-const std::map<int, std::string>
-ngpt::satellite_system_traits<ngpt::SATELLITE_SYSTEM::irnss>
-    ::valid_atributes =
-{
-  { 5, std::string("ABCX?") },
-  { 9, std::string("ABCX?") }
-};
-
 /// @details  Given a satellite system enumerator, this function will return
 ///           it's identifier (e.g. given SatelliteSystem = GPS, the function
 ///           will return 'G'). The identifiers are taken from RINEX v3.02
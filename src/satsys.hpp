@@ -24,6 +24,7 @@
 ///           - add a specilized satellite_system_traits<> class
 ///           - modify satsys_to_char function
 ///           - modify char_to_satsys function
+///           - modify nominal_frequency and valid_attribute functions
 ///           These are all dead simple modifications; one line is enough.
 ///
 /// @copyright Copyright © 2015 Dionysos Satellite Observatory, 
@@ -34,8 +35,8 @@
 ///           for more details.
 
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
-#include <map> 
 
 namespace ngpt
 {
@@ -73,6 +74,31 @@ satsys_to_char(SATELLITE_SYSTEM) noexcept;
 SATELLITE_SYSTEM
 char_to_satsys(char);
 
+/// Number of entries in the per-band tables of satellite_system_traits<>;
+/// the tables are indexed by the (RINEX v3.x) frequency band number, 0-9.
+constexpr int max_frequency_bands { 10 };
+
+/// @brief Bit of an attribute char in an attribute bitmask; 'A' to 'Z' are
+///        bits 0 to 25 and '?' (any attribute) is bit 26. Any other char
+///        gives 0.
+constexpr std::uint32_t
+attribute_bit(char c) noexcept
+{
+  return (c >= 'A' && c <= 'Z')
+    ? (std::uint32_t(1) << (c - 'A'))
+    : ((c == '?') ? (std::uint32_t(1) << 26) : std::uint32_t(0));
+}
+
+/// @brief Attribute bitmask of a (null-terminated) sequence of attribute
+///        chars, e.g. attribute_mask("IQX?")
+constexpr std::uint32_t
+attribute_mask(const char* str) noexcept
+{
+  std::uint32_t mask = 0;
+  while (*str) mask |= attribute_bit(*str++);
+  return mask;
+}
+
 /// Traits for Satellite Systems. A collection of satellite system - specific
 /// "static" information for each system in ngpt::SATELLITE_SYSTEM. To be
 /// specialized for each SATELLITE_SYSTEM
@@ -80,140 +106,445 @@ template<SATELLITE_SYSTEM S>
   struct satellite_system_traits
 {};
 
+/// Frequency band queries, common to all satellite_system_traits<>
+/// specializations (which derive from it, CRTP). Traits must define the
+/// per-band tables band_frequency and band_attributes.
+template<typename Traits>
+  struct satellite_system_band_traits
+{
+  /// Nominal frequency (MHz) of a frequency band; 0 for an invalid band.
+  static constexpr double
+  band2frequency(int band) noexcept
+  {
+    return (band >= 0 && band < max_frequency_bands)
+      ? Traits::band_frequency[band]
+      : 0e0;
+  }
+
+  /// Check if an attribute is valid for a frequency band.
+  static constexpr bool
+  valid_attribute(int band, char attribute) noexcept
+  {
+    return (band >= 0 && band < max_frequency_bands)
+      && (Traits::band_attributes[band] & attribute_bit(attribute));
+  }
+};
+
 /// Specialize traits for Satellite System Gps
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::gps>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::gps>>
 {
   /// Identifier
   static constexpr char identifier { 'G' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1575.42e0,  ///< band 1
+    1227.60e0,  ///< band 2
+    0e0,        ///< band 3
+    0e0,        ///< band 4
+    1176.45e0,  ///< band 5
+    0e0,        ///< band 6
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("CSLXPWYMN?"),
+    attribute_mask("CDSLXPWYMN?"),
+    0,
+    0,
+    attribute_mask("IQX?"),
+    0,
+    0,
+    0,
+    0
+  };
+
+  /// Gravitational constant GM (m^3/sec^2) of the broadcast orbit model
+  /// (WGS 84)
+  static constexpr double broadcast_gm { 3.986005e14 };
+
+  /// Earth rotation rate (rad/sec)
+  static constexpr double broadcast_earth_rotation { 7.2921151467e-5 };
 
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
+  /// Constant F = -2*sqrt(GM)/c^2 of the relativistic clock correction
+  /// (sec/sqrt(m))
+  static constexpr double broadcast_relativistic_f { -4.442807633e-10 };
 
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Seconds in a week of the system's time scale
+  static constexpr double seconds_in_week { 604800e0 };
+
+  /// Number of GPS weeks before week 0 of the system (as recorded in RINEX)
+  static constexpr int week_offset { 0 };
+
+  /// Seconds the system's time scale is behind GPS time
+  static constexpr double time_offset { 0e0 };
 };
 
 /// Specialize traits for Satellite System Glonass
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::glonass>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::glonass>>
 {
   /// Identifier
   static constexpr char identifier { 'R' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-  
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1602.000e0, ///< band 1
+    1246.000e0, ///< band 2
+    1202.025e0, ///< band 3
+    0e0,        ///< band 4
+    0e0,        ///< band 5
+    0e0,        ///< band 6
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("CP?"),
+    attribute_mask("CP?"),
+    attribute_mask("IQX?"),
+    0,
+    0,
+    0,
+    0,
+    0,
+    0
+  };
+
+  /// Frequency channel numbers (k) of the FDMA signals (G1 and G2); the
+  /// frequency of channel k is band_frequency + k * band_channel_spacing.
+  static constexpr int min_frequency_channel { -7 };
+  static constexpr int max_frequency_channel { 13 };
+  static constexpr int num_frequency_channels
+    { max_frequency_channel - min_frequency_channel + 1 };
+
+  /// FDMA channel spacing (MHz) per frequency band, indexed by band; 0 for
+  /// the CDMA (and unused) bands.
+  static constexpr double band_channel_spacing[max_frequency_bands] = {
+    0e0, 0.5625e0, 0.4375e0, 0e0, 0e0, 0e0, 0e0, 0e0, 0e0, 0e0
+  };
+
+  /// Check if a band is an FDMA band (aka its frequency depends on the
+  /// frequency channel).
+  static constexpr bool
+  is_fdma(int band) noexcept
+  {
+    return (band >= 0 && band < max_frequency_bands)
+      && band_channel_spacing[band] != 0e0;
+  }
 };
 
 /// Specialize traits for Satellite System Galileo
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::galileo>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::galileo>>
 {
   /// Identifier
   static constexpr char identifier { 'E' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-  
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
-  
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1575.420e0, ///< band 1 (E1)
+    0e0,        ///< band 2
+    0e0,        ///< band 3
+    0e0,        ///< band 4
+    1176.450e0, ///< band 5 (E5a)
+    1278.750e0, ///< band 6 (E6)
+    1207.140e0, ///< band 7 (E5b)
+    1191.795e0, ///< band 8 (E5(E5a+E5b))
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("ABCXZ?"),
+    0,
+    0,
+    0,
+    attribute_mask("IQX?"),
+    attribute_mask("ABCXZ?"),
+    attribute_mask("IQX?"),
+    attribute_mask("IQX?"),
+    0
+  };
+
+  /// Gravitational constant GM (m^3/sec^2) of the broadcast orbit model
+  /// (Galileo OS SIS ICD)
+  static constexpr double broadcast_gm { 3.986004418e14 };
+
+  /// Earth rotation rate (rad/sec)
+  static constexpr double broadcast_earth_rotation { 7.2921151467e-5 };
+
+  /// Constant F = -2*sqrt(GM)/c^2 of the relativistic clock correction
+  /// (sec/sqrt(m))
+  static constexpr double broadcast_relativistic_f { -4.442807309e-10 };
+
+  /// Seconds in a week of the system's time scale
+  static constexpr double seconds_in_week { 604800e0 };
+
+  /// Number of GPS weeks before week 0 of the system (as recorded in RINEX,
+  /// where Galileo weeks are aligned to GPS weeks)
+  static constexpr int week_offset { 0 };
+
+  /// Seconds the system's time scale is behind GPS time
+  static constexpr double time_offset { 0e0 };
 };
 
 /// Specialize traits for Satellite System SBAS
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::sbas>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::sbas>>
 {
   /// Identifier
   static constexpr char identifier { 'S' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
-  
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1575.42e0,  ///< band 1
+    0e0,        ///< band 2
+    0e0,        ///< band 3
+    0e0,        ///< band 4
+    1176.45e0,  ///< band 5
+    0e0,        ///< band 6
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("C?"),
+    0,
+    0,
+    0,
+    attribute_mask("IQX?"),
+    0,
+    0,
+    0,
+    0
+  };
 };
 
 /// Specialize traits for Satellite System QZSS
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::qzss>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::qzss>>
 {
   /// Identifier
   static constexpr char identifier { 'J' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
-  
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1575.42e0,  ///< band 1
+    1227.60e0,  ///< band 2
+    0e0,        ///< band 3
+    0e0,        ///< band 4
+    1176.45e0,  ///< band 5
+    1278.75e0,  ///< band 6 (LEX)
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("CSLXZ?"),
+    attribute_mask("SLX?"),
+    0,
+    0,
+    attribute_mask("IQX?"),
+    attribute_mask("SLX?"),
+    0,
+    0,
+    0
+  };
+
+  /// Gravitational constant GM (m^3/sec^2) of the broadcast orbit model
+  /// (IS-QZSS-PNT)
+  static constexpr double broadcast_gm { 3.986005e14 };
+
+  /// Earth rotation rate (rad/sec)
+  static constexpr double broadcast_earth_rotation { 7.2921151467e-5 };
+
+  /// Constant F = -2*sqrt(GM)/c^2 of the relativistic clock correction
+  /// (sec/sqrt(m))
+  static constexpr double broadcast_relativistic_f { -4.442807633e-10 };
+
+  /// Seconds in a week of the system's time scale
+  static constexpr double seconds_in_week { 604800e0 };
+
+  /// Number of GPS weeks before week 0 of the system (as recorded in RINEX)
+  static constexpr int week_offset { 0 };
+
+  /// Seconds the system's time scale is behind GPS time
+  static constexpr double time_offset { 0e0 };
 };
 
 /// Specialize traits for Satellite System BDS
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::beidou>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::beidou>>
 {
   /// Identifier
   static constexpr char identifier { 'C' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
-  
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    1561.098e0, ///< band 1
+    1207.140e0, ///< band 2
+    1268.520e0, ///< band 3
+    0e0,        ///< band 4
+    0e0,        ///< band 5
+    0e0,        ///< band 6
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    0e0         ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    attribute_mask("IQX?"),
+    attribute_mask("IQX?"),
+    attribute_mask("IQX?"),
+    0,
+    0,
+    0,
+    0,
+    0,
+    0
+  };
+
+  /// Gravitational constant GM (m^3/sec^2) of the broadcast orbit model
+  /// (CGCS2000, BDS-SIS-ICD)
+  static constexpr double broadcast_gm { 3.986004418e14 };
+
+  /// Earth rotation rate (rad/sec)
+  static constexpr double broadcast_earth_rotation { 7.2921150e-5 };
+
+  /// Constant F = -2*sqrt(GM)/c^2 of the relativistic clock correction
+  /// (sec/sqrt(m))
+  static constexpr double broadcast_relativistic_f { -4.442807309e-10 };
+
+  /// Seconds in a week of the system's time scale
+  static constexpr double seconds_in_week { 604800e0 };
+
+  /// Number of GPS weeks before week 0 of the system (as recorded in RINEX;
+  /// BDT week 0 starts at GPS week 1356)
+  static constexpr int week_offset { 1356 };
+
+  /// Seconds the system's time scale is behind GPS time (BDT = GPST - 14)
+  static constexpr double time_offset { 14e0 };
+
+  /// Rotation (rad) about the x axis of the frame of GEO broadcast orbits
+  /// (BDS-SIS-ICD, Section 5.2.4.12), aka -5 degrees
+  static constexpr double geo_frame_rotation { -5e0*3.14159265358979323846/180e0 };
+
+  /// Check if a PRN is a GEO satellite (C01-C05 and C59-C63); GEO broadcast
+  /// orbits are computed in a rotated frame.
+  static constexpr bool
+  is_geo(int prn) noexcept
+  {
+    return (prn >= 1 && prn <= 5) || (prn >= 59 && prn <= 63);
+  }
 };
 
 /// Specialize traits for Satellite System IRNSS
 template<>
   struct satellite_system_traits<SATELLITE_SYSTEM::irnss>
+  : satellite_system_band_traits<
+      satellite_system_traits<SATELLITE_SYSTEM::irnss>>
 {
   /// Identifier
   static constexpr char identifier { 'I' };
 
-  /// Dictionary holding pairs of <frequency band, freq. value>.
-  static const std::map<int, double> frequency_map;
-
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
-  
-  static double
-  band2frequency(int band)
-  { return frequency_map.at(band); }
+  /// Nominal frequency (MHz) per frequency band, indexed by band; 0 for
+  /// bands not used by the system.
+  static constexpr double band_frequency[max_frequency_bands] = {
+    0e0,        ///< band 0
+    0e0,        ///< band 1
+    0e0,        ///< band 2
+    0e0,        ///< band 3
+    0e0,        ///< band 4
+    1176.450e0, ///< band 5
+    0e0,        ///< band 6
+    0e0,        ///< band 7
+    0e0,        ///< band 8
+    2492.028e0  ///< band 9
+  };
+
+  /// Bitmask of the (**only**) valid attributes per frequency band, indexed
+  /// by band (see ngpt::attribute_bit); 0 for bands not used by the system.
+  static constexpr std::uint32_t band_attributes[max_frequency_bands] = {
+    0,
+    0,
+    0,
+    0,
+    0,
+    attribute_mask("ABCX?"),
+    0,
+    0,
+    0,
+    attribute_mask("ABCX?")
+  };
+
+  /// Gravitational constant GM (m^3/sec^2) of the broadcast orbit model
+  /// (IRNSS SPS ICD)
+  static constexpr double broadcast_gm { 3.986005e14 };
+
+  /// Earth rotation rate (rad/sec)
+  static constexpr double broadcast_earth_rotation { 7.2921151467e-5 };
+
+  /// Constant F = -2*sqrt(GM)/c^2 of the relativistic clock correction
+  /// (sec/sqrt(m))
+  static constexpr double broadcast_relativistic_f { -4.442807633e-10 };
+
+  /// Seconds in a week of the system's time scale
+  static constexpr double seconds_in_week { 604800e0 };
+
+  /// Number of GPS weeks before week 0 of the system (as recorded in RINEX,
+  /// where IRNSS weeks are aligned to GPS weeks)
+  static constexpr int week_offset { 0 };
+
+  /// Seconds the system's time scale is behind GPS time
+  static constexpr double time_offset { 0e0 };
 };
 
 /// Specialize traits for Satellite System MIXED
@@ -225,12 +556,144 @@ template<>
 
   /// Number of frequency bands.
   static const std::size_t num_of_bands { 0 };
+};
 
-  /// Dictionary holding pairs of <frequency band, std::string>. The
-  /// string is a seqeuence of (the **only**) valid attributes for
-  /// each frequency band.
-  static const std::map<int, std::string> valid_atributes;
+/// Speed of light in vacuum (m/sec)
+constexpr double speed_of_light { 299792458e0 };
+
+/// @brief Frequencies and wavelengths of every GLONASS FDMA channel, for the
+///        FDMA bands (G1 and G2); indexed as [band-1][k-min_frequency_channel].
+struct GloFdmaTable
+{
+  using traits = satellite_system_traits<SATELLITE_SYSTEM::glonass>;
+  double frequency[2][traits::num_frequency_channels];  ///< MHz
+  double wavelength[2][traits::num_frequency_channels]; ///< meters
 };
+
+/// @brief Compute the table of GLONASS FDMA channel frequencies/wavelengths.
+constexpr GloFdmaTable
+make_glonass_fdma_table() noexcept
+{
+  using traits = satellite_system_traits<SATELLITE_SYSTEM::glonass>;
+  GloFdmaTable t {};
+  for (int b=1; b<=2; b++) {
+    for (int i=0; i<traits::num_frequency_channels; i++) {
+      const int k = traits::min_frequency_channel + i;
+      t.frequency[b-1][i] = traits::band_frequency[b]
+        + k * traits::band_channel_spacing[b];
+      t.wavelength[b-1][i] = speed_of_light / (t.frequency[b-1][i] * 1e6);
+    }
+  }
+  return t;
+}
+
+/// Frequencies and wavelengths of all GLONASS FDMA channels (compile time).
+inline constexpr GloFdmaTable glonass_fdma_table = make_glonass_fdma_table();
+
+/// @brief Frequency (MHz) of a GLONASS band for a given frequency channel k.
+///        For the CDMA bands, k is disregarded and the nominal frequency is
+///        returned.
+/// @return The frequency, or 0 for an invalid band or (FDMA) channel
+constexpr double
+glonass_frequency(int band, int k) noexcept
+{
+  using traits = satellite_system_traits<SATELLITE_SYSTEM::glonass>;
+  if (!traits::is_fdma(band)) return traits::band2frequency(band);
+  return (k >= traits::min_frequency_channel
+          && k <= traits::max_frequency_channel)
+    ? glonass_fdma_table.frequency[band-1][k-traits::min_frequency_channel]
+    : 0e0;
+}
+
+/// @brief Wavelength (m) of a GLONASS band for a given frequency channel k.
+///        For the CDMA bands, k is disregarded.
+/// @return The wavelength, or 0 for an invalid band or (FDMA) channel
+constexpr double
+glonass_wavelength(int band, int k) noexcept
+{
+  using traits = satellite_system_traits<SATELLITE_SYSTEM::glonass>;
+  if (!traits::is_fdma(band)) {
+    return (traits::band2frequency(band) != 0e0)
+      ? speed_of_light / (traits::band2frequency(band) * 1e6)
+      : 0e0;
+  }
+  return (k >= traits::min_frequency_channel
+          && k <= traits::max_frequency_channel)
+    ? glonass_fdma_table.wavelength[band-1][k-traits::min_frequency_channel]
+    : 0e0;
+}
+
+/// @brief Nominal frequency (MHz) of a frequency band, for any satellite
+///        system; this is the runtime counterpart of
+///        satellite_system_traits<S>::band2frequency.
+/// @return The frequency, or 0 for an invalid band or SATELLITE_SYSTEM::mixed
+constexpr double
+nominal_frequency(SATELLITE_SYSTEM s, int band) noexcept
+{
+  switch (s) {
+    case SATELLITE_SYSTEM::gps :
+      return satellite_system_traits<SATELLITE_SYSTEM::gps>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::glonass :
+      return satellite_system_traits<SATELLITE_SYSTEM::glonass>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::sbas :
+      return satellite_system_traits<SATELLITE_SYSTEM::sbas>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::galileo :
+      return satellite_system_traits<SATELLITE_SYSTEM::galileo>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::beidou :
+      return satellite_system_traits<SATELLITE_SYSTEM::beidou>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::qzss :
+      return satellite_system_traits<SATELLITE_SYSTEM::qzss>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::irnss :
+      return satellite_system_traits<SATELLITE_SYSTEM::irnss>
+        ::band2frequency(band);
+    case SATELLITE_SYSTEM::mixed :
+      return 0e0;
+  }
+  // shoud never reach here!
+  return 0e0;
+}
+
+/// @brief Check if an attribute is valid for a frequency band, for any
+///        satellite system; this is the runtime counterpart of
+///        satellite_system_traits<S>::valid_attribute. For
+///        SATELLITE_SYSTEM::mixed, any attribute is valid.
+constexpr bool
+valid_attribute(SATELLITE_SYSTEM s, int band, char attribute) noexcept
+{
+  switch (s) {
+    case SATELLITE_SYSTEM::gps :
+      return satellite_system_traits<SATELLITE_SYSTEM::gps>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::glonass :
+      return satellite_system_traits<SATELLITE_SYSTEM::glonass>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::sbas :
+      return satellite_system_traits<SATELLITE_SYSTEM::sbas>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::galileo :
+      return satellite_system_traits<SATELLITE_SYSTEM::galileo>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::beidou :
+      return satellite_system_traits<SATELLITE_SYSTEM::beidou>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::qzss :
+      return satellite_system_traits<SATELLITE_SYSTEM::qzss>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::irnss :
+      return satellite_system_traits<SATELLITE_SYSTEM::irnss>
+        ::valid_attribute(band, attribute);
+    case SATELLITE_SYSTEM::mixed :
+      return attribute_bit(attribute) != 0;
+  }
+  // shoud never reach here!
+  return false;
+}
 } // end namespace
 
 #endif
@@ -0,0 +1,36 @@
+#include <cmath>
+#include "navrnx.hpp"
+
+using ngpt::NavDataFrame;
+
+/// @details Compute the SBAS SV state vector at ToC+dt, using the second
+///          order (Taylor) expansion of RTCA DO-229 (message type 9):
+///          x(t) = x0 + v0*dt + a*dt^2/2 and v(t) = v0 + a*dt.
+/// @param[in]  dt    Seconds since ToC (GPS time)
+/// @param[out] state array of size 6; SV state vector (aka
+///                   [x,y,z,Vx,Vy,Vz]) in the ECEF (WGS84) frame, in meters,
+///                   meters/sec
+/// @return 0 if all ok; -1 if the computation is performed, but dt is larger
+///         than the validity of the message (360 sec)
+int
+NavDataFrame::sbas_ecef(double dt, double* state) const noexcept
+{
+  for (int k=0; k<3; k++) {
+    const double* p = data__+3+4*k;
+    state[k]   = p[0] + dt*(p[1] + 0.5e0*dt*p[2]);
+    state[k+3] = p[1] + dt*p[2];
+  }
+  return (std::abs(dt)>ngpt::sbas_max_interval) ? -1 : 0;
+}
+
+/// @details Compute the SBAS SV clock correction at ToC+dt, i.e.
+///          aGf0 + aGf1*dt.
+/// @param[in]  dt   Seconds since ToC (GPS time)
+/// @param[out] dtsv SV clock correction in seconds
+/// @return Always 0
+int
+NavDataFrame::sbas_dtsv(double dt, double& dtsv) const noexcept
+{
+  dtsv = data__[0] + data__[1]*dt;
+  return 0;
+}
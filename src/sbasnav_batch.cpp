@@ -0,0 +1,95 @@
+#include <cmath>
+#include <algorithm>
+#include <exception>
+#include "navbatch.hpp"
+
+using ngpt::SbasNavBatch;
+
+/// @details Add an SBAS navigation data frame; t0 is the ToC of the frame
+///          (in GPS time).
+/// @param[in] frame A navigation data frame (must be SBAS)
+/// @return    0 if the frame was added; 1 if the frame is not an SBAS frame
+///            (nothing added); 10 if memory could not be allocated (nothing
+///            added)
+int
+SbasNavBatch::add(const NavDataFrame& frame) noexcept
+{
+  if (frame.sys() != SATELLITE_SYSTEM::sbas) return 1;
+
+  const std::size_t n = size();
+  try {
+    for (int k=0; k<3; k++) {
+      __p[X+k].push_back(frame.data(3+4*k));
+      __p[VX+k].push_back(frame.data(4+4*k));
+      __p[AX+k].push_back(frame.data(5+4*k));
+    }
+    __p[TOC].push_back(epoch(frame.toc()));
+    __p[AGF0].push_back(frame.data(0));
+    __p[AGF1].push_back(frame.data(1));
+  } catch (std::exception&) {
+    for (auto& v : __p) v.resize(n);
+    return 10;
+  }
+
+  return 0;
+}
+
+/// @details Remove all frames; the reference week is not changed.
+void
+SbasNavBatch::clear() noexcept
+{
+  for (auto& v : __p) v.clear();
+}
+
+/// @details Propagate the state vector of every frame from its ToC to t,
+///          i.e. x = x0 + v0*dt + a*dt^2/2 and v = v0 + a*dt, with
+///          dt = t - ToC (see NavDataFrame::sbas_ecef). Every component is
+///          a loop over all frames, on plain (Structure-of-Arrays) arrays;
+///          these are vectorized across satellites.
+///
+///          The output arrays are also in Structure-of-Arrays layout, aka
+///          component k of frame i is at index k*size()+i.
+///
+/// @param[in]  t     Epoch (GPS time) in seconds since the start of the
+///                   reference week (see SbasNavBatch::epoch)
+/// @param[out] state Array of size 6*size(); SV state vectors
+///                   ([x,y,z,Vx,Vy,Vz]) in the ECEF (WGS84) frame, in meters,
+///                   meters/sec
+/// @param[out] dtsv  If not nullptr, an array of size size(); SV clock
+///                   corrections in seconds
+/// @return     0 if all went well; -1 if for some frame t and ToC are more
+///             than 360 sec apart (all state vectors are computed anyway)
+///
+/// @see NavDataFrame::sbas_ecef
+int
+SbasNavBatch::ecef(double t, double* state, double* dtsv) const noexcept
+{
+  const std::size_t n = size();
+  if (!n) return 0;
+  const double* __restrict__ pTOC = __p[TOC].data();
+
+  double max_dt = 0e0;
+  for (std::size_t i=0; i<n; i++) max_dt = std::max(max_dt, std::abs(t-pTOC[i]));
+  const int status = (max_dt>ngpt::sbas_max_interval) ? -1 : 0;
+
+  for (int k=0; k<3; k++) {
+    const double* __restrict__ x0 = __p[X+k].data();
+    const double* __restrict__ v0 = __p[VX+k].data();
+    const double* __restrict__ a  = __p[AX+k].data();
+    double* __restrict__ x = state + k*n;
+    double* __restrict__ v = state + (k+3)*n;
+    for (std::size_t i=0; i<n; i++) {
+      const double dt = t - pTOC[i];
+      x[i] = x0[i] + dt*(v0[i] + 0.5e0*dt*a[i]);
+      v[i] = v0[i] + dt*a[i];
+    }
+  }
+
+  if (dtsv) {
+    const double* pAGF0 = __p[AGF0].data();
+    const double* pAGF1 = __p[AGF1].data();
+    for (std::size_t i=0; i<n; i++) dtsv[i] = pAGF0[i] + pAGF1[i]*(t-pTOC[i]);
+  }
+
+  return status;
+}
@@ -0,0 +1,358 @@
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "sp3.hpp"
+#include "rinex.hpp"
+#include "mmap_file.hpp"
+
+using ngpt::Sp3;
+using ngpt::rinex::fixed_width_to_int;
+
+/// Satellites per '+' header line
+constexpr int SATS_PER_LINE { 17 };
+
+/// Max PRN (two-digit satellite numbers)
+constexpr int MAX_PRN { 100 };
+
+/// Number of satellite systems (SATELLITE_SYSTEM, including mixed)
+constexpr int NUM_SYSTEMS { static_cast<int>(ngpt::SATELLITE_SYSTEM::mixed)+1 };
+
+/// Bad or absent clock values are written as 999999.999999 (microsec)
+constexpr double BAD_CLOCK { 999999e0 };
+
+/// @details Resolve a satellite id (e.g. "G01", " 1" or "R 5") written in
+///          three characters; a blank system identifier means GPS.
+/// @return  True if the id is valid; false otherwise
+static bool
+__resolve_satid__(const char* str, ngpt::SATELLITE_SYSTEM& sys, int& prn)
+noexcept
+{
+  try {
+    sys = (str[0]==' ')
+      ? ngpt::SATELLITE_SYSTEM::gps
+      : ngpt::char_to_satsys(str[0]);
+  } catch (std::exception&) {
+    return false;
+  }
+  return fixed_width_to_int(str+1, 2, prn) && prn>0 && prn<MAX_PRN;
+}
+
+/// @details Resolve an epoch written as in the first header line and in the
+///          epoch header records, i.e. year at cols [3,7), month at [8,10),
+///          day at [11,13), hour at [14,16), min at [17,19) and seconds at
+///          [20,31). Fractional seconds are not allowed.
+/// @return  True if the epoch was resolved; false otherwise
+static bool
+__resolve_epoch__(const char* line, ngpt::datetime<ngpt::seconds>& t) noexcept
+{
+  int y, mo, d, h, mi;
+  double sec;
+  if (!fixed_width_to_int(line+3, 4, y)
+      || !fixed_width_to_int(line+8, 2, mo)
+      || !fixed_width_to_int(line+11, 2, d)
+      || !fixed_width_to_int(line+14, 2, h)
+      || !fixed_width_to_int(line+17, 2, mi)
+      || !ngpt::rinex::fixed_width_to_double(line+20, 11, sec)) {
+    return false;
+  }
+  const long isec = std::lround(sec);
+  if (std::abs(sec-static_cast<double>(isec)) > 1e-6) return false;
+  try {
+    t = ngpt::datetime<ngpt::seconds>(ngpt::year(y), ngpt::month(mo),
+      ngpt::day_of_month(d), ngpt::hours(h), ngpt::minutes(mi),
+      ngpt::seconds(isec));
+  } catch (std::exception&) {
+    return false;
+  }
+  return true;
+}
+
+/// @details Sp3 constructor, using a filename. The whole file is mapped in
+///          memory and all position (and clock) records are resolved in the
+///          epoch x satellite array; the file is then unmapped.
+/// @param[in] filename The filename of the SP3 file
+/// @throw     std::runtime_error if the file cannot be resolved
+Sp3::Sp3(const char* filename)
+  : __version   (' ')
+  , __start     ()
+  , __num_epochs(0)
+  , __interval  (0e0)
+{
+  int j;
+  if ((j=load(filename))) {
+    throw std::runtime_error("[ERROR] Failed to read SP3 file; Error Code: "+std::to_string(j));
+  }
+}
+
+/// @details Read the SP3 header and all records. Only 'P' records are
+///          resolved; velocity ('V') and correlation ('EP', 'EV') records are
+///          skipped. Positions of 0.000000 (in all components) and clock
+///          values of 999999.999999 are set to NaN.
+/// @return  Anything other than 0 denotes an error:
+///          10: file could not be mapped, 11: invalid first line (version),
+///          12: invalid first epoch, 13: invalid number of epochs,
+///          14: invalid interval, 15: invalid satellite list,
+///          16: invalid epoch record, 17: epoch record not on the grid,
+///          18: invalid position record, 19: allocation failed
+int
+Sp3::load(const char* filename) noexcept
+{
+  MappedFile mf;
+  try {
+    mf = MappedFile(filename);
+  } catch (std::exception&) {
+    return 10;
+  }
+  const char* cur = mf.begin();
+  const char* end = mf.end();
+  const char *bol, *eol;
+
+  // First line: version, first epoch, number of epochs and coordinate system
+  if (!rinex::next_line(cur, end, bol, eol) || eol-bol < 31 || bol[0]!='#'
+      || (bol[1]!='c' && bol[1]!='d')) {
+    return 11;
+  }
+  __version = bol[1];
+  if (!__resolve_epoch__(bol, __start)) return 12;
+  if (eol-bol < 39 || !fixed_width_to_int(bol+32, 7, __num_epochs)
+      || __num_epochs < 1) {
+    return 13;
+  }
+  __crd_sys = (eol-bol >= 51) ? std::string(bol+46, 5) : std::string();
+  __crd_sys.erase(__crd_sys.find_last_not_of(' ')+1);
+
+  // Second line: interval
+  if (!rinex::next_line(cur, end, bol, eol) || eol-bol < 38 || bol[0]!='#'
+      || bol[1]!='#' || !rinex::fixed_width_to_double(bol+24, 14, __interval)
+      || !(__interval > 0e0)) {
+    return 14;
+  }
+
+  // Satellite list ('+' lines), then anything up to the first epoch record
+  int num_sats = -1;
+  const char* first_epoch = nullptr;
+  __sys.clear();
+  __prn.clear();
+  __time_sys.clear();
+  while (rinex::next_line(cur, end, bol, eol)) {
+    if (eol>bol && eol[-1]=='\r') --eol;
+    if (bol[0]=='*') {
+      first_epoch = bol;
+      break;
+    }
+    if (bol[0]=='+' && (eol-bol<2 || bol[1]==' ')) {
+      if (num_sats < 0) {
+        if (eol-bol < 6 || !fixed_width_to_int(bol+3, 3, num_sats)
+            || num_sats < 1) {
+          return 15;
+        }
+      }
+      const int resolved = static_cast<int>(__prn.size());
+      for (int i=0; i<SATS_PER_LINE && resolved+i<num_sats; i++) {
+        if (eol-bol < 9+3*(i+1)) return 15;
+        SATELLITE_SYSTEM s;
+        int prn;
+        if (!__resolve_satid__(bol+9+3*i, s, prn)) return 15;
+        try {
+          __sys.push_back(s);
+          __prn.push_back(prn);
+        } catch (std::exception&) {
+          return 19;
+        }
+      }
+    } else if (eol-bol >= 12 && bol[0]=='%' && bol[1]=='c'
+        && __time_sys.empty()) {
+      __time_sys = std::string(bol+9, 3);
+      __time_sys.erase(__time_sys.find_last_not_of(' ')+1);
+    }
+  }
+  if (num_sats < 1 || static_cast<int>(__prn.size()) != num_sats) return 15;
+
+  // Allocate the index of every satellite (per system and PRN) and the
+  // array; every value is missing until resolved
+  const std::size_t stride = 4*static_cast<std::size_t>(num_sats);
+  try {
+    __index.assign(NUM_SYSTEMS*MAX_PRN, -1);
+    __data.assign(stride*__num_epochs,
+      std::numeric_limits<double>::quiet_NaN());
+  } catch (std::exception&) {
+    return 19;
+  }
+  for (int i=0; i<num_sats; i++) {
+    __index[static_cast<int>(__sys[i])*MAX_PRN+__prn[i]] = i;
+  }
+
+  // Records
+  if (!first_epoch) return 0;
+  cur = first_epoch;
+  double* row = nullptr;
+  while (rinex::next_line(cur, end, bol, eol)) {
+    if (eol>bol && eol[-1]=='\r') --eol;
+    if (bol[0]=='*') {
+      ngpt::datetime<ngpt::seconds> t;
+      if (eol-bol < 31 || !__resolve_epoch__(bol, t)) return 16;
+      const double dsec = seconds_since_start(t);
+      const long k = std::lround(dsec/__interval);
+      if (std::abs(dsec-k*__interval) > 1e-3 || k < 0 || k >= __num_epochs) {
+        return 17;
+      }
+      row = __data.data() + stride*k;
+    } else if (bol[0]=='P') {
+      SATELLITE_SYSTEM s;
+      int prn;
+      if (!row || eol-bol < 46 || !__resolve_satid__(bol+1, s, prn)) {
+        return 18;
+      }
+      const int sat = __index[static_cast<int>(s)*MAX_PRN+prn];
+      if (sat < 0) continue;
+      double v[4];
+      if (!rinex::fixed_width_to_doubles<3, 14>(bol+4, v)) return 18;
+      if (v[0]!=0e0 || v[1]!=0e0 || v[2]!=0e0) {
+        for (int c=0; c<3; c++) row[c*num_sats+sat] = v[c]*1e3;
+      }
+      if (eol-bol >= 60 && rinex::fixed_width_to_double(bol+46, 14, v[3])
+          && v[3] < BAD_CLOCK) {
+        row[3*num_sats+sat] = v[3]*1e-6;
+      }
+    } else if (!std::strncmp(bol, "EOF", 3)) {
+      break;
+    }
+  }
+  return 0;
+}
+
+/// @details Find the index of a satellite in the file; a lookup in the
+///          index built by Sp3::load.
+/// @return  The index (in [0, num_sats())) or -1 if not in the file
+int
+Sp3::sat_index(SATELLITE_SYSTEM s, int prn) const noexcept
+{
+  if (prn<1 || prn>=MAX_PRN || __index.empty()) return -1;
+  return __index[static_cast<int>(s)*MAX_PRN+prn];
+}
+
+/// @details Interpolate the state (position and clock) of all satellites at
+///          an epoch. The result has the layout of Sp3::epoch_data, aka
+///          the x components of all satellites, then y, z and clock.
+///          Values depending on a missing value (of any node) are NaN; when
+///          t is exactly on an epoch, the values of that epoch are returned.
+/// @param[in]  t     Seconds since the first epoch (see
+///                   Sp3::seconds_since_start)
+/// @param[out] state Array of (at least) 4*num_sats() elements
+/// @param[in]  order Interpolation order (in [1, max_order])
+/// @return  0 on success; 1 if t is outside the file (no extrapolation);
+///          2 if the order is invalid or the file holds too few epochs
+int
+Sp3::interpolate(double t, double* state, int order) const noexcept
+{
+  double c[max_order+1];
+  int first, nodes, status;
+  if ((status=lagrange_coefficients(t/__interval, __num_epochs, order, first,
+    nodes, c))) {
+    return status;
+  }
+
+  const int n = 4*num_sats();
+  const double* row = epoch_data(first);
+  for (int i=0; i<n; i++) state[i] = c[0]*row[i];
+  for (int j=1; j<nodes; j++) {
+    row = epoch_data(first+j);
+    const double cj = c[j];
+    for (int i=0; i<n; i++) state[i] += cj*row[i];
+  }
+  return 0;
+}
+
+/// @details Interpolate the state (position and clock) of all satellites at
+///          a series of epochs (see Sp3::interpolate(double, double*, int)).
+/// @param[in]  t      Array of n epochs, in seconds since the first epoch
+/// @param[in]  n      Number of epochs
+/// @param[out] states Array of (at least) n*4*num_sats() elements; the state
+///                    at t[i] starts at states[i*4*num_sats()]
+/// @param[in]  order  Interpolation order (in [1, max_order])
+/// @return  0 on success; else the status of the first failed epoch (the
+///          states of the following epochs are not computed)
+int
+Sp3::interpolate(const double* t, int n, double* states, int order)
+const noexcept
+{
+  const std::size_t stride = 4*static_cast<std::size_t>(num_sats());
+  int status;
+  for (int i=0; i<n; i++) {
+    if ((status=interpolate(t[i], states+i*stride, order))) return status;
+  }
+  return 0;
+}
+
+/// @details Interpolate the state (position and clock) of one satellite.
+/// @param[in]  sat   Index of the satellite (see Sp3::sat_index)
+/// @param[in]  t     Seconds since the first epoch
+/// @param[out] state Array of 4 elements: x, y, z (m) and clock (sec)
+/// @param[in]  order Interpolation order (in [1, max_order])
+/// @return  0 on success; 1 if t is outside the file; 2 if the order is
+///          invalid or the file holds too few epochs; 3 if sat is invalid
+int
+Sp3::interpolate(int sat, double t, double* state, int order) const noexcept
+{
+  if (sat < 0 || sat >= num_sats()) return 3;
+  double c[max_order+1];
+  int first, nodes, status;
+  if ((status=lagrange_coefficients(t/__interval, __num_epochs, order, first,
+    nodes, c))) {
+    return status;
+  }
+
+  const int ns = num_sats();
+  for (int k=0; k<4; k++) state[k] = 0e0;
+  for (int j=0; j<nodes; j++) {
+    const double* row = epoch_data(first+j) + sat;
+    for (int k=0; k<4; k++) state[k] += c[j]*row[k*ns];
+  }
+  return 0;
+}
+
+/// @details Interpolate the position and clock of one satellite, and its
+///          velocity as the derivative of the interpolating polynomial of
+///          the positions (see lagrange_derivative_coefficients). The window
+///          is the same as for Sp3::interpolate; positions and clock are
+///          also the same (up to rounding). Values depending on a missing
+///          value (of any node) are NaN.
+/// @param[in]  sat   Index of the satellite (see Sp3::sat_index)
+/// @param[in]  t     Seconds since the first epoch
+/// @param[out] state Array of 6 elements: x, y, z (m) and vx, vy, vz (m/sec)
+/// @param[out] clk   Clock correction (sec)
+/// @param[in]  order Interpolation order (in [1, max_order])
+/// @return  0 on success; 1 if t is outside the file; 2 if the order is
+///          invalid or the file holds too few epochs; 3 if sat is invalid
+int
+Sp3::state_and_clock(int sat, double t, double* state, double& clk,
+  int order) const noexcept
+{
+  if (sat < 0 || sat >= num_sats()) return 3;
+  double c[max_order+1], dc[max_order+1];
+  int first, status;
+  if ((status=lagrange_derivative_coefficients(t/__interval, __num_epochs,
+    order, first, c, dc))) {
+    return status;
+  }
+
+  const int ns = num_sats();
+  double s[4] = {0e0, 0e0, 0e0, 0e0}, v[3] = {0e0, 0e0, 0e0};
+  for (int j=0; j<=order; j++) {
+    const double* row = epoch_data(first+j) + sat;
+    for (int k=0; k<3; k++) {
+      s[k] += c[j]*row[k*ns];
+      v[k] += dc[j]*row[k*ns];
+    }
+    s[3] += c[j]*row[3*ns];
+  }
+  const double inv = 1e0 / __interval;
+  for (int k=0; k<3; k++) {
+    state[k]   = s[k];
+    state[3+k] = v[k]*inv;
+  }
+  clk = s[3];
+  return 0;
+}
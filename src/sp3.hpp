@@ -0,0 +1,167 @@
+#ifndef __SP3_ORBIT_HPP__
+#define __SP3_ORBIT_HPP__
+
+/// @file      sp3.hpp
+///
+/// @version   0.10
+///
+/// @author    xanthos@mail.ntua.gr <br>
+///            danast@mail.ntua.gr
+///
+/// @brief     Reader and interpolator for SP3-c/d precise orbit files.
+///
+/// @details   An Sp3 instance loads a whole SP3-c or SP3-d file in a
+///            contiguous epoch x satellite array of positions and clock
+///            corrections and interpolates them (all satellites at once) via
+///            barycentric Lagrange interpolation. For the equally spaced
+///            epochs of an SP3 file, the barycentric weights only depend on
+///            the interpolation order and are precomputed (see
+///            lagrange.hpp); an interpolation at any epoch costs (order+1)
+///            divisions plus a weighted sum of (order+1) rows of the array.
+///
+/// @see       SP3-c: ftp://igs.org/pub/data/format/sp3c.txt <br>
+///            SP3-d: ftp://igs.org/pub/data/format/sp3d.pdf
+///
+/// @copyright Copyright © 2019 Dionysos Satellite Observatory, <br>
+///            National Technical University of Athens. <br>
+///            This work is free. You can redistribute it and/or modify it under
+///            the terms of the Do What The Fuck You Want To Public License,
+///            Version 2, as published by Sam Hocevar. See http://www.wtfpl.net/
+///            for more details.
+
+#include <string>
+#include <vector>
+#include "ggdatetime/dtcalendar.hpp"
+#include "satsys.hpp"
+#include "lagrange.hpp"
+
+namespace ngpt
+{
+
+/// @class Sp3
+///
+/// An SP3-c/d (position) file, loaded in memory. For every epoch, the
+/// satellite states are stored component-wise, i.e. the x coordinates of all
+/// satellites, then the y coordinates, then z and then the clock corrections
+/// (see Sp3::epoch_data); positions are in meters and clock corrections in
+/// seconds. Missing or bad values (zero positions or 999999.999999 clocks)
+/// are NaN, and so is any interpolated value depending on them.
+///
+/// The epochs are assumed equally spaced (by the interval in the header,
+/// starting at the first epoch of the header); an epoch missing from the
+/// file has all its values missing.
+class Sp3
+{
+public:
+  /// Max interpolation order (aka polynomial degree) supported
+  static constexpr int max_order { lagrange_max_order };
+
+  /// @brief Constructor from filename; loads the whole file
+  explicit
+  Sp3(const char*);
+
+  /// @brief SP3 version ('c' or 'd')
+  char
+  version() const noexcept
+  {return __version;}
+
+  /// @brief Number of epochs (as in the header)
+  int
+  num_epochs() const noexcept
+  {return __num_epochs;}
+
+  /// @brief Number of satellites (as in the header)
+  int
+  num_sats() const noexcept
+  {return static_cast<int>(__prn.size());}
+
+  /// @brief Epoch interval in seconds
+  double
+  interval() const noexcept
+  {return __interval;}
+
+  /// @brief First epoch (in the time system of the file)
+  ngpt::datetime<ngpt::seconds>
+  start_epoch() const noexcept
+  {return __start;}
+
+  /// @brief Coordinate system (e.g. "IGS14")
+  const std::string&
+  coordinate_system() const noexcept
+  {return __crd_sys;}
+
+  /// @brief Time system (e.g. "GPS")
+  const std::string&
+  time_system() const noexcept
+  {return __time_sys;}
+
+  /// @brief Satellite system of the i-th satellite
+  SATELLITE_SYSTEM
+  satsys(int sat) const noexcept
+  {return __sys[sat];}
+
+  /// @brief PRN of the i-th satellite
+  int
+  prn(int sat) const noexcept
+  {return __prn[sat];}
+
+  /// @brief Index of a satellite (-1 if not in the file)
+  int
+  sat_index(SATELLITE_SYSTEM s, int prn) const noexcept;
+
+  /// @brief Values of an epoch; x, y, z (m) and clock (sec), each holding
+  ///        num_sats() elements
+  const double*
+  epoch_data(int epoch) const noexcept
+  {return __data.data() + static_cast<std::size_t>(epoch)*4*num_sats();}
+
+  /// @brief Seconds from the first epoch to t
+  template<typename T>
+    double
+    seconds_since_start(const ngpt::datetime<T>& t) const noexcept
+  {
+    return ngpt::delta_sec<T, ngpt::seconds>(t, __start)
+      .to_fractional_seconds();
+  }
+
+  /// @brief Interpolate the state of all satellites at an epoch
+  int
+  interpolate(double t, double* state, int order=9) const noexcept;
+
+  /// @brief Interpolate the state of all satellites at a series of epochs
+  int
+  interpolate(const double* t, int n, double* states, int order=9)
+  const noexcept;
+
+  /// @brief Interpolate the state of one satellite at an epoch
+  int
+  interpolate(int sat, double t, double* state, int order=9) const noexcept;
+
+  /// @brief Interpolate the position, velocity and clock of one satellite
+  ///        at an epoch
+  int
+  state_and_clock(int sat, double t, double* state, double& clk,
+    int order=9) const noexcept;
+
+private:
+  /// @brief Resolve the file (header and records)
+  int
+  load(const char* filename) noexcept;
+
+  char                          __version;    ///< 'c' or 'd'
+  ngpt::datetime<ngpt::seconds> __start;      ///< First epoch
+  int                           __num_epochs; ///< Number of epochs
+  double                        __interval;   ///< Epoch interval (sec)
+  std::string                   __crd_sys;    ///< Coordinate system
+  std::string                   __time_sys;   ///< Time system
+  std::vector<SATELLITE_SYSTEM> __sys;        ///< Satellite systems
+  std::vector<int>              __prn;        ///< PRNs
+  std::vector<int>              __index;      ///< Index of every satellite,
+                                              ///< per system and PRN (-1 if
+                                              ///< not in the file)
+  std::vector<double>           __data;       ///< [epoch][x,y,z,clk][sat]
+}; // Sp3
+
+} // ngpt
+
+#endif
@@ -1,10 +1,16 @@
 #include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
 #include "navrnx.hpp"
 #include "ggdatetime/datetime_write.hpp"
 
 using ngpt::NavigationRnx;
 using ngpt::NavDataFrame;
 using ngpt::SATELLITE_SYSTEM;
+using ngpt::GloIntegrator;
+using ngpt::GloIntegrationStats;
 using ngpt::seconds;
 using ngpt::gps_week;
 
@@ -24,14 +30,53 @@ int main()
   frame.set_toc(ngpt::datetime<seconds>(ngpt::year(2012), ngpt::month(9),
     ngpt::day_of_month(7), seconds(11700L)));
 
+  // reference values, GLONASS ICD Appendix J.6 (ti - tb = 600 sec)
+  const double xref[] = {7523174.853e0, -10506962.176e0, 21999239.866e0};
+
   double state[6], clock;
   ngpt::datetime<seconds> ti = ngpt::datetime<seconds>(ngpt::year(2012), ngpt::month(9),
     ngpt::day_of_month(7), seconds(12300L));
-  frame.glo_stateNclock<seconds>(ti, state, clock);
-  printf("\n x=%+20.5f  y=%+20.5f  z=%+20.5f meters", state[0], state[1], state[2]);
-  printf("\nVx=%+20.5f Vy=%+20.5f Vz=%+20.5f meters/sec", state[3], state[4], state[5]);
-  printf("\nDx=%20.5f  Dy=%20.5f  Dz=%20.5f  meters", std::abs(state[0]-7523174.853), 
-    std::abs(state[1]+10506962.176), std::abs(state[2]-21999239.866));
-  std::cout<<"\n";
-  return 0;
+  int status = 0;
+  const GloIntegrator integrators[] = {GloIntegrator::rk4, GloIntegrator::dopri5};
+  const char* names[] = {"RK4 (h=60 sec)", "Dormand-Prince 5(4)"};
+  double pos[2][3];
+  GloIntegrationStats stats[2];
+  for (int k=0; k<2; k++) {
+    status += frame.glo_stateNclock<seconds>(ti, state, clock, integrators[k],
+      &stats[k]);
+    printf("\n%s", names[k]);
+    printf("\n x=%+20.5f  y=%+20.5f  z=%+20.5f meters", state[0], state[1], state[2]);
+    printf("\nVx=%+20.5f Vy=%+20.5f Vz=%+20.5f meters/sec", state[3], state[4], state[5]);
+    printf("\nDx=%20.5f  Dy=%20.5f  Dz=%20.5f  meters", std::abs(state[0]-xref[0]), 
+      std::abs(state[1]-xref[1]), std::abs(state[2]-xref[2]));
+    printf("\nSteps: %d (rejected: %d), derivative evaluations: %d",
+      stats[k].steps, stats[k].rejected, stats[k].derivatives);
+    std::copy(state, state+3, pos[k]);
+  }
+
+  // cost of a propagation over the whole validity interval (15 min)
+  auto tb_mt = frame.toc();
+  tb_mt.add_seconds(seconds(10800L));
+  const double tb = tb_mt.sec().to_fractional_seconds();
+  double tm[2], sum = 0e0;
+  const int repeats = 10000;
+  for (int k=0; k<2; k++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r=0; r<repeats; r++) {
+      frame.glo_ecef(tb+900e0, tb, state, integrators[k], &stats[k]);
+      sum += state[0];
+    }
+    auto stop = std::chrono::steady_clock::now();
+    tm[k] = std::chrono::duration<double>(stop-start).count()/repeats;
+    printf("\n%-20s 15 min: %3d steps, %3d derivatives, %8.3f usec/satellite",
+      names[k], stats[k].steps, stats[k].derivatives, tm[k]*1e6);
+  }
+  printf("\nSpeedup: %.2f (checksum: %.3f)", tm[0]/tm[1], sum/repeats/2);
+
+  // the two integrators must agree at the mm level
+  const double d = std::sqrt((pos[0][0]-pos[1][0])*(pos[0][0]-pos[1][0])
+    + (pos[0][1]-pos[1][1])*(pos[0][1]-pos[1][1])
+    + (pos[0][2]-pos[1][2])*(pos[0][2]-pos[1][2]));
+  printf("\nRK4 - Dormand-Prince: %.5f meters\n", d);
+  return status || d>1e-3;
 }
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "antenna_pcv.hpp"
+#include "antex.hpp"
+
+using ngpt::AntennaPcv;
+using ngpt::AntennaPcvList;
+using ngpt::AntennaPcoList;
+using ngpt::ObservationCode;
+using ngpt::ReceiverAntenna;
+using ngpt::SATELLITE_SYSTEM;
+
+/// A bilinear function of azimuth and zenith (within any grid cell the
+/// interpolation must reproduce it exactly), periodic in azimuth at the
+/// grid nodes
+double
+f(double azi, double zen) noexcept
+{
+  return 1.5e0 - 0.02e0*zen + 0.001e0*std::abs(azi-180e0)*(1e0+0.01e0*zen);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc>2) {
+    std::cerr<<"\n[ERROR] Run as: $>testAntennaPcv [antex]\n";
+    return 1;
+  }
+
+  // a typical receiver antenna grid: DAZI=5, ZEN1/ZEN2/DZEN = 0/90/5
+  ObservationCode obs;
+  obs.band() = 1;
+  AntennaPcv pcv(obs, SATELLITE_SYSTEM::gps, 0e0, 90e0, 5e0, 5e0);
+  std::cout<<"\n# Grid: "<<pcv.num_azimuth()<<" azimuths x "<<pcv.num_zenith()
+    <<" zenith angles";
+  for (int j=0; j<pcv.num_zenith(); j++) pcv.noazi()[j] = f(180e0, 5e0*j);
+  for (int k=0; k<pcv.num_azimuth(); k++) {
+    for (int j=0; j<pcv.num_zenith(); j++) {
+      pcv.azimuth_row(k)[j] = f(5e0*k, 5e0*j);
+    }
+  }
+
+  // interpolation (within cells where f is bilinear), azimuth wrap-around
+  // and zenith clamping
+  double max_err = 0e0;
+  for (double azi=0e0; azi<180e0; azi+=0.7e0) {
+    for (double zen=0e0; zen<=90e0; zen+=0.3e0) {
+      double err = std::abs(pcv.pcv(azi, zen) - f(azi, zen));
+      if (err>max_err) max_err = err;
+      err = std::abs(pcv.pcv(azi-360e0, zen) - f(azi, zen));
+      if (err>max_err) max_err = err;
+    }
+  }
+  std::printf("\n# Max interpolation error  : %.3e mm", max_err);
+  const double clamp_err = std::abs(pcv.pcv(10e0, 95e0) - f(10e0, 90e0))
+    + std::abs(pcv.pcv(10e0, -1e0) - f(10e0, 0e0));
+  std::printf("\n# Clamping error           : %.3e mm", clamp_err);
+  const double noazi_err = std::abs(pcv.noazi_pcv(12.5e0)
+    - 0.5e0*(f(180e0, 10e0)+f(180e0, 15e0)));
+  std::printf("\n# NOAZI interpolation error: %.3e mm", noazi_err);
+
+  // batched vs scalar, for a large number of lines-of-sight
+  const std::size_t n = 100000;
+  std::vector<double> azi(n), zen(n), val(n);
+  for (std::size_t i=0; i<n; i++) {
+    azi[i] = std::fmod(i*37.13e0, 360e0) - 180e0;
+    zen[i] = std::fmod(i*7.31e0, 90e0);
+  }
+  auto start = std::chrono::steady_clock::now();
+  pcv.pcv(n, azi.data(), zen.data(), val.data());
+  auto stop = std::chrono::steady_clock::now();
+  double batch_diff = 0e0;
+  for (std::size_t i=0; i<n; i++) {
+    batch_diff = std::max(batch_diff, std::abs(val[i]-pcv.pcv(azi[i], zen[i])));
+  }
+  std::printf("\n# Batch - scalar           : %.3e mm", batch_diff);
+  std::printf("\n# Batch: %.1f ns/line-of-sight",
+    std::chrono::duration<double>(stop-start).count()/n*1e9);
+
+  // PCV grids from an ANTEX file
+  if (argc==2) {
+    ngpt::Antex atx(argv[1]);
+    ReceiverAntenna ant("TRM41249.00");
+    AntennaPcoList pco;
+    AntennaPcvList pcvs;
+    int status = atx.get_antenna_pcv(ant, pco, pcvs);
+    std::cout<<"\n# PCV grids for antenna \""<<ant.__underlying_char__()
+      <<"\": status "<<status;
+    for (const auto& p : pcvs.__vecref__()) {
+      std::printf("\n\t%c%02d DAZI=%.1f %d zenith angles, pcv(45,30)=%+.2f mm",
+        ngpt::satsys_to_char(p.system()), p.obs_code().band(), p.dazi(),
+        p.num_zenith(), p.pcv(45e0, 30e0));
+    }
+    if (status || pcvs.__vecref__().size()!=pco.__vecref__().size()
+        || !pcvs.find(SATELLITE_SYSTEM::gps, 1)) {
+      return 1;
+    }
+  }
+
+  std::cout<<"\n";
+  return (max_err>1e-12 || clamp_err>1e-12 || noazi_err>1e-12
+    || batch_diff!=0e0);
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "antex.hpp"
+
+using ngpt::Antex;
+using ngpt::ReceiverAntenna;
+using ngpt::AntennaPcoList;
+using ngpt::AntennaPcvList;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::seconds;
+
+/// Compare the answers of two instances for a receiver antenna; returns the
+/// number of differences
+int
+compare(Antex& a, Antex& b, const ReceiverAntenna& ant)
+{
+  AntennaPcoList pco1, pco2;
+  AntennaPcvList pcv1, pcv2;
+  int diffs = 0;
+  for (int serial=0; serial<2; serial++) {
+    int s1 = a.get_antenna_pcv(ant, pco1, pcv1, serial);
+    int s2 = b.get_antenna_pcv(ant, pco2, pcv2, serial);
+    if (s1!=s2) {++diffs; continue;}
+    if (s1) continue;
+    auto& p1 = pco1.__vecref__();
+    auto& p2 = pco2.__vecref__();
+    auto& v1 = pcv1.__vecref__();
+    auto& v2 = pcv2.__vecref__();
+    if (p1.size()!=p2.size() || v1.size()!=v2.size()) {++diffs; continue;}
+    for (std::size_t i=0; i<p1.size(); i++) {
+      if (p1[i].system()!=p2[i].system() || p1[i].dn()!=p2[i].dn()
+          || p1[i].de()!=p2[i].de() || p1[i].du()!=p2[i].du()
+          || p1[i].obs_code().band()!=p2[i].obs_code().band()) ++diffs;
+      const int n = (v1[i].num_azimuth()+1)*v1[i].num_zenith();
+      if (v1[i].num_azimuth()!=v2[i].num_azimuth()
+          || v1[i].num_zenith()!=v2[i].num_zenith()
+          || std::memcmp(v1[i].grid(), v2[i].grid(), n*sizeof(double))) ++diffs;
+    }
+  }
+  return diffs;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3) {
+    std::cerr<<"\n[ERROR] Run as: $>testAntexCache [antex] [cache]\n";
+    return 1;
+  }
+  std::remove(argv[2]);
+
+  // (1) no cache: parse the ANTEX and write the cache
+  auto start = std::chrono::steady_clock::now();
+  Antex first (argv[1], argv[2]);
+  auto stop = std::chrono::steady_clock::now();
+  std::printf("\n# Parse + write cache: %10.6f sec (uses cache: %d)",
+    std::chrono::duration<double>(stop-start).count(), first.uses_cache());
+
+  // (2) valid cache: map it
+  start = std::chrono::steady_clock::now();
+  Antex cached (argv[1], argv[2]);
+  stop = std::chrono::steady_clock::now();
+  std::printf("\n# Load cache         : %10.6f sec (uses cache: %d)",
+    std::chrono::duration<double>(stop-start).count(), cached.uses_cache());
+  start = std::chrono::steady_clock::now();
+  Antex text (argv[1]);
+  stop = std::chrono::steady_clock::now();
+  std::printf("\n# Index ANTEX        : %10.6f sec",
+    std::chrono::duration<double>(stop-start).count());
+  if (first.uses_cache() || !cached.uses_cache()
+      || cached.num_antennas()!=text.num_antennas()) {
+    std::cerr<<"\n[ERROR] Cache not written/used";
+    return 1;
+  }
+
+  // (3) every antenna in the file, queried from the cache and from the text
+  std::ifstream fin (argv[1]);
+  char line[256];
+  int diffs = 0, queries = 0;
+  AntennaPcoList pco1, pco2;
+  AntennaPcvList pcv1, pcv2;
+  while (fin.getline(line, 256)) {
+    if (std::strlen(line)<76 || std::strncmp(line+60, "TYPE / SERIAL NO", 16)) {
+      continue;
+    }
+    ReceiverAntenna ant (line);
+    diffs += compare(cached, text, ant);
+    ant.set_serial_nr(line+20);
+    diffs += compare(cached, text, ant);
+    queries += 4;
+    // satellite antennas (serials of receiver antennas may fail to resolve)
+    SATELLITE_SYSTEM ss;
+    int prn;
+    try {
+      ss  = ngpt::char_to_satsys(line[20]);
+      prn = std::stoi(std::string(line+21, 2));
+    } catch (std::exception&) {
+      continue;
+    }
+    for (int y=1990; y<=2030; y+=2) {
+      ngpt::datetime<seconds> t (ngpt::year(y), ngpt::month(6),
+        ngpt::day_of_month(1), seconds(0));
+      int s1 = cached.get_antenna_pcv(prn, ss, t, pco1, pcv1);
+      int s2 = text.get_antenna_pcv(prn, ss, t, pco2, pcv2);
+      if (s1!=s2 || pco1.__vecref__().size()!=pco2.__vecref__().size()
+          || pcv1.__vecref__().size()!=pcv2.__vecref__().size()) ++diffs;
+      ++queries;
+    }
+  }
+  std::printf("\n# Queries: %d, differences (cache - text): %d", queries, diffs);
+
+  // query latency, receiver antenna PCO/PCV from the cache and from the text
+  ReceiverAntenna ant ("TRM41249.00");
+  double qt[2];
+  for (int k=0; k<2; k++) {
+    Antex& atx = k ? text : cached;
+    start = std::chrono::steady_clock::now();
+    for (int i=0; i<1000; i++) atx.get_antenna_pcv(ant, pco1, pcv1);
+    stop = std::chrono::steady_clock::now();
+    qt[k] = std::chrono::duration<double>(stop-start).count();
+  }
+  std::printf("\n# 1000 PCO/PCV queries: cache %10.6f sec, text %10.6f sec",
+    qt[0], qt[1]);
+
+  // (4) a copy of the ANTEX file, modified in place (same size, same
+  // modification time); its cache must be rejected
+  const std::string copy = std::string(argv[2]) + ".atx";
+  const std::string copy_cache = copy + ".cache";
+  {
+    std::ifstream src (argv[1], std::ios_base::binary);
+    std::ofstream dst (copy, std::ios_base::binary);
+    dst << src.rdbuf();
+  }
+  bool stale_used;
+  {
+    Antex a (copy.c_str(), copy_cache.c_str());
+    struct stat sb;
+    ::stat(copy.c_str(), &sb);
+    std::fstream f (copy, std::ios_base::in | std::ios_base::out
+                          | std::ios_base::binary);
+    f.seekp(sb.st_size/2);
+    char c;
+    f.get(c);
+    f.seekp(sb.st_size/2);
+    f.put(c==' ' ? '0' : ' ');
+    f.close();
+    struct timeval tv[2];
+    tv[0].tv_sec = tv[1].tv_sec = sb.st_mtime;
+    tv[0].tv_usec = tv[1].tv_usec = 0;
+    ::utimes(copy.c_str(), tv);
+    try {
+      Antex b (copy.c_str(), copy_cache.c_str());
+      stale_used = b.uses_cache();
+    } catch (std::exception&) {
+      // the modification broke the ANTEX file; the cache was still rejected
+      stale_used = false;
+    }
+  }
+  std::printf("\n# Stale cache used: %d\n", stale_used);
+  std::remove(copy.c_str());
+  std::remove(copy_cache.c_str());
+
+  return (diffs || stale_used);
+}
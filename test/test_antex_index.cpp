@@ -0,0 +1,64 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include "antex.hpp"
+
+using ngpt::Antex;
+using ngpt::ReceiverAntenna;
+using ngpt::AntennaPcoList;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::seconds;
+
+/// Time the antenna index: building it (at construction) and repeated
+/// receiver and satellite antenna queries, e.g. one per station of a network
+/// and one per satellite of a constellation.
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testAntexIndex [antex]\n";
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Antex atx (argv[1]);
+  auto stop = std::chrono::steady_clock::now();
+  std::printf("\n# Indexed %zu antennas in %.6f sec", atx.num_antennas(),
+    std::chrono::duration<double>(stop-start).count());
+
+  AntennaPcoList pco;
+  int EXIT_STATUS = 0;
+
+  // repeated receiver antenna queries; all must give the same answer
+  ReceiverAntenna rec ("TRM41249.00");
+  const int status = atx.get_antenna_pco(rec, pco);
+  const int num_queries = 1000;
+  int differ = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i=0; i<num_queries; i++) {
+    differ += (atx.get_antenna_pco(rec, pco) != status);
+  }
+  stop = std::chrono::steady_clock::now();
+  std::printf("\n# %d receiver antenna queries in %.6f sec (status: %d, "
+    "differing: %d)", num_queries,
+    std::chrono::duration<double>(stop-start).count(), status, differ);
+  if (differ) EXIT_STATUS = 1;
+
+  // one query per satellite of the GPS, GLONASS and Galileo constellations
+  const SATELLITE_SYSTEM systems[] = {SATELLITE_SYSTEM::gps,
+    SATELLITE_SYSTEM::glonass, SATELLITE_SYSTEM::galileo};
+  auto t = ngpt::datetime<seconds>(ngpt::year(2017), ngpt::month(10),
+    ngpt::day_of_month(4), seconds(0));
+  int queries = 0, found = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto sys : systems) {
+    for (int prn=1; prn<=36; prn++) {
+      ++queries;
+      if (!atx.get_antenna_pco(prn, sys, t, pco)) ++found;
+    }
+  }
+  stop = std::chrono::steady_clock::now();
+  std::printf("\n# %d satellite antenna queries in %.6f sec (found: %d)\n",
+    queries, std::chrono::duration<double>(stop-start).count(), found);
+
+  return EXIT_STATUS;
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "antex.hpp"
+#include "ggdatetime/datetime_read.hpp"
+
+using ngpt::Antex;
+using ngpt::AntennaPcoList;
+using ngpt::SatelliteAntennaPco;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::seconds;
+typedef ngpt::datetime<seconds> Epoch;
+
+/// A satellite antenna record, as read (in file order) by a plain scan of the
+/// ANTEX file
+struct Record
+{
+  SATELLITE_SYSTEM ss;
+  int              prn;
+  Epoch            from, to;
+  bool             has_from = false, has_to = false;
+  double           dn;        ///< North (x) PCO of the first frequency
+};
+
+/// Shift an epoch by +/- 1 sec
+Epoch
+shift(const Epoch& t, long ds)
+{
+  long mjd = t.mjd().as_underlying_type();
+  long sec = t.sec().as_underlying_type() + ds;
+  if (sec<0) {--mjd; sec += 86400L;}
+  if (sec>=86400L) {++mjd; sec -= 86400L;}
+  return Epoch(ngpt::modified_julian_day(mjd), seconds(sec));
+}
+
+/// First record (in file order) of a satellite, valid at t; -1 if none
+int
+reference(const std::vector<Record>& recs, SATELLITE_SYSTEM ss, int prn,
+  const Epoch& t)
+{
+  for (std::size_t i=0; i<recs.size(); i++) {
+    const Record& r = recs[i];
+    if (r.ss==ss && r.prn==prn && r.has_from && r.from<=t
+        && (!r.has_to || t<=r.to)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testAntexIntervals [antex]\n";
+    return 1;
+  }
+
+  // scan the file for satellite antenna records
+  std::vector<Record> recs;
+  {
+    std::ifstream fin (argv[1]);
+    char line[256];
+    bool in_sat = false, first_neu = false;
+    while (fin.getline(line, 256)) {
+      if (std::strlen(line)<61) continue;
+      if (!std::strncmp(line+60, "TYPE / SERIAL NO", 16)) {
+        in_sat = false;
+        try {
+          Record r;
+          r.ss  = ngpt::char_to_satsys(line[20]);
+          r.prn = std::stoi(std::string(line+21, 2));
+          recs.push_back(r);
+          in_sat = first_neu = true;
+        } catch (std::exception&) {}
+      } else if (in_sat && !std::strncmp(line+60, "VALID FROM", 10)) {
+        recs.back().from = ngpt::strptime_ymd_hms<seconds>(line);
+        recs.back().has_from = true;
+      } else if (in_sat && !std::strncmp(line+60, "VALID UNTIL", 11)) {
+        recs.back().to = ngpt::strptime_ymd_hms<seconds>(line);
+        recs.back().has_to = true;
+      } else if (in_sat && first_neu
+                 && !std::strncmp(line+60, "NORTH / EAST / UP", 17)) {
+        recs.back().dn = std::stod(std::string(line, 10));
+        first_neu = false;
+      }
+    }
+  }
+  std::cout<<"\n# Satellite antenna records: "<<recs.size();
+  if (recs.empty()) return 1;
+
+  Antex atx (argv[1]);
+  AntennaPcoList pco;
+
+  // (1) every satellite, every 5 days from 1995 to 2025, plus the bounds of
+  //     every record (and the second before "VALID FROM"/after "VALID UNTIL")
+  std::vector<Epoch> epochs;
+  for (long mjd=49718; mjd<60676; mjd+=5) {
+    epochs.emplace_back(ngpt::modified_julian_day(mjd), seconds(43200));
+  }
+  for (const auto& r : recs) {
+    if (r.has_from) {
+      epochs.push_back(r.from);
+      epochs.push_back(shift(r.from, -1));
+    }
+    if (r.has_to) {
+      epochs.push_back(r.to);
+      epochs.push_back(shift(r.to, 1));
+    }
+  }
+  int diffs = 0, queries = 0;
+  for (const auto& r : recs) {
+    for (const auto& t : epochs) {
+      int ref = reference(recs, r.ss, r.prn, t);
+      int status = atx.get_antenna_pco(r.prn, r.ss, t, pco);
+      if ((ref<0) != (status!=0)
+          || (ref>=0 && pco.__vecref__().front().dn()!=recs[ref].dn)) {
+        ++diffs;
+      }
+      ++queries;
+    }
+  }
+  std::printf("\n# Queries: %d, differences (index - scan): %d", queries, diffs);
+
+  // (2) bulk query over a 10-day span; every epoch of the span must resolve
+  //     to a record of the list
+  Epoch start (ngpt::modified_julian_day(55197), seconds(0));
+  Epoch stop  (ngpt::modified_julian_day(55207), seconds(0));
+  std::vector<SatelliteAntennaPco> list;
+  auto t0 = std::chrono::steady_clock::now();
+  int status = atx.get_antenna_pco(start, stop, list);
+  auto t1 = std::chrono::steady_clock::now();
+  int bulk_diffs = status;
+  for (const auto& r : recs) {
+    for (long s=0; s<=10*86400L; s+=3600L) {
+      Epoch t (ngpt::modified_julian_day(55197+s/86400L), seconds(s%86400L));
+      bool in_list = false;
+      int single = atx.get_antenna_pco(r.prn, r.ss, t, pco);
+      for (auto& e : list) {
+        if (e.system==r.ss && e.prn==r.prn && e.from<=t && t<=e.to
+            && !single && e.pco.__vecref__().size()==pco.__vecref__().size()
+            && e.pco.__vecref__().front().dn()==pco.__vecref__().front().dn()) {
+          in_list = true;
+        }
+      }
+      if (in_list == static_cast<bool>(single)) ++bulk_diffs;
+    }
+  }
+  std::printf("\n# Bulk query: %zu records in %.6f sec, differences: %d",
+    list.size(), std::chrono::duration<double>(t1-t0).count(), bulk_diffs);
+
+  // (3) latency of the epoch lookup
+  t0 = std::chrono::steady_clock::now();
+  int found = 0;
+  for (int k=0; k<10; k++) {
+    for (const auto& t : epochs) {
+      found += !atx.get_antenna_pco(recs[k%recs.size()].prn,
+        recs[k%recs.size()].ss, t, pco);
+    }
+  }
+  t1 = std::chrono::steady_clock::now();
+  std::printf("\n# Lookup + PCO: %.1f ns/query (%d found)\n",
+    std::chrono::duration<double>(t1-t0).count()/(10*epochs.size())*1e9, found);
+
+  return (diffs || bulk_diffs);
+}
@@ -48,6 +48,17 @@ int main(int argc, char* argv[])
     }
   }
 
+  // the slot -> frequency channel map at d2; every entry must agree with the
+  // single-satellite query
+  std::vector<ngpt::GloFrequencyChannel> channels;
+  int diffs = sat.get_frequency_channels(d2, channels);
+  for (const auto& c : channels) {
+    status = sat.get_frequency_channel(c.svn, d2, frq, prn);
+    if (status || prn!=c.slot+100 || frq!=c.ifrqn) ++diffs;
+    std::cout<<"\n"<<ngpt::strftime_ymd_hms(d2)<<" SLOT: "<<c.slot<<" SVN: "<<c.svn<<" FRQ: "<<c.ifrqn;
+  }
+  std::cout<<"\nGLONASS slots: "<<channels.size()<<", differences: "<<diffs;
+
   std::cout<<"\n";
-  return 0;
+  return (diffs!=0);
 }
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "clkrnx.hpp"
+
+using ngpt::ClockRnx;
+
+/// Clock records of a series, as resolved by a plain (std::strtod) scan of
+/// the file; seconds since the first day of the file vs bias
+typedef std::map<long, double> Series;
+
+/// Plain scan of the file
+std::map<std::string, Series>
+scan(const char* fn, bool receivers, long& mjd0)
+{
+  std::ifstream fin (fn);
+  std::string line;
+  std::getline(fin, line);
+  const int o = (std::strtod(line.substr(0, 9).c_str(), nullptr) > 3.035) ? 5 : 0;
+  while (std::getline(fin, line) && line.find("END OF HEADER")==std::string::npos) ;
+  std::map<std::string, Series> all;
+  mjd0 = -1;
+  while (std::getline(fin, line)) {
+    if (line.compare(0, 2, "AS") && (!receivers || line.compare(0, 2, "AR"))) continue;
+    std::string name = line.substr(3, 4+o);
+    name.erase(name.find_last_not_of(' ')+1);
+    const char* p = line.c_str()+8+o;
+    char* e;
+    int y = std::strtol(p, &e, 10), mo = std::strtol(e, &e, 10);
+    int d = std::strtol(e, &e, 10), h = std::strtol(e, &e, 10);
+    int mi = std::strtol(e, &e, 10);
+    double sec = std::strtod(e, &e);
+    std::strtol(e, &e, 10);
+    double bias = std::strtod(e, &e);
+    const long mjd = ngpt::datetime<ngpt::seconds>(ngpt::year(y),
+      ngpt::month(mo), ngpt::day_of_month(d), ngpt::seconds(0))
+      .mjd().as_underlying_type();
+    if (mjd0 < 0) mjd0 = mjd;
+    all[name][(mjd-mjd0)*86400L + h*3600L + mi*60L + std::lround(sec)] = bias;
+  }
+  return all;
+}
+
+/// Compare the loaded series with the scan (for the scanned records within
+/// [lo, hi], seconds since the first day of the file); returns the number
+/// of differences
+int
+compare(const ClockRnx& clk, const std::map<std::string, Series>& ref,
+  long mjd0, long lo, long hi)
+{
+  int diffs = 0, found = 0, present = 0;
+  const long start = (clk.start_epoch().mjd().as_underlying_type()-mjd0)*86400L
+    + std::lround(clk.start_epoch().sec().to_fractional_seconds());
+  for (const auto& s : ref) {
+    int series = -1;
+    for (int i=0; i<clk.num_series(); i++) if (clk.name(i)==s.first) series = i;
+    for (const auto& r : s.second) {
+      if (r.first < lo || r.first > hi) continue;
+      ++found;
+      if (series < 0) {
+        ++diffs;
+        continue;
+      }
+      const double dt = static_cast<double>(r.first-start);
+      const long k = std::lround(dt/clk.interval());
+      if (k<0 || k>=clk.num_epochs() || clk.biases(series)[k]!=r.second) ++diffs;
+    }
+  }
+  for (int i=0; i<clk.num_series(); i++) {
+    for (int k=0; k<clk.num_epochs(); k++) present += !std::isnan(clk.biases(i)[k]);
+  }
+  return diffs + (found != present);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testClkRnx [clock RINEX]\n";
+    return 1;
+  }
+  long mjd0;
+  auto sats = scan(argv[1], false, mjd0);
+  auto all = scan(argv[1], true, mjd0);
+  int errors = 0;
+
+  // (1) load all; satellites only (timed) and with receivers
+  auto start = std::chrono::steady_clock::now();
+  ClockRnx clk (argv[1]);
+  auto stop = std::chrono::steady_clock::now();
+  std::printf("\n# Version: %.2f, time system: %s, series: %d, epochs: %d, "
+    "interval: %.1f sec", clk.version(), clk.time_system().c_str(),
+    clk.num_series(), clk.num_epochs(), clk.interval());
+  std::printf("\n# Loaded (satellites) in %.3f sec",
+    std::chrono::duration<double>(stop-start).count());
+  int diffs = compare(clk, sats, mjd0, 0, 1L<<40) + (clk.num_series()!=(int)sats.size());
+  std::printf("\n# Satellites, differences: %d", diffs);
+  errors += diffs;
+
+  ClockRnx clkr (argv[1], false);
+  diffs = compare(clkr, all, mjd0, 0, 1L<<40) + (clkr.num_series()!=(int)all.size());
+  diffs += (clkr.receiver_index("NTUA") < 0);
+  std::printf("\n# Satellites and receivers, differences: %d", diffs);
+  errors += diffs;
+
+  // (2) interpolation; on the nodes, linear at midpoints, all vs one series
+  std::vector<double> b (clk.num_series());
+  int idiffs = 0;
+  for (int k=0; k+1<clk.num_epochs(); k+=7) {
+    const double t = k*clk.interval();
+    for (int order : {1, 5}) {
+      errors += clk.interpolate(t+0.5*clk.interval(), b.data(), order);
+      for (int i=0; i<clk.num_series(); i++) {
+        const double* bi = clk.biases(i);
+        double v;
+        const int status = clk.interpolate(i, t+0.5*clk.interval(), v, order);
+        if ((status==4) != std::isnan(b[i]) || (!status && v!=b[i])) ++idiffs;
+        if (order==1 && !status && std::abs(v-(bi[k]+bi[k+1])/2)>1e-18) ++idiffs;
+        if (!clk.interpolate(i, t, v, order) && v!=bi[k]) ++idiffs;
+      }
+    }
+  }
+  std::printf("\n# Interpolation, differences: %d", idiffs);
+  errors += idiffs;
+  errors += (clk.interpolate(0, -1e0, b[0]) != 1);
+  errors += (clk.interpolate(0, 0e0, b[0], 0) != 2);
+  errors += (clk.interpolate(clk.num_series(), 0e0, b[0]) != 3);
+  errors += (clk.sat_index(ngpt::SATELLITE_SYSTEM::gps, 1) < 0);
+
+  // (3) consecutive (overlapping) windows of an hour, vs the scan
+  ClockRnx win (argv[1], true, false);
+  int wdiffs = 0, windows = 0;
+  double wsec = 0e0;
+  const long span = static_cast<long>((clk.num_epochs()-1)*clk.interval());
+  for (long lo=0; lo<=span; lo+=3000, ++windows) {
+    const long hi = lo+3600;
+    const auto from = ngpt::datetime<ngpt::seconds>(
+      ngpt::modified_julian_day(mjd0), ngpt::seconds(lo));
+    const auto to = ngpt::datetime<ngpt::seconds>(
+      ngpt::modified_julian_day(mjd0), ngpt::seconds(hi));
+    start = std::chrono::steady_clock::now();
+    wdiffs += win.load_window(from, to);
+    stop = std::chrono::steady_clock::now();
+    wsec += std::chrono::duration<double>(stop-start).count();
+    wdiffs += compare(win, sats, mjd0, lo, hi);
+  }
+  std::printf("\n# Windows: %d, differences: %d (loaded in %.3f sec)\n",
+    windows, wdiffs, wsec);
+  errors += wdiffs;
+
+  return errors;
+}
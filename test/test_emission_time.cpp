@@ -0,0 +1,238 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include "navrnx.hpp"
+#include "emission_time.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::PreparedEphemeris;
+using ngpt::EmissionState;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::Sp3;
+
+/// A receiver (NTUA)
+const double rx[] = {4606844.3, 2017221.3, 3886519.2};
+
+/// Reference solution: fixed point iterations, re-evaluating the orbit
+/// (position only) at every iteration; returns the number of evaluations
+template<typename F>
+int
+brute_force(F&& position, double* pos, double& tau)
+{
+  constexpr double we = ngpt::sagnac_earth_rotation;
+  double x[3];
+  int evaluations = 0;
+  tau = ngpt::nominal_light_time;
+  for (int k=0; k<10; k++) {
+    position(tau, x);
+    ++evaluations;
+    const double ct = std::cos(we*tau), st = std::sin(we*tau);
+    pos[0] = ct*x[0] + st*x[1];
+    pos[1] = ct*x[1] - st*x[0];
+    pos[2] = x[2];
+    const double rho = std::sqrt((pos[0]-rx[0])*(pos[0]-rx[0])
+      + (pos[1]-rx[1])*(pos[1]-rx[1]) + (pos[2]-rx[2])*(pos[2]-rx[2]));
+    const double prev = tau;
+    tau = rho / ngpt::speed_of_light;
+    if (std::abs(tau-prev) < 1e-13) break;
+  }
+  return evaluations;
+}
+
+/// Max position (m) and light time (sec) difference of the solution
+void
+compare(const EmissionState* sats, const double* ref_pos, const double* ref_tau,
+  int n, double& max_pos, double& max_tau)
+{
+  max_pos = max_tau = 0e0;
+  for (int i=0; i<n; i++) {
+    if (std::isnan(ref_tau[i])) continue;
+    double d = 0e0;
+    for (int k=0; k<3; k++) {
+      d += (sats[i].state[k]-ref_pos[3*i+k])*(sats[i].state[k]-ref_pos[3*i+k]);
+    }
+    max_pos = std::max(max_pos, std::sqrt(d));
+    max_tau = std::max(max_tau, std::abs(sats[i].tau-ref_tau[i]));
+  }
+}
+
+/// Broadcast orbits of system S; all frames at (about) their ToE
+template<SATELLITE_SYSTEM S>
+int
+check_broadcast(const std::vector<NavDataFrame>& frames, const char* name)
+{
+  std::vector<PreparedEphemeris<S>> eph;
+  for (const auto& f : frames) if (f.sys()==S) eph.emplace_back(f);
+  if (eph.empty()) return 1;
+  const int n = static_cast<int>(eph.size());
+
+  // reception epochs (seconds of week), each near the ToE of the frame
+  std::vector<double> trx (n);
+  for (int i=0; i<n; i++) trx[i] = eph[i].toe() + 600e0 + i;
+  auto source = [&](int i, double tau, double* state, double& dtsv) {
+    return eph[i].state_and_clock(trx[i]-tau, state, dtsv);
+  };
+  auto position = [&](int i) {
+    return [&, i](double tau, double* x) {
+      double state[6], dtsv;
+      eph[i].state_and_clock(trx[i]-tau, state, dtsv);
+      std::copy(state, state+3, x);
+    };
+  };
+
+  std::vector<double> ref_pos (3*n), ref_tau (n);
+  int evaluations = 0;
+  for (int i=0; i<n; i++) {
+    evaluations += brute_force(position(i), &ref_pos[3*i], ref_tau[i]);
+  }
+
+  int errors = 0;
+  std::vector<EmissionState> sats (n);
+  for (int passes : {1, 2}) {
+    for (auto& s : sats) s.tau = 0e0;
+    errors += ngpt::solve_emission_time(rx, n, source, sats.data(), passes);
+    double max_pos, max_tau;
+    compare(sats.data(), ref_pos.data(), ref_tau.data(), n, max_pos, max_tau);
+    std::printf("\n# %-7s frames: %4d, evaluations: %d (reference: %.2f), "
+      "max diff: %.2e m, %.2e sec", name, n, passes,
+      static_cast<double>(evaluations)/n, max_pos, max_tau);
+    errors += (max_pos > ((passes==1) ? 1e-3 : 1e-6))
+      + (max_tau > ((passes==1) ? 5e-12 : 1e-15));
+  }
+
+  // with the previous solution as guess (e.g. next epoch), one pass
+  for (int i=0; i<n; i++) trx[i] += 30e0;
+  for (int i=0; i<n; i++) {
+    brute_force(position(i), &ref_pos[3*i], ref_tau[i]);
+  }
+  errors += ngpt::solve_emission_time(rx, n, source, sats.data());
+  double max_pos, max_tau;
+  compare(sats.data(), ref_pos.data(), ref_tau.data(), n, max_pos, max_tau);
+  std::printf("\n#         guess from previous epoch, max diff: %.2e m, %.2e sec",
+    max_pos, max_tau);
+  errors += (max_pos > 1e-5) + (max_tau > 1e-12);
+
+  // timing: solver (one pass, guess from previous epoch) vs brute force
+  const int repeats = 20;
+  double sum = 0e0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r=0; r<repeats; r++) {
+    ngpt::solve_emission_time(rx, n, source, sats.data());
+    sum += sats[r%n].state[0];
+  }
+  auto stop = std::chrono::steady_clock::now();
+  const double ts = std::chrono::duration<double>(stop-start).count();
+  start = std::chrono::steady_clock::now();
+  for (int r=0; r<repeats; r++) {
+    for (int i=0; i<n; i++) {
+      double pos[3], tau;
+      brute_force(position(i), pos, tau);
+      sum += pos[0];
+    }
+  }
+  stop = std::chrono::steady_clock::now();
+  const double tb = std::chrono::duration<double>(stop-start).count();
+  std::printf("\n#         solver: %.1f ns/satellite, iterating the orbit: "
+    "%.1f ns/satellite (checksum %.3e)", ts/repeats/n*1e9, tb/repeats/n*1e9,
+    sum);
+
+  // datetime interface
+  const auto t = ngpt::datetime<ngpt::seconds>(ngpt::gps_week(eph[0].week()),
+    ngpt::seconds(static_cast<long>(eph[0].toe())));
+  errors += ngpt::solve_emission_time(rx, t, eph, sats.data());
+
+  return errors;
+}
+
+/// SP3 orbits; all satellites at an epoch between the nodes
+int
+check_sp3(const Sp3& sp3)
+{
+  const int n = sp3.num_sats();
+  std::vector<int> idx (n);
+  for (int i=0; i<n; i++) idx[i] = i;
+  const double trx = 20.3e0*sp3.interval();
+  int errors = 0;
+
+  // positions and clock equal to Sp3::interpolate, velocities to central
+  // differences
+  double max_dpos = 0e0, max_dvel = 0e0;
+  for (int i=0; i<n; i++) {
+    for (double t : {trx, 20*sp3.interval()}) {
+      double state[6], clk, ref[4], p[4], m[4];
+      errors += sp3.state_and_clock(i, t, state, clk);
+      sp3.interpolate(i, t, ref);
+      sp3.interpolate(i, t+0.5e0, p);
+      sp3.interpolate(i, t-0.5e0, m);
+      if (std::isnan(ref[0]) || std::isnan(ref[3]) || std::isnan(p[0])
+        || std::isnan(m[0])) continue;
+      for (int k=0; k<3; k++) {
+        max_dpos = std::max(max_dpos, std::abs(state[k]-ref[k]));
+        max_dvel = std::max(max_dvel, std::abs(state[3+k]-(p[k]-m[k])));
+      }
+      max_dpos = std::max(max_dpos, std::abs(clk-ref[3])*1e6);
+    }
+  }
+  std::printf("\n# SP3     state_and_clock vs interpolate: %.2e m, "
+    "velocity vs numeric: %.2e m/sec", max_dpos, max_dvel);
+  errors += (max_dpos > 1e-6) + (max_dvel > 1e-4);
+
+  std::vector<double> ref_pos (3*n), ref_tau (n);
+  for (int i=0; i<n; i++) {
+    brute_force([&](double tau, double* x) {
+      double state[4];
+      sp3.interpolate(i, trx-tau, state);
+      std::copy(state, state+3, x);
+    }, &ref_pos[3*i], ref_tau[i]);
+  }
+  std::vector<EmissionState> sats (n);
+  for (int passes : {1, 2}) {
+    for (auto& s : sats) s.tau = 0e0;
+    ngpt::solve_emission_time(rx, n,
+      [&](int i, double tau, double* state, double& dtsv) {
+        return sp3.state_and_clock(idx[i], trx-tau, state, dtsv);
+      }, sats.data(), passes);
+    double max_pos, max_tau;
+    compare(sats.data(), ref_pos.data(), ref_tau.data(), n, max_pos, max_tau);
+    std::printf("\n# SP3     satellites: %4d, evaluations: %d, max diff: "
+      "%.2e m, %.2e sec", n, passes, max_pos, max_tau);
+    errors += (max_pos > ((passes==1) ? 1e-3 : 1e-6))
+      + (max_tau > ((passes==1) ? 5e-12 : 1e-15));
+  }
+
+  // datetime interface (at an integer second)
+  const auto t = ngpt::datetime<ngpt::seconds>(sp3.start_epoch().mjd(),
+    ngpt::seconds(sp3.start_epoch().sec().as_underlying_type()
+    + static_cast<long>(20*sp3.interval()) + 7L));
+  for (auto& s : sats) s.tau = 0e0;
+  const int failed = ngpt::solve_emission_time(rx, t, sp3, idx.data(), n,
+    sats.data());
+  errors += (failed != 0);
+  return errors;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3) {
+    std::cerr<<"\n[ERROR] Run as: $>testEmissionTime <Nav. RINEX> <sp3>\n";
+    return 1;
+  }
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+
+  int errors = 0;
+  errors += check_broadcast<SATELLITE_SYSTEM::gps>(frames, "GPS");
+  errors += check_broadcast<SATELLITE_SYSTEM::galileo>(frames, "Galileo");
+  errors += check_sp3(Sp3(argv[2]));
+  std::printf("\n");
+
+  return errors;
+}
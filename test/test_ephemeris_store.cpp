@@ -0,0 +1,134 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <unordered_map>
+#include "navrnx.hpp"
+#include "ephemeris_store.hpp"
+#include "glo_propagator.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::EphemerisStore;
+using ngpt::GloPropagator;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::seconds;
+
+/// Reference selection: scan all frames of the file and return the (first)
+/// healthy frame of the satellite with the ToC closest to t, that is valid
+/// at t.
+const NavDataFrame*
+linear_find(const std::vector<NavDataFrame>& frames, const EphemerisStore& store,
+  SATELLITE_SYSTEM sys, int prn, const ngpt::datetime<seconds>& t,
+  const int* health_idx)
+{
+  const NavDataFrame* best = nullptr;
+  long best_dt = 0;
+  for (const auto& f : frames) {
+    if (f.sys()!=sys || f.prn()!=prn) continue;
+    if (f.data(health_idx[static_cast<int>(sys)])!=0e0) continue;
+    long dt = std::abs(ngpt::delta_sec(t, f.toc()).as_underlying_type());
+    if (dt>store.max_age(f)) continue;
+    if (!best || dt<best_dt || (dt==best_dt && f.toc()<best->toc())) {
+      best = &f;
+      best_dt = dt;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr<<"\n[ERROR] Run as: $>testEphemerisStore <Nav. RINEX>\n";
+    return 1;
+  }
+
+  // all frames, in file order (reference)
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  EphemerisStore store(nav);
+  auto stop = std::chrono::steady_clock::now();
+  std::cout<<"\n# Read "<<frames.size()<<" data blocks; stored "<<store.size()
+    <<" frames for "<<store.num_satellites()<<" satellites";
+  std::printf("\n# Store built in %.6f sec",
+    std::chrono::duration<double>(stop-start).count());
+
+  // time span of the file
+  auto first = frames[0].toc(), last = frames[0].toc();
+  for (const auto& f : frames) {
+    if (f.toc()<first) first = f.toc();
+    if (last<f.toc()) last = f.toc();
+  }
+
+  // compare against a linear scan, every 5 min, for every satellite
+  const int health_idx[] = {24, 6, 6, 24, 24, 24, 24};
+  const SATELLITE_SYSTEM systems[] = {SATELLITE_SYSTEM::gps,
+    SATELLITE_SYSTEM::glonass, SATELLITE_SYSTEM::galileo,
+    SATELLITE_SYSTEM::beidou, SATELLITE_SYSTEM::qzss};
+  int EXIT_STATUS = 0;
+  long queries = 0, found = 0;
+  for (auto sys : systems) {
+    for (int prn=1; prn<EphemerisStore::max_prn; prn++) {
+      auto t = first;
+      t.remove_seconds(seconds(3600L));
+      while (t<=last) {
+        auto a = store.find(sys, prn, t);
+        auto b = linear_find(frames, store, sys, prn, t, health_idx);
+        ++queries;
+        if (a) ++found;
+        if ((a==nullptr) != (b==nullptr) || (a && a->toc()!=b->toc())) {
+          std::cerr<<"\n[ERROR] Store and linear scan selected different frames for "
+            <<ngpt::satsys_to_char(sys)<<prn;
+          EXIT_STATUS = 1;
+        }
+        t.add_seconds(seconds(300L));
+      }
+    }
+  }
+  std::cout<<"\n# Queries: "<<queries<<", valid frames found: "<<found;
+
+  // orbits for the GPS and GLONASS constellations, every 30 sec, from memory;
+  // every frame the store returns must be usable at t, i.e. the propagation
+  // interval (from ToC, aka tb for GLONASS) must be accepted by
+  // glo_stateNclock and GloPropagator alike
+  double state[6], dt;
+  long epochs = 0, computed = 0, failed = 0;
+  std::unordered_map<const NavDataFrame*, GloPropagator> propagators;
+  start = std::chrono::steady_clock::now();
+  auto t = first;
+  while (t<=last) {
+    for (int prn=1; prn<33; prn++) {
+      if (auto f = store.find(SATELLITE_SYSTEM::gps, prn, t)) {
+        if (!f->gps_stateNclock(t, state, dt)) ++computed; else ++failed;
+      }
+      if (auto f = store.find(SATELLITE_SYSTEM::glonass, prn, t)) {
+        if (!f->glo_stateNclock(t, state, dt)) ++computed; else ++failed;
+        auto it = propagators.find(f);
+        if (it == propagators.end()) {
+          it = propagators.emplace(f, GloPropagator(*f)).first;
+        }
+        if (it->second.state(t, state)) ++failed;
+      }
+    }
+    ++epochs;
+    t.add_seconds(seconds(30L));
+  }
+  stop = std::chrono::steady_clock::now();
+  std::printf("\n# Orbits: %ld epochs, %ld states in %.6f sec\n", epochs,
+    computed, std::chrono::duration<double>(stop-start).count());
+  if (failed) {
+    std::cerr<<"\n[ERROR] Failed to compute "<<failed
+      <<" states from frames returned by the store\n";
+    EXIT_STATUS = 1;
+  }
+
+  return EXIT_STATUS;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "navrnx.hpp"
+#include "glo_propagator.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::GloPropagator;
+using ngpt::SATELLITE_SYSTEM;
+
+/// Max distance between two position vectors
+double
+distance(const double* a, const double* b)
+{
+  return std::sqrt((a[0]-b[0])*(a[0]-b[0]) + (a[1]-b[1])*(a[1]-b[1])
+    + (a[2]-b[2])*(a[2]-b[2]));
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr<<"\n[ERROR] Run as: $>testGloPropagator <Nav. RINEX>\n";
+    return 1;
+  }
+
+  NavigationRnx nav(argv[1]);
+  std::vector<NavDataFrame> frames, glo;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+  for (const auto& f : frames) {
+    if (f.sys()==SATELLITE_SYSTEM::glonass) glo.push_back(f);
+  }
+  std::cout<<"\n# Number of GLONASS frames: "<<glo.size();
+  if (glo.empty()) return 1;
+
+  // (1) at integration steps, the propagator must give what glo_ecef gives
+  // (2) between steps, compare against a propagator with a 1 sec step
+  double max_node = 0e0, max_pos = 0e0, max_vel = 0e0;
+  double state[6], ref[6];
+  for (const auto& f : glo) {
+    GloPropagator prop(f);
+    GloPropagator fine(f, 900e0, 1e0);
+    const double tb = f.toc().sec().to_fractional_seconds();
+    for (int k=-15; k<=15; k++) {
+      prop.state(k*60e0, state);
+      f.glo_ecef(tb+k*60e0, tb, ref);
+      if (distance(state, ref)>max_node) max_node = distance(state, ref);
+    }
+    for (int dt=-900; dt<=900; dt++) {
+      prop.state(static_cast<double>(dt), state);
+      fine.state(static_cast<double>(dt), ref);
+      if (distance(state, ref)>max_pos) max_pos = distance(state, ref);
+      if (distance(state+3, ref+3)>max_vel) max_vel = distance(state+3, ref+3);
+    }
+  }
+  std::printf("\n# Max position difference vs glo_ecef at steps   : %.3e m", max_node);
+  std::printf("\n# Max position difference vs 1 sec step (1 Hz)   : %.3e m", max_pos);
+  std::printf("\n# Max velocity difference vs 1 sec step (1 Hz)   : %.3e m/sec", max_vel);
+
+  // cost of a 1 Hz orbit over +/- 15 min: glo_ecef from tb at every epoch
+  // vs one propagation plus interpolation
+  const auto& f = glo[0];
+  const double tb = f.toc().sec().to_fractional_seconds();
+  auto start = std::chrono::steady_clock::now();
+  for (int dt=-900; dt<=900; dt++) {
+    f.glo_ecef(tb+dt, tb, ref);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double et = std::chrono::duration<double>(stop-start).count();
+  start = std::chrono::steady_clock::now();
+  GloPropagator prop(f);
+  for (int dt=-900; dt<=900; dt++) {
+    prop.state(static_cast<double>(dt), state);
+  }
+  stop = std::chrono::steady_clock::now();
+  double pt = std::chrono::duration<double>(stop-start).count();
+  std::printf("\n# 1801 epochs, glo_ecef     : %10.6f sec", et);
+  std::printf("\n# 1801 epochs, GloPropagator: %10.6f sec (%d derivative evaluations)",
+    pt, prop.num_derivatives());
+  std::printf("\n# Speedup: %.1f\n", et/pt);
+
+  return (max_node>1e-6 || max_pos>1e-2);
+}
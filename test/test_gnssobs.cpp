@@ -1,9 +1,54 @@
 #include <iostream>
 #include <vector>
+#include <type_traits>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
 #include "gnssobs.hpp"
 #include "gnssobsrv.hpp"
 
 using ngpt::ObservationCode;
+using ngpt::SATELLITE_SYSTEM;
+using ngpt::satellite_system_traits;
+
+// observables hold their parts inline (no heap allocation)
+static_assert(std::is_trivially_copyable<ngpt::GnssObservable>::value,
+  "GnssObservable should be trivially copyable");
+
+// packed codes are built (and validated) at compile time
+constexpr ngpt::PackedObservationCode gps_c1c (SATELLITE_SYSTEM::gps, "C1C");
+static_assert(sizeof(ngpt::PackedObservationCode) == 2
+  && std::is_trivially_copyable<ngpt::PackedObservationCode>::value,
+  "PackedObservationCode should be a trivially copyable 16-bit integer");
+static_assert(gps_c1c.band() == 1 && gps_c1c.attribute() == 'C'
+  && gps_c1c.type() == ngpt::OBSERVABLE_TYPE::pseudorange
+  && gps_c1c.satsys() == SATELLITE_SYSTEM::gps, "Packed GPS C1C");
+static_assert(ngpt::PackedObservationCode(SATELLITE_SYSTEM::gps, "L1")
+  == ngpt::PackedObservationCode(SATELLITE_SYSTEM::gps,
+       ngpt::OBSERVABLE_TYPE::carrier_phase, 1, '?'), "Packed RINEX 2 code");
+static_assert(gps_c1c < ngpt::PackedObservationCode(SATELLITE_SYSTEM::gps, "C2W")
+  && gps_c1c < ngpt::PackedObservationCode(SATELLITE_SYSTEM::glonass, "C1C"),
+  "Packed codes order on system, type, band, attribute");
+
+// the per-band tables are usable at compile time
+static_assert(satellite_system_traits<SATELLITE_SYSTEM::gps>::band2frequency(2)
+  == 1227.60e0, "GPS L2 frequency");
+static_assert(satellite_system_traits<SATELLITE_SYSTEM::galileo>::band2frequency(8)
+  == 1191.795e0, "Galileo E5 frequency");
+static_assert(satellite_system_traits<SATELLITE_SYSTEM::irnss>::band2frequency(3)
+  == 0e0, "IRNSS has no band 3");
+static_assert(satellite_system_traits<SATELLITE_SYSTEM::gps>::valid_attribute(5, 'Q')
+  && !satellite_system_traits<SATELLITE_SYSTEM::gps>::valid_attribute(5, 'C'),
+  "GPS L5 attributes");
+static_assert(ngpt::nominal_frequency(SATELLITE_SYSTEM::qzss, 6) == 1278.75e0,
+  "QZSS LEX frequency");
+static_assert(ngpt::glonass_frequency(1, -7) == 1598.0625e0
+  && ngpt::glonass_frequency(2, 13) == 1251.6875e0
+  && ngpt::glonass_frequency(3, 5) == 1202.025e0
+  && ngpt::glonass_frequency(1, 14) == 0e0, "GLONASS channel frequencies");
+static_assert(ngpt::valid_attribute(SATELLITE_SYSTEM::glonass, 1, 'P')
+  && !ngpt::valid_attribute(SATELLITE_SYSTEM::glonass, 1, 'X'),
+  "GLONASS G1 attributes");
 
 int main(/*int argc, char* argv[]*/)
 {
@@ -157,6 +202,87 @@ int main(/*int argc, char* argv[]*/)
     }
   }
 
+  // every code of every system: pack, unpack and use as hash map keys
+  std::unordered_map<ngpt::PackedObservationCode, int> columns;
+  std::vector<ngpt::PackedObservationCode> packed;
+  const std::vector<std::pair<SATELLITE_SYSTEM, const std::vector<std::string>*>>
+    all_obs = {{SATELLITE_SYSTEM::gps, &gps_obs},
+      {SATELLITE_SYSTEM::glonass, &glo_obs},
+      {SATELLITE_SYSTEM::galileo, &gal_obs},
+      {SATELLITE_SYSTEM::sbas, &sbs_obs}, {SATELLITE_SYSTEM::qzss, &qzs_obs},
+      {SATELLITE_SYSTEM::beidou, &bds_obs}, {SATELLITE_SYSTEM::irnss, &irn_obs}};
+  for (const auto& sv : all_obs) {
+    for (const auto& o : *sv.second) {
+      ngpt::PackedObservationCode pc (sv.first, o.c_str());
+      char buf[4];
+      pc.to_chars(buf);
+      if (std::strcmp(buf, o.c_str())
+          || pc != ngpt::PackedObservationCode(sv.first, ObservationCode(o.c_str()))
+          || pc.observation_code().to_string() != o) {
+        std::cerr<<"\n[ERROR] Packed code \""<<o<<"\" resolved to \""<<buf<<"\"";
+        EXIT_STATUS += 1;
+      }
+      columns.emplace(pc, static_cast<int>(columns.size()));
+      packed.push_back(pc);
+    }
+  }
+  std::sort(packed.begin(), packed.end());
+  packed.erase(std::unique(packed.begin(), packed.end()), packed.end());
+  if (packed.size() != columns.size()) {
+    std::cerr<<"\n[ERROR] Packed codes are not unique";
+    EXIT_STATUS += 1;
+  }
+  try {
+    ngpt::PackedObservationCode pc (SATELLITE_SYSTEM::gps, "C1c");
+    std::cerr<<"\n[ERROR] Resolved invalid code \"C1c\"";
+    EXIT_STATUS += 1;
+  } catch (std::runtime_error&) {}
+  std::cout<<"\nPacked codes: "<<columns.size();
+
+  // a linear combination (the ionosphere-free combination of L1 and L2)
+  const double f1 = satellite_system_traits<SATELLITE_SYSTEM::gps>::band2frequency(1);
+  const double f2 = satellite_system_traits<SATELLITE_SYSTEM::gps>::band2frequency(2);
+  ngpt::GnssObservable lc (SATELLITE_SYSTEM::gps, ObservationCode("L1C"),
+    f1*f1/(f1*f1-f2*f2));
+  lc.add(SATELLITE_SYSTEM::gps, ObservationCode("L2W"), -f2*f2/(f1*f1-f2*f2));
+  std::cout<<"\ngps::LC frequency: "<<lc.frequency()<<" MHz";
+  // GLONASS: every channel of the FDMA bands
+  for (int k=-7; k<=13; k++) {
+    ngpt::GnssObservable g1 (SATELLITE_SYSTEM::glonass, ObservationCode("L1C"));
+    ngpt::GnssObservable g2 (SATELLITE_SYSTEM::glonass, ObservationCode("L2P"));
+    if (g1.frequency(k) != 1602e0 + k*0.5625e0
+        || g2.frequency(k) != 1246e0 + k*0.4375e0
+        || g1.wavelength(k) != ngpt::glonass_wavelength(1, k)
+        || g1.frequency() != 0e0) {
+      std::cerr<<"\n[ERROR] Wrong frequency for GLONASS channel "<<k;
+      EXIT_STATUS += 1;
+    }
+  }
+  // the GLONASS G1/G2 frequency ratio (9/7) is the same for all channels,
+  // and so are the coefficients of the ionosphere-free combination
+  const double c1 = 81e0/32e0, c2 = -49e0/32e0;
+  ngpt::GnssObservable glc (SATELLITE_SYSTEM::glonass, ObservationCode("L1C"), c1);
+  glc.add(SATELLITE_SYSTEM::glonass, ObservationCode("L2P"), c2);
+  std::cout<<"\nglo::LC frequency (k=-7, 0, 6): "<<glc.frequency(-7)<<", "
+    <<glc.frequency(0)<<", "<<glc.frequency(6)<<" MHz";
+  // a combination holds up to max_parts raw observables
+  ngpt::GnssObservable full (SATELLITE_SYSTEM::gps, ObservationCode("L1C"));
+  for (int i=1; i<ngpt::GnssObservable::max_parts; i++) {
+    EXIT_STATUS += full.add(SATELLITE_SYSTEM::gps, ObservationCode("L2W"));
+  }
+  if (!full.add(SATELLITE_SYSTEM::gps, ObservationCode("L5Q"))
+      || full.num_parts()!=ngpt::GnssObservable::max_parts) {
+    std::cerr<<"\n[ERROR] Added more than max_parts raw observables";
+    EXIT_STATUS += 1;
+  }
+  ngpt::GnssObservable l1 (SATELLITE_SYSTEM::gps, ObservationCode("L1C"));
+  std::cout<<"\ngps::L1 wavelength: "<<l1.wavelength()<<" m";
+  ngpt::GnssObservable bad (SATELLITE_SYSTEM::gps, ObservationCode("L7X"));
+  if (bad.frequency() != 0e0) {
+    std::cerr<<"\n[ERROR] Invalid band resolved to a frequency";
+    EXIT_STATUS += 1;
+  }
+
   std::cout << "\n";
   return 0;
 }
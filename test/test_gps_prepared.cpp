@@ -0,0 +1,111 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "navrnx.hpp"
+#include "prepared_ephemeris.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::GpsPreparedEphemeris;
+using ngpt::SATELLITE_SYSTEM;
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2 && argc!=3) {
+    std::cerr<<"\n[ERROR] Run as: $>testGpsPrepared <Nav. RINEX> [repeats]\n";
+    return 1;
+  }
+  int repeats = (argc==3) ? std::atoi(argv[2]) : 5;
+  if (repeats<1) repeats = 1;
+
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+  std::vector<NavDataFrame> gps;
+  std::vector<GpsPreparedEphemeris> prep;
+  for (const auto& f : frames) {
+    if (f.sys()==SATELLITE_SYSTEM::gps) {
+      gps.push_back(f);
+      prep.emplace_back(f);
+    }
+  }
+  std::cout<<"\n# Number of GPS frames: "<<gps.size();
+  if (gps.empty()) return 1;
+
+  // every frame, every 30 sec within +/- 2 hours from ToE
+  const int num_epochs = 481;
+  auto epoch = [](const GpsPreparedEphemeris& p, int k) {
+    return p.toe() - 7200e0 + 30e0*k;
+  };
+
+  // accuracy: positions/clocks against the NavDataFrame path, velocities
+  // against central differences of positions (h = 0.5 sec)
+  double max_pos=0e0, max_clk=0e0, max_vel=0e0, max_dvel=0e0;
+  double state[6], sp[6], sm[6], ref[6], dtsv, ref_dtsv, dummy;
+  for (std::size_t i=0; i<gps.size(); i++) {
+    for (int k=0; k<num_epochs; k++) {
+      double t = epoch(prep[i], k);
+      prep[i].state_and_clock(t, state, dtsv);
+      gps[i].gps_ecef(prep[i].toe(), t, ref, nullptr, ref+3);
+      gps[i].gps_dtsv(t-prep[i].epoch(gps[i].toc()), ref_dtsv);
+      double d = std::sqrt((state[0]-ref[0])*(state[0]-ref[0])
+        + (state[1]-ref[1])*(state[1]-ref[1]) + (state[2]-ref[2])*(state[2]-ref[2]));
+      if (d>max_pos) max_pos = d;
+      for (int j=3; j<6; j++) {
+        if (std::abs(state[j]-ref[j])>max_dvel) max_dvel = std::abs(state[j]-ref[j]);
+      }
+      if (std::abs(dtsv-ref_dtsv)>max_clk) max_clk = std::abs(dtsv-ref_dtsv);
+      prep[i].state_and_clock(t+0.5e0, sp, dummy);
+      prep[i].state_and_clock(t-0.5e0, sm, dummy);
+      for (int j=0; j<3; j++) {
+        d = std::abs((sp[j]-sm[j]) - state[3+j]);
+        if (d>max_vel) max_vel = d;
+      }
+    }
+  }
+  std::printf("\n# Max position difference (prepared - gps_ecef): %.3e m", max_pos);
+  std::printf("\n# Max clock difference (prepared - gps_dtsv)   : %.3e sec", max_clk);
+  std::printf("\n# Max velocity difference (prepared - gps_ecef): %.3e m/sec", max_dvel);
+  std::printf("\n# Max velocity difference (analytic - numeric) : %.3e m/sec", max_vel);
+
+  // latency: gps_ecef + gps_dtsv (as in NavDataFrame::gps_stateNclock) vs
+  // prepared position + velocity + clock
+  double ot = 1e10, pt = 1e10, sum1 = 0e0, sum2 = 0e0;
+  for (int r=0; r<repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i=0; i<gps.size(); i++) {
+      double toc = prep[i].epoch(gps[i].toc());
+      for (int k=0; k<num_epochs; k++) {
+        double t = epoch(prep[i], k);
+        gps[i].gps_ecef(prep[i].toe(), t, ref, nullptr, ref+3);
+        gps[i].gps_dtsv(t-toc, ref_dtsv);
+        sum1 += ref[0] + ref_dtsv;
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<ot) ot = sec;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i=0; i<gps.size(); i++) {
+      for (int k=0; k<num_epochs; k++) {
+        prep[i].state_and_clock(epoch(prep[i], k), state, dtsv);
+        sum2 += state[0] + dtsv;
+      }
+    }
+    stop = std::chrono::steady_clock::now();
+    sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<pt) pt = sec;
+  }
+  const double n = static_cast<double>(gps.size())*num_epochs;
+  std::printf("\n# gps_ecef + gps_dtsv     : %8.1f ns/call", ot/n*1e9);
+  std::printf("\n# Prepared (pos+vel+clock): %8.1f ns/call", pt/n*1e9);
+  std::printf("\n# Speedup: %.2f (checksum diff: %.3e)\n", ot/pt, (sum1-sum2)/n);
+
+  return (max_pos>1e-3 || max_clk>1e-12 || max_vel>1e-3 || max_dvel>1e-6);
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "navrnx.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::SATELLITE_SYSTEM;
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2 && argc!=3) {
+    std::cerr<<"\n[ERROR] Run as: $>testGpsVelocity <Nav. RINEX> [repeats]\n";
+    return 1;
+  }
+  int repeats = (argc==3) ? std::atoi(argv[2]) : 5;
+  if (repeats<1) repeats = 1;
+
+  NavigationRnx nav(argv[1]);
+  std::vector<NavDataFrame> frames, gps;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+  for (const auto& f : frames) {
+    if (f.sys()==SATELLITE_SYSTEM::gps) gps.push_back(f);
+  }
+  std::cout<<"\n# Number of GPS frames: "<<gps.size();
+  if (gps.empty()) return 1;
+
+  // every frame, every 30 sec within +/- 2 hours from ToE; ToE and epochs
+  // as seconds of (ToE) week
+  const int num_epochs = 481;
+  const double h = 0.5e0;
+
+  // analytic velocity vs central differences of positions
+  double state[6], sp[3], sm[3], max_diff = 0e0;
+  for (const auto& f : gps) {
+    const double toe = f.data(11);
+    for (int k=0; k<num_epochs; k++) {
+      const double t = toe - 7200e0 + 30e0*k;
+      f.gps_ecef(toe, t, state, nullptr, state+3);
+      f.gps_ecef(toe, t+h, sp);
+      f.gps_ecef(toe, t-h, sm);
+      for (int j=0; j<3; j++) {
+        double d = std::abs((sp[j]-sm[j])/(2e0*h) - state[3+j]);
+        if (d>max_diff) max_diff = d;
+      }
+    }
+  }
+  std::printf("\n# Max velocity difference (analytic - numeric): %.3e m/sec", max_diff);
+
+  // cost: one call (position + analytic velocity) vs finite differences of
+  // two calls (what users had to do so far)
+  double at = 1e10, nt = 1e10, sum1 = 0e0, sum2 = 0e0;
+  for (int r=0; r<repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& f : gps) {
+      const double toe = f.data(11);
+      for (int k=0; k<num_epochs; k++) {
+        f.gps_ecef(toe, toe-7200e0+30e0*k, state, nullptr, state+3);
+        sum1 += state[3];
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<at) at = sec;
+    start = std::chrono::steady_clock::now();
+    for (const auto& f : gps) {
+      const double toe = f.data(11);
+      for (int k=0; k<num_epochs; k++) {
+        const double t = toe - 7200e0 + 30e0*k;
+        f.gps_ecef(toe, t+h, sp);
+        f.gps_ecef(toe, t-h, sm);
+        sum2 += (sp[0]-sm[0])/(2e0*h);
+      }
+    }
+    stop = std::chrono::steady_clock::now();
+    sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<nt) nt = sec;
+  }
+  const double n = static_cast<double>(gps.size())*num_epochs;
+  std::printf("\n# Analytic (one call)          : %8.1f ns/epoch", at/n*1e9);
+  std::printf("\n# Finite differences (two calls): %8.1f ns/epoch", nt/n*1e9);
+  std::printf("\n# Speedup: %.2f (checksum diff: %.3e)\n", nt/at, (sum1-sum2)/n);
+
+  return (max_diff>1e-3);
+}
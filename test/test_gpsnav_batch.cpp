@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "navrnx.hpp"
+#include "navbatch.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::GpsNavBatch;
+using ngpt::SATELLITE_SYSTEM;
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2 && argc!=3) {
+    std::cerr<<"\n[ERROR] Run as: $>testGpsNavBatch <Nav. RINEX> [repeats]\n";
+    return 1;
+  }
+  int repeats = (argc==3) ? std::atoi(argv[2]) : 5;
+  if (repeats<1) repeats = 1;
+
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+
+  // the first frame of every GPS satellite
+  std::vector<NavDataFrame> gps;
+  bool seen[64] = {false};
+  int ref_week = -1;
+  for (const auto& f : frames) {
+    if (f.sys()==SATELLITE_SYSTEM::gps && f.prn()<64 && !seen[f.prn()]) {
+      seen[f.prn()] = true;
+      gps.push_back(f);
+      if (ref_week<0) ref_week = static_cast<int>(f.data(21));
+    }
+  }
+  if (gps.empty()) {
+    std::cerr<<"\n[ERROR] No GPS frames in file "<<argv[1]<<"\n";
+    return 1;
+  }
+  GpsNavBatch batch(ref_week);
+  for (const auto& f : gps) batch.add(f);
+  std::cout<<"\n# Number of GPS frames in batch: "<<batch.size();
+
+  // epochs: every 30 sec, +/- 2 hours from the first ToE
+  const double toe0 = (gps[0].data(21)-ref_week)*604800e0 + gps[0].data(11);
+  std::vector<double> t;
+  for (double s=-7200e0; s<=7200e0; s+=30e0) t.push_back(toe0+s);
+  const std::size_t n = batch.size(), m = t.size();
+
+  std::vector<double> x(n*m), y(n*m), z(n*m), dt(n*m);
+  double bt = 1e10, st = 1e10;
+  for (int r=0; r<repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    batch.ecef(t.data(), m, x.data(), y.data(), z.data(), dt.data());
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<bt) bt = sec;
+  }
+
+  // scalar path
+  std::vector<double> sx(n*m), sy(n*m), sz(n*m), sdt(n*m);
+  for (int r=0; r<repeats; r++) {
+    double state[3], Ek;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t j=0; j<m; j++) {
+      for (std::size_t i=0; i<n; i++) {
+        const auto& f = gps[i];
+        double toe = (f.data(21)-ref_week)*604800e0 + f.data(11);
+        f.gps_ecef(toe, t[j], state, &Ek);
+        sx[j*n+i] = state[0];
+        sy[j*n+i] = state[1];
+        sz[j*n+i] = state[2];
+        f.gps_dtsv(t[j]-batch.epoch(f.toc()), sdt[j*n+i], &Ek);
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<st) st = sec;
+  }
+
+  // compare
+  double max_pos = 0e0, max_clk = 0e0;
+  for (std::size_t k=0; k<n*m; k++) {
+    double d = std::sqrt((x[k]-sx[k])*(x[k]-sx[k]) + (y[k]-sy[k])*(y[k]-sy[k])
+      + (z[k]-sz[k])*(z[k]-sz[k]));
+    if (d>max_pos) max_pos = d;
+    if (std::abs(dt[k]-sdt[k])>max_clk) max_clk = std::abs(dt[k]-sdt[k]);
+  }
+  std::printf("\n# Max position difference (batch - scalar): %.3e m", max_pos);
+  std::printf("\n# Max clock difference (batch - scalar)   : %.3e sec", max_clk);
+  std::printf("\n# Batch : %10.6f sec, %8.1f ns/evaluation", bt, bt/(n*m)*1e9);
+  std::printf("\n# Scalar: %10.6f sec, %8.1f ns/evaluation", st, st/(n*m)*1e9);
+  std::printf("\n# Speedup: %.2f\n", st/bt);
+
+  // 1 mm for positions, 1e-12 sec (aka 0.3 mm) for clocks
+  return (max_pos>1e-3 || max_clk>1e-12);
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "navrnx.hpp"
+#include "prepared_ephemeris.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::PreparedEphemeris;
+using ngpt::SATELLITE_SYSTEM;
+
+/// Textbook evaluation of a broadcast (Keplerian) orbit and clock; fixed
+/// point iterations for Kepler's equation, rotation matrices for BeiDou GEO
+/// satellites. t is seconds of week, in system time.
+void
+reference(const NavDataFrame& f, double t, double toc, double gm, double oe,
+  double F, bool geo, double* pos, double& dtsv)
+{
+  const double A  = f.data(10)*f.data(10);
+  const double tk = t - f.data(11);
+  const double n  = std::sqrt(gm/(A*A*A)) + f.data(5);
+  const double M  = f.data(6) + n*tk;
+  const double e  = f.data(8);
+  double E = M;
+  for (int i=0; i<100; i++) E = M + e*std::sin(E);
+  const double v   = std::atan2(std::sqrt(1e0-e*e)*std::sin(E), std::cos(E)-e);
+  const double phi = v + f.data(17);
+  const double u   = phi + f.data(9)*std::sin(2*phi) + f.data(7)*std::cos(2*phi);
+  const double r   = A*(1e0-e*std::cos(E)) + f.data(4)*std::sin(2*phi)
+                   + f.data(16)*std::cos(2*phi);
+  const double i   = f.data(15) + f.data(19)*tk + f.data(14)*std::sin(2*phi)
+                   + f.data(12)*std::cos(2*phi);
+  const double x = r*std::cos(u), y = r*std::sin(u);
+  if (!geo) {
+    const double O = f.data(13) + (f.data(18)-oe)*tk - oe*f.data(11);
+    pos[0] = x*std::cos(O) - y*std::cos(i)*std::sin(O);
+    pos[1] = x*std::sin(O) + y*std::cos(i)*std::cos(O);
+    pos[2] = y*std::sin(i);
+  } else {
+    const double O = f.data(13) + f.data(18)*tk - oe*f.data(11);
+    const double g[3] = {x*std::cos(O) - y*std::cos(i)*std::sin(O),
+                         x*std::sin(O) + y*std::cos(i)*std::cos(O),
+                         y*std::sin(i)};
+    const double a = -5e0*M_PI/180e0, z = oe*tk;
+    const double Rx[3][3] = {{1,0,0}, {0,std::cos(a),std::sin(a)},
+                             {0,-std::sin(a),std::cos(a)}};
+    const double Rz[3][3] = {{std::cos(z),std::sin(z),0},
+                             {-std::sin(z),std::cos(z),0}, {0,0,1}};
+    double h[3];
+    for (int k=0; k<3; k++) h[k] = Rx[k][0]*g[0]+Rx[k][1]*g[1]+Rx[k][2]*g[2];
+    for (int k=0; k<3; k++) pos[k] = Rz[k][0]*h[0]+Rz[k][1]*h[1]+Rz[k][2]*h[2];
+  }
+  const double dt = t - toc;
+  dtsv = f.data(0) + f.data(1)*dt + f.data(2)*dt*dt
+       + F*e*f.data(10)*std::sin(E);
+}
+
+/// Check all frames of system S; returns the number of failed checks
+template<SATELLITE_SYSTEM S>
+int
+check(const std::vector<NavDataFrame>& frames, const char* name)
+{
+  using traits = ngpt::satellite_system_traits<S>;
+  std::vector<NavDataFrame> sys;
+  std::vector<PreparedEphemeris<S>> prep;
+  for (const auto& f : frames) {
+    if (f.sys()==S) {
+      sys.push_back(f);
+      prep.emplace_back(f);
+    }
+  }
+  if (sys.empty()) return 1;
+
+  // every frame, every 30 sec within +/- 2 hours from ToE
+  const int num_epochs = 481;
+  double max_pos=0e0, max_clk=0e0, max_vel=0e0, max_geo=0e0, max_toc=0e0;
+  int geos = 0, errors = 0;
+  double state[6], sp[6], sm[6], ref[3], dtsv, ref_dtsv, dummy;
+  for (std::size_t i=0; i<sys.size(); i++) {
+    // ToC is in system time; as a GPS date it is ToC + time_offset
+    const auto toc = sys[i].toc();
+    const double toc_sow = static_cast<double>(
+      (toc.mjd().as_underlying_type()-44244L)%7L)*86400e0
+      + toc.sec().to_fractional_seconds();
+    const auto toc_gps = ngpt::datetime<ngpt::seconds>(toc.mjd(),
+      ngpt::seconds(toc.sec().as_underlying_type()
+      + static_cast<long>(traits::time_offset)));
+    max_toc = std::max(max_toc, std::abs(prep[i].epoch(toc_gps)-toc_sow));
+    geos += prep[i].is_geo();
+    for (int k=0; k<num_epochs; k++) {
+      const double t = prep[i].toe() - 7200e0 + 30e0*k;
+      errors += prep[i].state_and_clock(t, state, dtsv);
+      reference(sys[i], t, toc_sow, traits::broadcast_gm,
+        traits::broadcast_earth_rotation, traits::broadcast_relativistic_f,
+        prep[i].is_geo(), ref, ref_dtsv);
+      max_pos = std::max(max_pos, std::sqrt((state[0]-ref[0])*(state[0]-ref[0])
+        + (state[1]-ref[1])*(state[1]-ref[1]) + (state[2]-ref[2])*(state[2]-ref[2])));
+      max_clk = std::max(max_clk, std::abs(dtsv-ref_dtsv));
+      prep[i].state_and_clock(t+0.5e0, sp, dummy);
+      prep[i].state_and_clock(t-0.5e0, sm, dummy);
+      for (int j=0; j<3; j++) {
+        max_vel = std::max(max_vel, std::abs((sp[j]-sm[j]) - state[3+j]));
+      }
+      if (prep[i].is_geo()) {
+        max_geo = std::max(max_geo, std::sqrt(state[3]*state[3]
+          + state[4]*state[4] + state[5]*state[5]));
+      }
+    }
+  }
+  std::printf("\n# %-8s frames: %3d (GEO: %2d), max diff vs reference: "
+    "%.2e m, %.2e sec; velocity vs numeric: %.2e m/sec; ToC: %.1e sec",
+    name, (int)sys.size(), geos, max_pos, max_clk, max_vel, max_toc);
+  if (geos) std::printf("\n#          max GEO (ECEF) velocity: %.2f m/sec",
+    max_geo);
+  errors += (max_pos>1e-3 || max_clk>1e-12 || max_vel>1e-3 || max_toc>1e-9);
+  errors += (geos && max_geo>10e0);
+
+  // throughput
+  double sum = 0e0;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i=0; i<sys.size(); i++) {
+    for (int k=0; k<num_epochs; k++) {
+      prep[i].state_and_clock(prep[i].toe()-7200e0+30e0*k, state, dtsv);
+      sum += state[0] + dtsv;
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+  const double n = static_cast<double>(sys.size())*num_epochs;
+  std::printf("\n#          pos+vel+clock: %.1f ns/call (checksum %.3e)", 
+    std::chrono::duration<double>(stop-start).count()/n*1e9, sum/n);
+  return errors;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testKeplerian <Nav. RINEX>\n";
+    return 1;
+  }
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+
+  int errors = 0;
+  errors += check<SATELLITE_SYSTEM::galileo>(frames, "Galileo");
+  errors += check<SATELLITE_SYSTEM::beidou>(frames, "BeiDou");
+  errors += check<SATELLITE_SYSTEM::qzss>(frames, "QZSS");
+  errors += check<SATELLITE_SYSTEM::irnss>(frames, "IRNSS");
+
+  // frames of another system are rejected
+  try {
+    PreparedEphemeris<SATELLITE_SYSTEM::qzss> p (frames.front());
+    ++errors;
+  } catch (std::runtime_error&) {}
+  std::printf("\n");
+
+  return errors;
+}
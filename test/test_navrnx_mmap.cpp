@@ -0,0 +1,105 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <sys/stat.h>
+#include "navrnx.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+
+/// Read all data blocks of a nav. RINEX file, using either the stream or the
+/// memory-mapped backend; return the number of seconds it took.
+double
+read_all(const char* fn, bool memory_map, std::vector<NavDataFrame>& frames,
+  int& status)
+{
+  auto start = std::chrono::steady_clock::now();
+  NavigationRnx nav(fn, memory_map);
+  NavDataFrame  block;
+  frames.clear();
+  while (!(status = nav.read_next_record(block))) frames.push_back(block);
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2 && argc!=3) {
+    std::cerr<<"\n[ERROR] Run as: $>testNavRnxMmap <Nav. RINEX> [repeats]\n";
+    return 1;
+  }
+  int repeats = (argc==3) ? std::atoi(argv[2]) : 5;
+  if (repeats<1) repeats = 1;
+
+  struct stat sb;
+  if (stat(argv[1], &sb)) {
+    std::cerr<<"\n[ERROR] Failed to stat file "<<argv[1]<<"\n";
+    return 1;
+  }
+  double mbytes = static_cast<double>(sb.st_size)/1024e0/1024e0;
+
+  // read with both backends; keep the fastest run of each
+  std::vector<NavDataFrame> sframes, mframes;
+  int sstatus, mstatus;
+  double st = 1e10, mt = 1e10, t;
+  for (int i=0; i<repeats; i++) {
+    if ((t=read_all(argv[1], false, sframes, sstatus))<st) st = t;
+    if ((t=read_all(argv[1], true,  mframes, mstatus))<mt) mt = t;
+  }
+  std::cout<<"\n# Stream backend: read "<<sframes.size()<<" data blocks, last status: "<<sstatus;
+  std::cout<<"\n# Mmap   backend: read "<<mframes.size()<<" data blocks, last status: "<<mstatus;
+
+  // both backends must resolve exactly the same frames
+  int EXIT_STATUS = 0;
+  if (sframes.size() != mframes.size() || sstatus != mstatus) {
+    std::cerr<<"\n[ERROR] Backends resolved different number of blocks!";
+    EXIT_STATUS = 1;
+  } else {
+    for (std::size_t i=0; i<sframes.size(); i++) {
+      const auto& a = sframes[i];
+      const auto& b = mframes[i];
+      bool same = a.sys()==b.sys() && a.prn()==b.prn() && a.toc()==b.toc();
+      for (int j=0; j<31 && same; j++) same = (a.data(j)==b.data(j));
+      if (!same) {
+        std::cerr<<"\n[ERROR] Data block #"<<i<<" differs between backends";
+        EXIT_STATUS = 1;
+      }
+    }
+  }
+
+  std::printf("\n# File size: %.3f MB", mbytes);
+  std::printf("\n# Stream backend: %10.6f sec, %10.2f MB/s", st, mbytes/st);
+  std::printf("\n# Mmap   backend: %10.6f sec, %10.2f MB/s", mt, mbytes/mt);
+  std::printf("\n# Speedup: %.2f", st/mt);
+
+  // parallel loader; must give exactly the same frames, in file order
+  NavigationRnx pnav(argv[1], true);
+  std::vector<NavDataFrame> pframes;
+  for (int threads : {1, 2, 4, 8, 16}) {
+    double pt = 1e10;
+    int pstatus = 0;
+    for (int i=0; i<repeats; i++) {
+      auto start = std::chrono::steady_clock::now();
+      pstatus = pnav.read_all_records(pframes, threads);
+      auto stop = std::chrono::steady_clock::now();
+      if ((t=std::chrono::duration<double>(stop-start).count())<pt) pt = t;
+    }
+    bool same = (pstatus==0) && (pframes.size()==mframes.size());
+    for (std::size_t i=0; i<pframes.size() && same; i++) {
+      const auto& a = pframes[i];
+      const auto& b = mframes[i];
+      same = a.sys()==b.sys() && a.prn()==b.prn() && a.toc()==b.toc();
+      for (int j=0; j<31 && same; j++) same = (a.data(j)==b.data(j));
+    }
+    if (!same) {
+      std::cerr<<"\n[ERROR] Parallel loader ("<<threads<<" threads) resolved different frames; status: "<<pstatus;
+      EXIT_STATUS = 1;
+    }
+    std::printf("\n# Parallel (%2d threads): %10.6f sec, %10.2f MB/s", threads, pt, mbytes/pt);
+  }
+  std::printf("\n");
+
+  return EXIT_STATUS;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "obsrnx.hpp"
+
+using ngpt::ObservationRnx;
+using ngpt::ObservationEpoch;
+using ngpt::PackedObservationCode;
+using ngpt::SATELLITE_SYSTEM;
+
+/// An observation, as resolved by a plain (std::strtod) scan of the file
+struct Record
+{
+  SATELLITE_SYSTEM      sys;
+  int                   prn;
+  PackedObservationCode code;
+  double                value;
+  int                   lli, ssi;
+};
+
+/// An epoch, as resolved by a plain scan of the file
+struct Epoch
+{
+  double              sec;   ///< seconds of day
+  std::vector<Record> obs;
+};
+
+/// Plain scan of the file (all codes); event records are skipped
+std::vector<Epoch>
+scan(const char* fn)
+{
+  std::ifstream fin (fn);
+  std::string line;
+  std::vector<PackedObservationCode> codes[8];
+  SATELLITE_SYSTEM cur = SATELLITE_SYSTEM::mixed;
+  while (std::getline(fin, line) && line.find("END OF HEADER")==std::string::npos) {
+    if (line.find("SYS / # / OBS TYPES")==std::string::npos) continue;
+    if (line[0]!=' ') cur = ngpt::char_to_satsys(line[0]);
+    for (std::size_t i=7; i+3<=60; i+=4) {
+      std::string c = line.substr(i, 3);
+      if (c!="   ") codes[static_cast<int>(cur)].emplace_back(cur, c.c_str());
+    }
+  }
+  std::vector<Epoch> epochs;
+  while (std::getline(fin, line)) {
+    if (!line.empty() && line.back()=='\r') line.pop_back();
+    int flag = line[31]-'0';
+    int n = std::atoi(line.substr(32, 3).c_str());
+    if (flag>=2 && flag<=5) {
+      for (int i=0; i<n; i++) std::getline(fin, line);
+      continue;
+    }
+    Epoch e;
+    e.sec = std::atoi(line.substr(13, 2).c_str())*3600e0
+      + std::atoi(line.substr(16, 2).c_str())*60e0
+      + std::strtod(line.substr(18, 11).c_str(), nullptr);
+    for (int i=0; i<n; i++) {
+      std::getline(fin, line);
+      if (!line.empty() && line.back()=='\r') line.pop_back();
+      SATELLITE_SYSTEM s = ngpt::char_to_satsys(line[0]);
+      int prn = std::atoi(line.substr(1, 2).c_str());
+      const auto& sc = codes[static_cast<int>(s)];
+      for (std::size_t c=0; c<sc.size(); c++) {
+        std::size_t start = 3 + 16*c;
+        if (start>=line.size()) break;
+        std::string field = line.substr(start, 16);
+        field.resize(16, ' ');
+        std::string val = field.substr(0, 14);
+        if (val.find_first_not_of(' ')==std::string::npos) continue;
+        Record r {s, prn, sc[c], std::strtod(val.c_str(), nullptr),
+          field[14]==' ' ? 0 : field[14]-'0', field[15]==' ' ? 0 : field[15]-'0'};
+        e.obs.push_back(r);
+      }
+    }
+    epochs.push_back(e);
+  }
+  return epochs;
+}
+
+/// Compare the epochs read with the scan, for the selected codes; returns
+/// the number of differences
+int
+compare(ObservationRnx& rnx, const std::vector<Epoch>& ref)
+{
+  const auto& sel = rnx.selected_codes();
+  ObservationEpoch obs;
+  int diffs = 0, status;
+  std::size_t ne = 0;
+  while (!(status = rnx.read_next_epoch(obs))) {
+    if (ne>=ref.size()) return diffs+1;
+    const Epoch& e = ref[ne++];
+    if (std::abs(obs.epoch().sec().to_fractional_seconds()-e.sec)>1e-6) ++diffs;
+    // every value of the scan that is selected must be in the epoch
+    int found = 0;
+    for (const auto& r : e.obs) {
+      int sat = -1;
+      for (int i=0; i<obs.num_sats(); i++) {
+        if (obs.satsys(i)==r.sys && obs.prn(i)==r.prn) sat = i;
+      }
+      PackedObservationCode any (SATELLITE_SYSTEM::mixed, r.code.type(),
+        r.code.band(), r.code.attribute());
+      int col = -1;
+      for (std::size_t j=0; j<sel.size() && col<0; j++) {
+        if (sel[j]==r.code || sel[j]==any) col = static_cast<int>(j);
+      }
+      if (col<0) continue;
+      ++found;
+      if (sat<0 || obs.value(sat, col)!=r.value || obs.lli(sat, col)!=r.lli
+          || obs.ssi(sat, col)!=r.ssi) ++diffs;
+    }
+    // and nothing else
+    int present = 0;
+    for (int j=0; j<obs.num_codes(); j++) {
+      for (int i=0; i<obs.num_sats(); i++) present += !std::isnan(obs.value(i, j));
+    }
+    if (present!=found) ++diffs;
+  }
+  return diffs + (status>0) + (ne!=ref.size());
+}
+
+/// Time a full read of the file; returns MB/sec
+double
+throughput(const char* fn, const std::vector<PackedObservationCode>& codes,
+  int& epochs)
+{
+  auto start = std::chrono::steady_clock::now();
+  ObservationRnx rnx (fn, true);
+  if (!codes.empty()) rnx.select_codes(codes);
+  ObservationEpoch obs;
+  epochs = 0;
+  while (!rnx.read_next_epoch(obs)) ++epochs;
+  auto stop = std::chrono::steady_clock::now();
+  std::ifstream fin (fn, std::ios_base::binary | std::ios_base::ate);
+  const double mb = static_cast<double>(fin.tellg())/1e6;
+  return mb / std::chrono::duration<double>(stop-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testObsRnx [obs RINEX v3.x]\n";
+    return 1;
+  }
+
+  std::vector<Epoch> ref = scan(argv[1]);
+  std::cout<<"\n# Epochs in file: "<<ref.size();
+
+  // (1) all codes, memory-mapped
+  ObservationRnx all (argv[1], true);
+  std::cout<<"\n# Version: "<<all.version()<<", columns: "<<all.selected_codes().size();
+  int diffs = compare(all, ref);
+  std::printf("\n# All codes (memory-mapped), differences: %d", diffs);
+
+  // (2) a selection (plus a code not in the file), from the stream; read
+  //     twice to test rewind
+  const std::vector<PackedObservationCode> sel = {
+    {SATELLITE_SYSTEM::mixed, "C1C"}, {SATELLITE_SYSTEM::mixed, "L1C"},
+    {SATELLITE_SYSTEM::gps, "C2W"}, {SATELLITE_SYSTEM::gps, "L2W"},
+    {SATELLITE_SYSTEM::galileo, "C5Q"}, {SATELLITE_SYSTEM::glonass, "L2P"},
+    {SATELLITE_SYSTEM::gps, "C6X"}};
+  ObservationRnx some (argv[1]);
+  int status = some.select_codes(sel);
+  int sdiffs = status + compare(some, ref);
+  some.rewind();
+  sdiffs += compare(some, ref);
+  std::printf("\n# Selected codes (stream), differences: %d", sdiffs);
+
+  // (3) throughput
+  int epochs;
+  double mbs = throughput(argv[1], {}, epochs);
+  std::printf("\n# All codes     : %8.1f MB/sec (%d epochs)", mbs, epochs);
+  mbs = throughput(argv[1], sel, epochs);
+  std::printf("\n# Selected codes: %8.1f MB/sec (%d epochs)\n", mbs, epochs);
+
+  return (diffs || sdiffs);
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "rinex.hpp"
+
+using ngpt::rinex::fixed_width_to_double;
+
+/// Reference conversion: copy the field, replace 'D'/'d' with 'E' and call
+/// std::strtod (this is what the navigation RINEX reader used to do).
+bool
+strtod_field(const char* str, int width, double& val)
+{
+  char buf[64];
+  std::memcpy(buf, str, width);
+  buf[width] = '\0';
+  for (int i=0; i<width; i++) if (buf[i]=='D' || buf[i]=='d') buf[i]='E';
+  char* end;
+  val = std::strtod(buf, &end);
+  return end != buf;
+}
+
+/// Compare the two conversions bit-by-bit; return true if they match
+bool
+same_bits(double a, double b)
+{
+  return !std::memcmp(&a, &b, sizeof(double));
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc<2) {
+    std::cerr<<"\n[ERROR] Run as: $>testRnxFloat <Nav. RINEX> [<Nav. RINEX> ...]\n";
+    return 1;
+  }
+
+  int EXIT_STATUS = 0;
+  double a, b;
+
+  // a few hand-written fields, all formats we have seen in the wild
+  std::vector<std::string> fields = {" -.123456789012D-03", "-1.234567890123D-03",
+    " 1.234567890123d+03", " 1.234567890123E+03", " 1.234567890123e-10",
+    " 0.000000000000D+00", "-0.000000000000D+00", "  .100000000000D+01",
+    " 5.153678421021D+03", "-4.656612873077D-10", " 1.000000000000D-30",
+    " 9.999999999999D+25", "    0.123456789012D", "             12345",
+    "          1.234567", "  -1.5e300         ", "  -1.5e-300        ",
+    " 1.234567890123D+  ", "  -1.23456789012E  "};
+  for (const auto& f : fields) {
+    bool s1 = fixed_width_to_double(f.c_str(), f.size(), a);
+    bool s2 = strtod_field(f.c_str(), f.size(), b);
+    if (s1 && s2 && !same_bits(a,b)) {
+      std::printf("\n[ERROR] Field \"%s\" resolved to %.17e (strtod: %.17e)", f.c_str(), a, b);
+      EXIT_STATUS = 1;
+    } else if (s1 != s2) {
+      std::printf("\n[ERROR] Field \"%s\" resolved: %d (strtod: %d)", f.c_str(), s1, s2);
+      EXIT_STATUS = 1;
+    }
+  }
+
+  // collect every D19.12 field in all nav files
+  std::vector<std::string> all_fields;
+  char line[128];
+  for (int f=1; f<argc; f++) {
+    std::ifstream fin(argv[f]);
+    if (!fin.is_open()) {
+      std::cerr<<"\n[ERROR] Failed to open file "<<argv[f];
+      return 1;
+    }
+    while (fin.getline(line, 128) && std::strncmp(line+60, "END OF HEADER", 13)) ;
+    while (fin.getline(line, 128)) {
+      int len = std::strlen(line);
+      // first line of block starts with a satellite id; data lines with 4 blanks
+      int start = (*line != ' ') ? 23 : 4;
+      for (int i=start; i+19<=len; i+=19) {
+        if (std::strspn(line+i, " ") < 19) all_fields.emplace_back(line+i, 19);
+      }
+    }
+  }
+  std::cout<<"\n# Number of fields to check: "<<all_fields.size();
+
+  // correctness: every field must be bit-exact with the strtod path
+  long mismatches = 0;
+  for (const auto& f : all_fields) {
+    bool s1 = fixed_width_to_double(f.c_str(), 19, a);
+    bool s2 = strtod_field(f.c_str(), 19, b);
+    if (s1 != s2 || (s1 && !same_bits(a,b))) {
+      if (++mismatches < 20) {
+        std::printf("\n[ERROR] Field \"%s\" resolved to %.17e (strtod: %.17e)", f.c_str(), a, b);
+      }
+    }
+  }
+  std::cout<<"\n# Mismatches: "<<mismatches;
+  if (mismatches) EXIT_STATUS = 1;
+
+  // microbenchmark: fixed width decoder vs copy+strtod
+  const int repeats = 20;
+  double sum1=0e0, sum2=0e0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r=0; r<repeats; r++) {
+    for (const auto& f : all_fields) {
+      fixed_width_to_double(f.c_str(), 19, a);
+      sum1 += a;
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r=0; r<repeats; r++) {
+    for (const auto& f : all_fields) {
+      strtod_field(f.c_str(), 19, b);
+      sum2 += b;
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  double d1 = std::chrono::duration<double>(t1-t0).count();
+  double d2 = std::chrono::duration<double>(t2-t1).count();
+  double n  = static_cast<double>(all_fields.size())*repeats;
+  std::printf("\n# Fixed-width decoder: %10.3f ns/field", d1/n*1e9);
+  std::printf("\n# Copy + std::strtod : %10.3f ns/field", d2/n*1e9);
+  std::printf("\n# Speedup: %.2f (checksum diff: %.3e)\n", d2/d1, sum1-sum2);
+
+  return EXIT_STATUS;
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include "navrnx.hpp"
+#include "navbatch.hpp"
+
+using ngpt::NavigationRnx;
+using ngpt::NavDataFrame;
+using ngpt::SbasNavBatch;
+using ngpt::SATELLITE_SYSTEM;
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2 && argc!=3) {
+    std::cerr<<"\n[ERROR] Run as: $>testSbasNavBatch <Nav. RINEX> [repeats]\n";
+    return 1;
+  }
+  int repeats = (argc==3) ? std::atoi(argv[2]) : 5;
+  if (repeats<1) repeats = 1;
+
+  NavigationRnx nav(argv[1], true);
+  std::vector<NavDataFrame> frames;
+  if (nav.read_all_records(frames)) {
+    std::cerr<<"\n[ERROR] Failed to read navigation file "<<argv[1]<<"\n";
+    return 1;
+  }
+
+  // the constellation at the ToC with the most satellites
+  std::map<long, std::vector<NavDataFrame>> by_toc;
+  for (const auto& f : frames) {
+    if (f.sys()==SATELLITE_SYSTEM::sbas) {
+      long key = f.toc().mjd().as_underlying_type()*86400L
+        + static_cast<long>(f.toc().sec().to_fractional_seconds());
+      by_toc[key].push_back(f);
+    }
+  }
+  if (by_toc.empty()) {
+    std::cerr<<"\n[ERROR] No SBAS frames in file "<<argv[1]<<"\n";
+    return 1;
+  }
+  std::vector<NavDataFrame> sbas;
+  for (const auto& it : by_toc) {
+    if (it.second.size()>sbas.size()) sbas = it.second;
+  }
+  const int week = static_cast<int>(
+    (sbas[0].toc().mjd().as_underlying_type()-44244L)/7L);
+  SbasNavBatch batch(week);
+  for (const auto& f : sbas) batch.add(f);
+  const std::size_t n = batch.size();
+  std::cout<<"\n# Number of SBAS frames in batch: "<<n;
+  int errors = (batch.add(NavDataFrame{}) != 1) + (batch.size() != n);
+
+  // epochs: every 10 sec, +/- 6 min from ToC
+  const double toc = batch.epoch(sbas[0].toc());
+  std::vector<double> t;
+  for (double s=-360e0; s<=360e0; s+=10e0) t.push_back(toc+s);
+  const std::size_t m = t.size();
+
+  std::vector<double> bs(6*n*m), bdt(n*m);
+  double bt = 1e10, st = 1e10;
+  int status = 0;
+  for (int r=0; r<repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t j=0; j<m; j++) {
+      status += batch.ecef(t[j], bs.data()+6*n*j, bdt.data()+n*j);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<bt) bt = sec;
+  }
+
+  // scalar path (sbas_ecef + sbas_dtsv, one satellite at a time)
+  std::vector<double> ss(6*n*m), sdt(n*m);
+  for (int r=0; r<repeats; r++) {
+    double state[6];
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t j=0; j<m; j++) {
+      for (std::size_t i=0; i<n; i++) {
+        status += sbas[i].sbas_ecef(t[j]-toc, state);
+        sbas[i].sbas_dtsv(t[j]-toc, sdt[j*n+i]);
+        for (int k=0; k<6; k++) ss[6*n*j+k*n+i] = state[k];
+      }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(stop-start).count();
+    if (sec<st) st = sec;
+  }
+
+  // compare; velocities also against central differences of positions
+  // (exact for the second order expansion) and radii against the GEO radius
+  double max_pos = 0e0, max_vel = 0e0, max_clk = 0e0, max_dvel = 0e0;
+  double max_radius = 0e0;
+  for (std::size_t j=0; j<m; j++) {
+    const double* b = bs.data() + 6*n*j;
+    const double* s = ss.data() + 6*n*j;
+    for (std::size_t i=0; i<n; i++) {
+      double dp = 0e0, dv = 0e0, r = 0e0;
+      for (int k=0; k<3; k++) {
+        dp += (b[k*n+i]-s[k*n+i])*(b[k*n+i]-s[k*n+i]);
+        dv += (b[(3+k)*n+i]-s[(3+k)*n+i])*(b[(3+k)*n+i]-s[(3+k)*n+i]);
+        r  += b[k*n+i]*b[k*n+i];
+      }
+      if (std::sqrt(dp)>max_pos) max_pos = std::sqrt(dp);
+      if (std::sqrt(dv)>max_vel) max_vel = std::sqrt(dv);
+      if (std::abs(bdt[j*n+i]-sdt[j*n+i])>max_clk) max_clk = std::abs(bdt[j*n+i]-sdt[j*n+i]);
+      max_radius = std::max(max_radius, std::abs(std::sqrt(r)-42164e3));
+      if (j>0 && j+1<m) {
+        const double* bp = bs.data() + 6*n*(j+1);
+        const double* bm = bs.data() + 6*n*(j-1);
+        for (int k=0; k<3; k++) {
+          const double num = (bp[k*n+i]-bm[k*n+i])/(t[j+1]-t[j-1]);
+          max_dvel = std::max(max_dvel, std::abs(num-b[(3+k)*n+i]));
+        }
+      }
+    }
+  }
+  std::printf("\n# Max position difference (batch - scalar): %.3e m", max_pos);
+  std::printf("\n# Max velocity difference (batch - scalar): %.3e m/sec", max_vel);
+  std::printf("\n# Max clock difference (batch - scalar)   : %.3e sec", max_clk);
+  std::printf("\n# Max velocity difference (batch - numeric): %.3e m/sec", max_dvel);
+  std::printf("\n# Max radius difference (from GEO radius) : %.3e km", max_radius/1e3);
+  std::printf("\n# Batch : %10.6f sec, %8.3f usec/epoch", bt, bt/m*1e6);
+  std::printf("\n# Scalar: %10.6f sec, %8.3f usec/epoch", st, st/m*1e6);
+  std::printf("\n# Speedup: %.2f\n", st/bt);
+
+  // out of the validity window
+  errors += (batch.ecef(toc+361e0, bs.data()) != -1);
+
+  return (errors || status || max_pos>1e-6 || max_vel>1e-9 || max_clk>1e-15
+    || max_dvel>1e-6 || max_radius>1e5);
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "sp3.hpp"
+
+using ngpt::Sp3;
+
+/// Check if two values are equal (NaNs compare equal)
+bool
+same(double a, double b)
+{
+  return (std::isnan(a) && std::isnan(b)) || a==b;
+}
+
+/// Naive Neville interpolation of a satellite component, using the same
+/// (centered) window as Sp3
+double
+neville(const Sp3& sp3, int sat, int comp, double t, int order)
+{
+  const double tau = t / sp3.interval();
+  int first = static_cast<int>(tau) - order/2;
+  first = std::max(0, std::min(first, sp3.num_epochs()-1-order));
+  std::vector<double> p (order+1);
+  for (int j=0; j<=order; j++) {
+    p[j] = sp3.epoch_data(first+j)[comp*sp3.num_sats()+sat];
+  }
+  const double x = tau - first;
+  for (int k=1; k<=order; k++) {
+    for (int j=0; j<=order-k; j++) {
+      p[j] = ((x-(j+k))*p[j] + (j-x)*p[j+1]) / (j-(j+k));
+    }
+  }
+  return p[0];
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cerr<<"\n[ERROR] Run as: $>testSp3 [sp3 file]\n";
+    return 1;
+  }
+
+  Sp3 sp3 (argv[1]);
+  const int ns = sp3.num_sats();
+  const double span = (sp3.num_epochs()-1)*sp3.interval();
+  std::printf("\n# Version: %c, epochs: %d, interval: %.1f sec, satellites: %d",
+    sp3.version(), sp3.num_epochs(), sp3.interval(), ns);
+  std::printf("\n# Coordinate system: %s, time system: %s",
+    sp3.coordinate_system().c_str(), sp3.time_system().c_str());
+  int errors = 0;
+
+  // (1) on the nodes, the tabulated values are returned
+  std::vector<double> state (4*ns);
+  int node_diffs = 0;
+  for (int e=0; e<sp3.num_epochs(); e++) {
+    errors += sp3.interpolate(e*sp3.interval(), state.data());
+    for (int i=0; i<4*ns; i++) node_diffs += !same(state[i], sp3.epoch_data(e)[i]);
+  }
+  std::printf("\n# Differences at nodes: %d", node_diffs);
+  errors += node_diffs;
+
+  // (2) all satellites vs one satellite vs Neville, at random epochs
+  std::mt19937 gen (7);
+  std::uniform_real_distribution<double> dist (0e0, span);
+  for (int order : {9, 10, 11}) {
+    double max_pos = 0e0, max_clk = 0e0;
+    int nan_diffs = 0, one_diffs = 0;
+    for (int k=0; k<2000; k++) {
+      const double t = dist(gen);
+      errors += sp3.interpolate(t, state.data(), order);
+      for (int sat=0; sat<ns; sat++) {
+        double one[4];
+        errors += sp3.interpolate(sat, t, one, order);
+        for (int c=0; c<4; c++) {
+          const double v = state[c*ns+sat];
+          const double ref = neville(sp3, sat, c, t, order);
+          one_diffs += !same(one[c], v) && std::abs(one[c]-v) > 1e-9*std::abs(v);
+          if (std::isnan(v) || std::isnan(ref)) {
+            nan_diffs += std::isnan(v) != std::isnan(ref);
+            continue;
+          }
+          if (c<3) max_pos = std::max(max_pos, std::abs(v-ref));
+          else max_clk = std::max(max_clk, std::abs(v-ref));
+        }
+      }
+    }
+    std::printf("\n# Order %2d vs Neville: max diff %.2e m, %.2e sec; "
+      "NaN mismatches: %d, single-satellite mismatches: %d",
+      order, max_pos, max_clk, nan_diffs, one_diffs);
+    errors += nan_diffs + one_diffs + (max_pos > 1e-4) + (max_clk > 1e-15);
+  }
+
+  // (3) out of range and invalid orders
+  errors += (sp3.interpolate(-1e0, state.data()) != 1);
+  errors += (sp3.interpolate(span+1e0, state.data()) != 1);
+  errors += (sp3.interpolate(0e0, state.data(), 0) != 2);
+  errors += (sp3.interpolate(0e0, state.data(), Sp3::max_order+1) != 2);
+  errors += (sp3.sat_index(ngpt::SATELLITE_SYSTEM::gps, 99) != -1);
+
+  // (4) throughput; all satellites, every second of the file
+  const int n = static_cast<int>(span);
+  std::vector<double> t (n);
+  for (int i=0; i<n; i++) t[i] = i + 0.5e0;
+  std::vector<double> states (static_cast<std::size_t>(n)*4*ns);
+  auto start = std::chrono::steady_clock::now();
+  errors += sp3.interpolate(t.data(), n, states.data(), 9);
+  auto stop = std::chrono::steady_clock::now();
+  const double sec = std::chrono::duration<double>(stop-start).count();
+  std::printf("\n# Batch interpolation (order 9): %.1f M satellite states/sec\n",
+    static_cast<double>(n)*ns/sec/1e6);
+
+  return errors;
+}